@@ -43,6 +43,7 @@ DEFINES += QT_DEPRECATED_WARNINGS #DEBUG
 
 # Input
 HEADERS += include/EvioFileReader.h \
+           include/EvioFileWriter.h \
            include/EventParser.h \
            include/GeneralEvioStruct.h \
            include/MPDVMERawEventDecoder.h \
@@ -51,11 +52,18 @@ HEADERS += include/EvioFileReader.h \
            include/MPDDataStruct.h \
            include/AbstractRawDecoder.h \
            include/sspApvdec.h \
+           include/SPSCQueue.h \
+           include/EvioLiveReader.h \
+           include/Fadc250Data.h \
+           include/Fadc250Decoder.h \
 
 SOURCES += src/EvioFileReader.cpp \ 
+           src/EvioFileWriter.cpp \
+           src/EvioLiveReader.cpp \
            src/EventParser.cpp \ 
            src/MPDVMERawEventDecoder.cpp \
            src/MPDSSPRawEventDecoder.cpp \
            src/AbstractRawDecoder.cpp \
            src/MPDDataStruct.cpp \
+           src/Fadc250Decoder.cpp \
 
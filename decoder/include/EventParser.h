@@ -43,11 +43,19 @@ public:
     void SetEventNumber(int);
     uint32_t GetEventNumber();
 
+    // accumulate the time spent in raw decoders (ns), so parsing and
+    // decoding can be timed separately, cleared by Reset()
+    void SetDecodeTiming(bool m) {bDecodeTiming = m;}
+    uint64_t GetDecodeTime() const {return fDecodeTime;}
+
 private:
     // {tag -> decoder}, decode data according to tag
     std::unordered_map<int, AbstractRawDecoder*> mDecoder;
 
     uint32_t event_number = 0;
+
+    bool bDecodeTiming = false;
+    uint64_t fDecodeTime = 0;
 };
 
 #endif
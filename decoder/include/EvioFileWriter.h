@@ -0,0 +1,42 @@
+#ifndef EVIO_FILE_WRITER_H
+#define EVIO_FILE_WRITER_H
+
+////////////////////////////////////////////////////////////////
+// A Wrapper for "evio.h", the writing counterpart of
+// EvioFileReader
+
+#include "evio.h"
+
+#include <string>
+
+////////////////////////////////////////////////////////////////
+// Write events to an evio file, event by event
+
+class EvioFileWriter
+{
+public:
+    EvioFileWriter();
+    EvioFileWriter(const char*);
+    EvioFileWriter(std::string);
+
+    ~EvioFileWriter();
+
+    bool OpenFile();
+    void CloseFile();
+    void SetFile(const char*);
+    void SetFile(std::string);
+    bool IsOpen() const {return bOpen;}
+
+    // write one event, buf[0] is the event length (exclusive) in words
+    int Write(const uint32_t *buf);
+
+    int GetEventNumber();
+
+private:
+    std::string fFileName;
+    int fFileHandle = 0;
+    bool bOpen = false;
+    int fEventNumber = 0;
+};
+
+#endif
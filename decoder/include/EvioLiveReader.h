@@ -0,0 +1,85 @@
+#ifndef EVIO_LIVE_READER_H
+#define EVIO_LIVE_READER_H
+
+////////////////////////////////////////////////////////////////
+// Follow an evio file while CODA is still writing it
+//
+// The evio library assumes a closed file, at the end of data it
+// returns EOF and a block that is half written is reported as a
+// corrupted file. This reader parses evio (version 4) blocks by
+// itself: a block is only used once it is complete on disk, if no
+// complete block is available it polls the file until one lands.
+// When the current file is closed (last block flag) or the next
+// split "*.evio.N+1" shows up, it moves on to the next split.
+//
+// ReadNoCopy blocks until an event is available, the run ends, or
+// Interrupt() is called from another thread.
+
+#include "evio.h"
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+class EvioLiveReader
+{
+public:
+    EvioLiveReader();
+    EvioLiveReader(const char*);
+    EvioLiveReader(std::string);
+
+    ~EvioLiveReader();
+
+    bool OpenFile();
+    void CloseFile();
+    void SetFile(const char*);
+    void SetFile(std::string);
+
+    // same as EvioFileReader, the buffer is valid until next read
+    int ReadNoCopy(const uint32_t **buf, uint32_t *buflen);
+
+    int GetEventNumber();
+    int GetSplitNumber();
+    const std::string &GetCurrentFile() const {return fCurrentFile;}
+
+    // poll interval when waiting for data (ms)
+    void SetPollInterval(int ms) {fPollInterval = ms;}
+    // how long to wait for the next split after a file is closed (ms)
+    void SetSplitTimeout(int ms) {fSplitTimeout = ms;}
+    // give up if nothing is written for this long (ms), <= 0: wait forever
+    void SetIdleTimeout(int ms) {fIdleTimeout = ms;}
+
+    // thread safe, stop waiting, ReadNoCopy returns EOF
+    void Interrupt() {bInterrupt = true;}
+
+private:
+    bool openSplit(const std::string &path);
+    bool nextSplit();
+    int readBlock();
+    bool sleep(int ms);
+    static std::string splitFileName(const std::string &path, int split);
+    static int splitNumber(const std::string &path);
+
+private:
+    std::string fFileName;
+    std::string fCurrentFile;
+    int fFileHandle = -1;
+    int fSplit = -1;
+    uint64_t fOffset = 0;       // bytes consumed in current file
+    bool bSwap = false;
+    bool bLastBlock = false;
+
+    // current block
+    std::vector<uint32_t> vBlock;
+    uint32_t fBlockPos = 0;     // next event position in block (words)
+    uint32_t fBlockEvents = 0;  // events left in block
+
+    int fEventNumber = 0;
+    int fPollInterval = 100;
+    int fSplitTimeout = 10000;
+    int fIdleTimeout = 0;
+    std::atomic<bool> bInterrupt{false};
+};
+
+#endif
@@ -50,5 +50,26 @@ public:
     void Clear() { ped = Pedestal(0., 0.), peaks.clear(), raw.clear(); }
 };
 
+class Fadc250Event
+{
+public:
+    uint32_t number, mode;
+    std::vector<uint32_t> time;
+    std::vector<Fadc250Data> channels;
+
+    Fadc250Event(uint32_t n = 0, uint32_t nch = 16)
+        : number(n), mode(0)
+    {
+        channels.resize(nch);
+    }
+
+    void Clear()
+    {
+        mode = 0;
+        time.clear();
+        for (auto &ch : channels) { ch.Clear(); }
+    }
+};
+
 }; // namespace fdec
 
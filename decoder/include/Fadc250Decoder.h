@@ -36,27 +36,6 @@ enum Fadc250Type {
     FillerWord = 15,
 };
 
-class Fadc250Event
-{
-public:
-    uint32_t number, mode;
-    std::vector<uint32_t> time;
-    std::vector<Fadc250Data> channels;
-
-    Fadc250Event(uint32_t n = 0, uint32_t nch = 16)
-        : number(n), mode(0)
-    {
-        channels.resize(nch);
-    }
-
-    void Clear()
-    {
-        mode = 0;
-        time.clear();
-        for (auto &ch : channels) { ch.Clear(); }
-    }
-};
-
 class Fadc250Decoder : public AbstractRawDecoder
 {
 public:
@@ -74,13 +53,22 @@ public:
 
     virtual void Decode(const uint32_t *pBuf, uint32_t fBufLen, std::vector<int> &vTagTrack);
     virtual void Clear();
-    const Fadc250Event &GetDecodedEvent() const {return _event;}
+    // the first fadc bank of the event
+    const Fadc250Event &GetDecodedEvent() const {return _events[0];}
+    // for analyzing the channels in place
+    Fadc250Event &GetDecodedEvent() {return _events[0];}
+    // all fadc banks (boards) of the event, in the order they were decoded
+    size_t GetNDecodedEvents() const {return _nevents;}
+    const Fadc250Event &GetDecodedEvent(size_t i) const {return _events[i];}
+    Fadc250Event &GetDecodedEvent(size_t i) {return _events[i];}
 
 
 private:
     double _clk;
 
-    Fadc250Event _event;
+    // one event per fadc bank, reused event by event
+    std::vector<Fadc250Event> _events;
+    size_t _nevents;
 };
 
 }; // namespace fdec
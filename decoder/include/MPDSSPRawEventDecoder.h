@@ -49,6 +49,14 @@ private:
     uint32_t current_strip_number = -1;
     std::vector<int> vStripADC;
     uint32_t flags = 0;
+
+    // words for getting information during ssp decoding, they are kept
+    // per decoder so that several decoders can run in parallel threads
+    uint32_t type_last = 15; // initialize to type FILLER WORD
+    uint32_t time_last = 0;
+    int new_type = 0;
+    int apv_data_word = 0;
+    bool current_strip_finished = false;
 };
 
 #endif
@@ -0,0 +1,106 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+////////////////////////////////////////////////////////////////
+// A bounded lock-free single producer single consumer queue
+//
+// Exactly one thread may call Push()/TryPush()/Close(), and
+// exactly one (other) thread may call Pop()/TryPop().
+// The capacity is rounded up to a power of 2.
+
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <cstddef>
+
+// assumed cache line size, for padding the indices
+#define SPSC_CACHE_LINE 64
+
+template<typename T>
+class SPSCQueue
+{
+public:
+    explicit SPSCQueue(size_t capacity = 64)
+    {
+        size_t n = 2;
+        while(n < capacity)
+            n <<= 1;
+        fMask = n - 1;
+        vSlots.resize(n);
+    }
+
+    SPSCQueue(const SPSCQueue &) = delete;
+    SPSCQueue &operator=(const SPSCQueue &) = delete;
+
+    // producer side
+    bool TryPush(T &&v)
+    {
+        size_t head = fHead.load(std::memory_order_relaxed);
+        if(head - fTail.load(std::memory_order_acquire) > fMask)
+            return false; // full
+
+        vSlots[head & fMask] = std::move(v);
+        fHead.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    void Push(T &&v)
+    {
+        while(!TryPush(std::move(v)))
+            std::this_thread::yield();
+    }
+
+    // no more data will be pushed
+    void Close() {bClosed.store(true, std::memory_order_release);}
+
+    // consumer side
+    bool TryPop(T &v)
+    {
+        size_t tail = fTail.load(std::memory_order_relaxed);
+        if(tail == fHead.load(std::memory_order_acquire))
+            return false; // empty
+
+        v = std::move(vSlots[tail & fMask]);
+        fTail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // block until an element is available, return false if the queue
+    // has been closed and all elements have been consumed
+    bool Pop(T &v)
+    {
+        while(!TryPop(v))
+        {
+            if(bClosed.load(std::memory_order_acquire)) {
+                // elements pushed right before Close()
+                return TryPop(v);
+            }
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    // approximate number of elements, for monitoring only
+    size_t Size() const
+    {
+        return fHead.load(std::memory_order_acquire) - fTail.load(std::memory_order_acquire);
+    }
+
+    size_t Capacity() const {return fMask + 1;}
+
+private:
+    std::vector<T> vSlots;
+    size_t fMask;
+
+    // keep producer and consumer indices on separate cache lines, padded
+    // explicitly, alignas() is not honored by new for over-aligned types
+    // before c++17
+    char fPad0[SPSC_CACHE_LINE];
+    std::atomic<size_t> fHead{0};
+    char fPad1[SPSC_CACHE_LINE - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> fTail{0};
+    char fPad2[SPSC_CACHE_LINE - sizeof(std::atomic<size_t>)];
+    std::atomic<bool> bClosed{false};
+};
+
+#endif
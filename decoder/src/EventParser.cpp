@@ -1,6 +1,7 @@
 #include "EventParser.h"
 
 #include <iostream>
+#include <chrono>
 
 ////////////////////////////////////////////////////////////////
 // ctor
@@ -206,8 +207,19 @@ void EventParser::ParseData(const uint32_t *pBuf, [[maybe_unused]] uint32_t fBuf
     }
 
     // decode
-    if(mDecoder.find(tag) != mDecoder.end())
-        mDecoder[tag] -> Decode(&pBuf[header_length], length-1, vTagTrack);
+    auto it = mDecoder.find(tag);
+    if(it == mDecoder.end())
+        return;
+
+    if(!bDecodeTiming) {
+        it -> second -> Decode(&pBuf[header_length], length-1, vTagTrack);
+        return;
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    it -> second -> Decode(&pBuf[header_length], length-1, vTagTrack);
+    auto end = std::chrono::steady_clock::now();
+    fDecodeTime += std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
 }
 
 ////////////////////////////////////////////////////////////////
@@ -259,6 +271,7 @@ void EventParser::Reset()
 {
     // reset event number
     event_number = 0;
+    fDecodeTime = 0;
 
     // clear all decoders
     for(auto &i: mDecoder)
@@ -0,0 +1,108 @@
+#include "EvioFileWriter.h"
+
+#include <iostream>
+
+////////////////////////////////////////////////////////////////
+// default ctor
+
+EvioFileWriter::EvioFileWriter()
+{
+    // place holder
+}
+
+////////////////////////////////////////////////////////////////
+// ctor
+
+EvioFileWriter::EvioFileWriter(const char* file_name)
+{
+    fFileName = file_name;
+    OpenFile();
+}
+
+////////////////////////////////////////////////////////////////
+// ctor
+
+EvioFileWriter::EvioFileWriter(std::string file_name)
+{
+    fFileName = file_name;
+    OpenFile();
+}
+
+////////////////////////////////////////////////////////////////
+// dtor
+
+EvioFileWriter::~EvioFileWriter()
+{
+    CloseFile();
+}
+
+////////////////////////////////////////////////////////////////
+// set evio file
+
+void EvioFileWriter::SetFile(const char* path)
+{
+    fFileName = path;
+}
+
+////////////////////////////////////////////////////////////////
+// set evio file
+
+void EvioFileWriter::SetFile(std::string path)
+{
+    fFileName = path;
+}
+
+////////////////////////////////////////////////////////////////
+// open evio file for writing, an existing file is overwritten
+
+bool EvioFileWriter::OpenFile()
+{
+    CloseFile();
+
+    int open_status = evOpen(const_cast<char*>(fFileName.c_str()),
+            const_cast<char*>("w"), &fFileHandle);
+
+    if(open_status != 0) {
+        std::cout<<"Error: EvioFileWriter cannot open file: "<<fFileName
+                 <<std::endl;
+        return false;
+    }
+
+    bOpen = true;
+    fEventNumber = 0;
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////
+// close evio file, the last block is flushed here
+
+void EvioFileWriter::CloseFile()
+{
+    if(!bOpen)
+        return;
+
+    evClose(fFileHandle);
+    bOpen = false;
+}
+
+////////////////////////////////////////////////////////////////
+// write one event
+
+int EvioFileWriter::Write(const uint32_t *buf)
+{
+    int status = evWrite(fFileHandle, buf);
+
+    if(status == S_SUCCESS)
+        fEventNumber++;
+
+    return status;
+}
+
+////////////////////////////////////////////////////////////////
+// get number of events written to current file
+
+int EvioFileWriter::GetEventNumber()
+{
+    return fEventNumber;
+}
@@ -0,0 +1,377 @@
+#include "EvioLiveReader.h"
+
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// evio version 4 block header
+#define EVIO_BLOCK_HEADER_SIZE 8
+#define EVIO_MAGIC 0xc0da0100
+#define EVIO_VERSION_MASK 0xff
+#define EVIO_DICTIONARY_MASK 0x100
+#define EVIO_LAST_BLOCK_MASK 0x200
+
+////////////////////////////////////////////////////////////////
+// a helper
+
+static inline uint32_t swap32(uint32_t v)
+{
+    return ((v >> 24) & 0xff) | ((v >> 8) & 0xff00) |
+        ((v << 8) & 0xff0000) | ((v << 24) & 0xff000000);
+}
+
+////////////////////////////////////////////////////////////////
+// a helper, read exactly 'size' bytes at 'offset'
+
+static bool read_at(int fd, void *buf, size_t size, uint64_t offset)
+{
+    char *p = static_cast<char*>(buf);
+    while(size > 0) {
+        ssize_t n = pread(fd, p, size, static_cast<off_t>(offset));
+        if(n <= 0)
+            return false;
+        p += n;
+        size -= n;
+        offset += n;
+    }
+    return true;
+}
+
+////////////////////////////////////////////////////////////////
+// default ctor
+
+EvioLiveReader::EvioLiveReader()
+{
+    // place holder
+}
+
+////////////////////////////////////////////////////////////////
+// ctor
+
+EvioLiveReader::EvioLiveReader(const char* file_name)
+{
+    fFileName = file_name;
+    OpenFile();
+}
+
+////////////////////////////////////////////////////////////////
+// ctor
+
+EvioLiveReader::EvioLiveReader(std::string file_name)
+{
+    fFileName = file_name;
+    OpenFile();
+}
+
+////////////////////////////////////////////////////////////////
+// dtor
+
+EvioLiveReader::~EvioLiveReader()
+{
+    CloseFile();
+}
+
+////////////////////////////////////////////////////////////////
+// set evio file, normally the first split of a run
+
+void EvioLiveReader::SetFile(const char* path)
+{
+    fFileName = path;
+}
+
+////////////////////////////////////////////////////////////////
+// set evio file, normally the first split of a run
+
+void EvioLiveReader::SetFile(std::string path)
+{
+    fFileName = path;
+}
+
+////////////////////////////////////////////////////////////////
+// open evio file, if it does not exist yet, ReadNoCopy waits for it
+
+bool EvioLiveReader::OpenFile()
+{
+    CloseFile();
+
+    bInterrupt = false;
+    fEventNumber = 0;
+    fSplit = splitNumber(fFileName);
+    fCurrentFile = fFileName;
+
+    if(!openSplit(fFileName)) {
+        std::cout<<"EvioLiveReader:: waiting for file: "<<fFileName<<std::endl;
+        return false;
+    }
+    return true;
+}
+
+////////////////////////////////////////////////////////////////
+// close evio file
+
+void EvioLiveReader::CloseFile()
+{
+    if(fFileHandle >= 0)
+        close(fFileHandle);
+    fFileHandle = -1;
+
+    vBlock.clear();
+    fBlockPos = 0;
+    fBlockEvents = 0;
+}
+
+////////////////////////////////////////////////////////////////
+// open one split file, start from its first block
+
+bool EvioLiveReader::openSplit(const std::string &path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+        return false;
+
+    fFileHandle = fd;
+    fCurrentFile = path;
+    fOffset = 0;
+    bLastBlock = false;
+    vBlock.clear();
+    fBlockPos = 0;
+    fBlockEvents = 0;
+
+    std::cout<<"EvioLiveReader:: following file: "<<path<<std::endl;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////
+// move to the next split if it exists
+
+bool EvioLiveReader::nextSplit()
+{
+    if(fSplit < 0)
+        return false;
+
+    std::string next = splitFileName(fFileName, fSplit + 1);
+    struct stat st;
+    if(stat(next.c_str(), &st) != 0)
+        return false;
+
+    CloseFile();
+    if(!openSplit(next))
+        return false;
+
+    fSplit++;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////
+// load the next block if it is completely written
+// return 1: got a block, 0: no complete block yet, -1: bad file
+
+int EvioLiveReader::readBlock()
+{
+    if(fFileHandle < 0)
+        return 0;
+
+    struct stat st;
+    if(fstat(fFileHandle, &st) != 0)
+        return 0;
+    uint64_t size = static_cast<uint64_t>(st.st_size);
+
+    uint32_t header[EVIO_BLOCK_HEADER_SIZE];
+    if(size < fOffset + sizeof(header))
+        return 0;
+    if(!read_at(fFileHandle, header, sizeof(header), fOffset))
+        return 0;
+
+    // endianness from the magic word of each block
+    if(header[7] == EVIO_MAGIC)
+        bSwap = false;
+    else if(swap32(header[7]) == EVIO_MAGIC)
+        bSwap = true;
+    else {
+        std::cout<<"Error: EvioLiveReader bad block magic word in "<<fCurrentFile
+                 <<" at byte "<<fOffset<<std::endl;
+        return -1;
+    }
+    if(bSwap)
+        for(auto &i: header)
+            i = swap32(i);
+
+    uint32_t version = header[5] & EVIO_VERSION_MASK;
+    uint32_t block_len = header[0];
+    uint32_t header_len = header[2];
+    if(version < 4 || header_len < EVIO_BLOCK_HEADER_SIZE || block_len < header_len) {
+        std::cout<<"Error: EvioLiveReader unsupported block (evio version "<<version
+                 <<") in "<<fCurrentFile<<std::endl;
+        return -1;
+    }
+
+    // block is not completely written yet
+    if(size < fOffset + 4ULL * block_len)
+        return 0;
+
+    vBlock.resize(block_len - header_len);
+    if(vBlock.size() > 0 &&
+       !read_at(fFileHandle, &vBlock[0], 4 * vBlock.size(), fOffset + 4ULL * header_len))
+        return 0;
+
+    // the banks in gem/fadc data are all 32 bit words
+    if(bSwap)
+        for(auto &i: vBlock)
+            i = swap32(i);
+
+    bool first_block = (fOffset == 0);
+    fOffset += 4ULL * block_len;
+    fBlockPos = 0;
+    fBlockEvents = header[3];
+    if(header[5] & EVIO_LAST_BLOCK_MASK)
+        bLastBlock = true;
+
+    // dictionary is the first event of a file, evio skips it as well
+    if(first_block && (header[5] & EVIO_DICTIONARY_MASK) && fBlockEvents > 0
+       && vBlock.size() > 0) {
+        fBlockPos = vBlock[0] + 1;
+        fBlockEvents--;
+    }
+
+    return 1;
+}
+
+////////////////////////////////////////////////////////////////
+// read next event, wait for it if it is not written yet
+
+int EvioLiveReader::ReadNoCopy(const uint32_t **buf, uint32_t *buflen)
+{
+    int idle = 0;
+    int split_wait = 0;
+
+    while(!bInterrupt)
+    {
+        // events left in current block
+        if(fBlockEvents > 0) {
+            uint32_t len = vBlock[fBlockPos] + 1;
+            if(fBlockPos + len > vBlock.size()) {
+                std::cout<<"Error: EvioLiveReader event exceeds block in "<<fCurrentFile
+                         <<std::endl;
+                fBlockEvents = 0;
+                continue;
+            }
+
+            *buf = &vBlock[fBlockPos];
+            *buflen = len;
+            fBlockPos += len;
+            fBlockEvents--;
+            fEventNumber++;
+            return S_SUCCESS;
+        }
+
+        // file not created yet
+        if(fFileHandle < 0) {
+            if(!openSplit(fCurrentFile) && !sleep(fPollInterval))
+                break;
+            continue;
+        }
+
+        int status = readBlock();
+        if(status > 0) {
+            idle = 0;
+            continue;
+        }
+        if(status < 0)
+            return S_EVFILE_BADFILE;
+
+        // no complete block, current file is done once the next split
+        // appears, read whatever landed in between before moving on
+        if(fSplit >= 0) {
+            struct stat st;
+            bool next_exists = stat(splitFileName(fFileName, fSplit + 1).c_str(), &st) == 0;
+            if(next_exists && readBlock() > 0)
+                continue;
+            if(next_exists && nextSplit()) {
+                idle = 0;
+                split_wait = 0;
+                continue;
+            }
+        }
+
+        // file closed and no next split after a while, the run ended
+        if(bLastBlock) {
+            if(split_wait >= fSplitTimeout)
+                break;
+            split_wait += fPollInterval;
+        }
+
+        if(!sleep(fPollInterval))
+            break;
+
+        idle += fPollInterval;
+        if(fIdleTimeout > 0 && idle >= fIdleTimeout) {
+            std::cout<<"EvioLiveReader:: no data written to "<<fCurrentFile<<" for "
+                     <<idle<<" ms, stop following."<<std::endl;
+            break;
+        }
+    }
+
+    return EOF;
+}
+
+////////////////////////////////////////////////////////////////
+// get current event number being processed
+
+int EvioLiveReader::GetEventNumber()
+{
+    return fEventNumber;
+}
+
+////////////////////////////////////////////////////////////////
+// get current split number, -1 if the file name has no split suffix
+
+int EvioLiveReader::GetSplitNumber()
+{
+    return fSplit;
+}
+
+////////////////////////////////////////////////////////////////
+// sleep in small steps, return false if interrupted
+
+bool EvioLiveReader::sleep(int ms)
+{
+    const int step = 10;
+    for(int t=0; t<ms; t+=step) {
+        if(bInterrupt)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(step));
+    }
+    return !bInterrupt;
+}
+
+////////////////////////////////////////////////////////////////
+// "path/run.evio.0" -> "path/run.evio.<split>"
+
+std::string EvioLiveReader::splitFileName(const std::string &path, int split)
+{
+    size_t pos = path.rfind(".evio.");
+    if(pos == std::string::npos)
+        return path;
+    return path.substr(0, pos + 6) + std::to_string(split);
+}
+
+////////////////////////////////////////////////////////////////
+// "path/run.evio.3" -> 3, -1 if no split suffix
+
+int EvioLiveReader::splitNumber(const std::string &path)
+{
+    size_t pos = path.rfind(".evio.");
+    if(pos == std::string::npos || pos + 6 >= path.size())
+        return -1;
+
+    std::string s = path.substr(pos + 6);
+    for(auto &c: s)
+        if(c < '0' || c > '9')
+            return -1;
+    return std::stoi(s);
+}
@@ -8,6 +8,8 @@
 
 #include "Fadc250Decoder.h"
 
+#include <algorithm>
+
 using namespace fdec;
 
 #define SET_BIT(n,i)  ( (n) |= (1ULL << i) )
@@ -46,7 +48,7 @@ inline uint32_t fill_in_words(const uint32_t *buf, size_t beg, Container &raw_da
 
 
 Fadc250Decoder::Fadc250Decoder(double clk)
-: _clk(clk)
+: _clk(clk), _events(1), _nevents(0)
 {
     // place holder
 }
@@ -57,6 +59,9 @@ struct PeakBuffer {
     bool in_data = false;
 };
 
+// channel number is 4 bits in the data words
+#define FADC250_MAX_NCHANNELS 16
+
 void Fadc250Decoder::DecodeEvent(Fadc250Event &res, const uint32_t *buf, size_t buflen)
 const
 {
@@ -77,7 +82,9 @@ const
     }
 
     res.number = (header & 0x3FFFFF);
-    std::vector<std::vector<PeakBuffer>> peak_buffers(res.channels.size());
+    // peak buffers on stack, no heap allocation per event
+    PeakBuffer peak_buffers[FADC250_MAX_NCHANNELS][FADC250_MAX_NPEAKS];
+    uint32_t nchans = std::min<uint32_t>(res.channels.size(), FADC250_MAX_NCHANNELS);
     uint32_t type = FillerWord;
 
     for (size_t iw = 1; iw < buflen; ++iw) {
@@ -101,6 +108,11 @@ const
                 // get channel and window size
                 uint32_t ch = (data >> 23) & 0xF;
                 size_t nwords= (data & 0xFFF);
+                if (ch >= nchans) {
+                    // skip the samples, 2 per word
+                    iw += (nwords + 1) / 2;
+                    break;
+                }
                 auto &raw_data = get_channel(res, ch).raw;
                 raw_data.clear();
                 iw += fill_in_words(buf, iw, raw_data, nwords);
@@ -126,8 +138,8 @@ const
                 uint32_t ch = (data >> 23) & 0xF;
                 uint32_t pulse_num = (data >> 21) & 0x3;
                 // uint32_t quality = (data >> 19) & 0x3;
-                if (peak_buffers[ch].size() < pulse_num + 1) {
-                    peak_buffers[ch].resize(4);
+                if (ch >= nchans) {
+                    break;
                 }
                 peak_buffers[ch][pulse_num].integral = data & 0x7FFFF;
                 peak_buffers[ch][pulse_num].in_data = true;
@@ -138,9 +150,8 @@ const
                 uint32_t ch = (data >> 23) & 0xF;
                 uint32_t pulse_num = (data >> 21) & 0x3;
                 // uint32_t quality = (data >> 19) & 0x3;
-                [[maybe_unused]]auto &chan = get_channel(res, ch);
-                if (peak_buffers[ch].size() < pulse_num + 1) {
-                    peak_buffers[ch].resize(4);
+                if (ch >= nchans) {
+                    break;
                 }
                 // convert to ns (1e3 / _clk (MHz) / 64)
                 peak_buffers[ch][pulse_num].time = data & 0xFFFF;
@@ -166,7 +177,7 @@ const
     }
 
     // fill peak buffers to result
-    for (size_t i = 0; i < peak_buffers.size(); ++i) {
+    for (size_t i = 0; i < nchans; ++i) {
         for (auto &peak : peak_buffers[i]) {
             if (!peak.in_data) {
                 continue;
@@ -185,11 +196,23 @@ void Fadc250Decoder::Decode([[maybe_unused]]const uint32_t *pBuf,
         [[maybe_unused]]uint32_t fBufLen, 
         [[maybe_unused]]std::vector<int> &vTagTrack)
 {
-    // skip block header information
-    Fadc250Event event = DecodeEvent(&pBuf[2], fBufLen);
-    _event = std::move(event);
+    // skip block header information, decode in place, the channel
+    // buffers of the events are reused event by event
+    if (_nevents >= _events.size()) {
+        _events.emplace_back();
+    }
+    Fadc250Event &event = _events[_nevents++];
+    if (fBufLen <= 2) {
+        event.Clear();
+        return;
+    }
+    DecodeEvent(event, &pBuf[2], fBufLen - 2);
 }
 
 void Fadc250Decoder::Clear()
 {
+    for (size_t i = 0; i < _nevents; ++i) {
+        _events[i].Clear();
+    }
+    _nevents = 0;
 }
@@ -4,16 +4,6 @@
 #include <cassert>
 
 
-////////////////////////////////////////////////////////////////
-// static words for getting information during ssp decoding, 
-// a temporary solution, needs to be removed
-
-static uint32_t type_last = 15;	/* initialize to type FILLER WORD */
-static uint32_t time_last = 0;
-static int new_type = 0;
-static int apv_data_word = 0;
-static bool current_strip_finished = false;
-
 ////////////////////////////////////////////////////////////////
 // a helper for printing word in binary format (13 digits a group)
 
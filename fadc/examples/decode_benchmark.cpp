@@ -0,0 +1,205 @@
+#include "EvioFileReader.h"
+#include "EventParser.h"
+#include "AbstractRawDecoder.h"
+#include "RolStruct.h"
+
+#include "Fadc250Decoder.h"
+#include "WfAnalyzer.h"
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <atomic>
+#include <cstdlib>
+#include <cmath>
+#include <new>
+
+using namespace fdec;
+
+////////////////////////////////////////////////////////////////
+// Benchmark the FADC250 decoding + waveform analysis on recorded data
+//
+//     legacy:   DecodeEvent() returning a new Fadc250Event, every
+//               channel copied then analyzed (what the viewer did)
+//     in place: Decode() into the decoder's persistent event, channels
+//               analyzed in place with the analyzer's scratch buffers
+//     batch:    Decode() as above, all channels analyzed together
+//               (only differs for spectra without a flat baseline, where
+//               it uses an iterative pedestal instead of TSpectrum)
+//
+// fadc banks are read from the evio file into memory first, so only
+// decoding and analysis are timed. Heap allocations are counted for
+// both paths.
+//
+// usage:
+//     decode_benchmark <evio file> [passes]
+
+////////////////////////////////////////////////////////////////
+// count heap allocations
+
+static std::atomic<uint64_t> n_allocations(0);
+
+void* operator new(size_t size)
+{
+    n_allocations++;
+    void *p = std::malloc(size);
+    if(!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+////////////////////////////////////////////////////////////////
+// keep a copy of every fadc bank
+
+class BankRecorder : public AbstractRawDecoder
+{
+public:
+    void Decode(const uint32_t *pBuf, uint32_t fBufLen, [[maybe_unused]] std::vector<int> &vTagTrack)
+    {
+        banks.emplace_back(pBuf, pBuf + fBufLen);
+    }
+    void Clear() {}
+
+    std::vector<std::vector<uint32_t>> banks;
+};
+
+////////////////////////////////////////////////////////////////
+// a summary of analysis results, to check both paths agree
+
+struct Summary
+{
+    uint64_t channels = 0, peaks = 0;
+    double ped_sum = 0., height_sum = 0., integral_sum = 0.;
+
+    void Add(const Fadc250Data &data)
+    {
+        channels++;
+        ped_sum += data.ped.mean;
+        for(auto &p: data.peaks) {
+            peaks++;
+            height_sum += p.height;
+            integral_sum += p.integral;
+        }
+    }
+
+    bool operator==(const Summary &s) const
+    {
+        return channels == s.channels && peaks == s.peaks &&
+            ped_sum == s.ped_sum && height_sum == s.height_sum &&
+            integral_sum == s.integral_sum;
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    if(argc < 2) {
+        std::cout<<"usage: "<<argv[0]<<" <evio file> [passes]"<<std::endl;
+        return 1;
+    }
+    int passes = (argc > 2) ? std::atoi(argv[2]) : 10;
+
+    // read all fadc banks
+    EvioFileReader *file_reader = new EvioFileReader();
+    file_reader -> SetFile(argv[1]);
+    if(!file_reader -> OpenFile())
+        return 1;
+
+    EventParser *event_parser = new EventParser();
+    BankRecorder *recorder = new BankRecorder();
+    event_parser -> RegisterRawDecoder(static_cast<int>(Bank_TagID::FADC), recorder);
+
+    const uint32_t *pBuf;
+    uint32_t fBufLen;
+    while(file_reader -> ReadNoCopy(&pBuf, &fBufLen) == S_SUCCESS)
+        event_parser -> ParseEvent(pBuf, fBufLen);
+    file_reader -> CloseFile();
+
+    auto &banks = recorder -> banks;
+    std::cout<<"fadc banks read: "<<banks.size()<<std::endl;
+    if(banks.size() == 0)
+        return 1;
+
+    Fadc250Decoder decoder;
+    Analyzer ana;
+    std::vector<int> tags;
+
+    // legacy path
+    auto run_legacy = [&](Summary &sum)
+    {
+        for(auto &bank: banks) {
+            if(bank.size() <= 2) continue;
+            Fadc250Event event = decoder.DecodeEvent(&bank[2], bank.size() - 2);
+            for(auto &ch: event.channels) {
+                Fadc250Data data = ch;
+                ana.Analyze(data);
+                sum.Add(data);
+            }
+        }
+    };
+
+    // in place path
+    auto run_in_place = [&](Summary &sum)
+    {
+        for(auto &bank: banks) {
+            decoder.Clear();
+            decoder.Decode(bank.data(), bank.size(), tags);
+            for(auto &ch: decoder.GetDecodedEvent().channels) {
+                ana.Analyze(ch);
+                sum.Add(ch);
+            }
+        }
+    };
+
+    // batch path
+    auto run_batch = [&](Summary &sum)
+    {
+        for(auto &bank: banks) {
+            decoder.Clear();
+            decoder.Decode(bank.data(), bank.size(), tags);
+            auto &channels = decoder.GetDecodedEvent().channels;
+            ana.Analyze(channels);
+            for(auto &ch: channels)
+                sum.Add(ch);
+        }
+    };
+
+    auto bench = [&](const char *name, const std::function<void(Summary&)> &run) -> Summary
+    {
+        // warm up, buffers reach their steady state size
+        Summary warm;
+        run(warm);
+
+        Summary sum;
+        uint64_t alloc_begin = n_allocations;
+        auto begin = std::chrono::steady_clock::now();
+        for(int p=0; p<passes; p++) {
+            sum = Summary();
+            run(sum);
+        }
+        auto end = std::chrono::steady_clock::now();
+        uint64_t allocs = n_allocations - alloc_begin;
+
+        double t = std::chrono::duration<double>(end - begin).count();
+        double nev = static_cast<double>(banks.size()) * passes;
+        std::cout<<name<<": "<<t<<" s, "<<nev/t<<" events/s, "
+                 <<allocs/nev<<" heap allocations/event"<<std::endl;
+        return sum;
+    };
+
+    Summary s_legacy = bench("legacy  ", run_legacy);
+    Summary s_in_place = bench("in place", run_in_place);
+    Summary s_batch = bench("batch   ", run_batch);
+
+    std::cout<<"channels: "<<s_in_place.channels<<", peaks: "<<s_in_place.peaks
+             <<", results "<<(s_legacy == s_in_place ? "identical" : "DIFFER")<<std::endl;
+    std::cout<<"batch: peaks: "<<s_batch.peaks<<", results "
+             <<(s_batch == s_in_place ? "identical" : "differ (no flat baseline in some channels)")
+             <<std::endl;
+
+    return s_legacy == s_in_place ? 0 : 1;
+}
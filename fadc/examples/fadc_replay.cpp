@@ -0,0 +1,67 @@
+#include "Fadc250Replay.h"
+
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+
+using namespace fdec;
+
+////////////////////////////////////////////////////////////////
+// Replay FADC250 data without the viewer, pedestal and peaks of
+// every channel are saved to a root tree (Fadc250RootTree)
+//
+// usage:
+//     fadc_replay <evio file> [split_start split_end] [-o output] [-j threads]
+//
+// with split_start/split_end, splits <file>.N are replayed for
+// split_start <= N < split_end, events are numbered the same way
+// as the GEM replay of the same splits
+
+static void print_usage(const char* exe)
+{
+    std::cout<<"usage: "<<std::endl
+             <<"    "<<exe<<" <evio file> [split_start split_end] [-o output] [-j threads]"<<std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string input, output;
+    int split_start = 0, split_end = -1;
+    unsigned int threads = 0;
+
+    int npos = 0;
+    for(int i=1; i<argc; i++)
+    {
+        if(std::strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            output = argv[++i];
+        else if(std::strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+            threads = std::atoi(argv[++i]);
+        else if(npos == 0) {
+            input = argv[i];
+            npos++;
+        }
+        else if(npos == 1) {
+            split_start = std::atoi(argv[i]);
+            npos++;
+        }
+        else if(npos == 2) {
+            split_end = std::atoi(argv[i]);
+            npos++;
+        }
+        else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if(input.empty() || npos == 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    Fadc250Replay replay;
+    replay.SetThreads(threads);
+    int count = replay.Replay(input, split_start, split_end, output);
+
+    return count > 0 ? 0 : 1;
+}
@@ -0,0 +1,43 @@
+######################################################################
+# fadc250 headless replay
+######################################################################
+
+TEMPLATE = app
+TARGET = fadc_replay
+
+CONFIG -= qt
+CONFIG += thread
+QMAKE_CXXFLAGS += -std=c++11 -O2 -ftree-vectorize
+
+OBJECTS_DIR = obj
+
+# fadc headers
+INCLUDEPATH += ../include
+
+# coda headers
+INCLUDEPATH += ${CODA}/common/include
+# coda libs
+LIBS += -L${CODA}/Linux-x86_64/lib -levio
+
+# decoder headers
+INCLUDEPATH += ../../decoder/include
+#decoder libs
+LIBS += -L../../decoder/lib -ldecoder
+
+# ROOT headers libs
+INCLUDEPATH += ${ROOTSYS}/include
+# root libs
+LIBS += -L$(ROOTSYS)/lib -lCore -lRIO -lNet \
+        -lHist -lGraf -lGraf3d -lGpad -lTree \
+        -lRint -lPostscript -lMatrix -lPhysics \
+        -lGui -lRGL -lSpectrum -lMathCore
+
+# Input
+HEADERS += ../include/WfAnalyzer.h \
+           ../include/Fadc250RootTree.h \
+           ../include/Fadc250Replay.h \
+
+SOURCES += fadc_replay.cpp \
+           ../src/WfAnalyzer.cpp \
+           ../src/Fadc250RootTree.cpp \
+           ../src/Fadc250Replay.cpp \
@@ -7,7 +7,7 @@ TARGET = fadc
 
 QT += widgets gui core
 
-QMAKE_CXXFLAGS += -std=c++11
+QMAKE_CXXFLAGS += -std=c++11 -ftree-vectorize
 CONFIG += force_debug_info
 
 INCLUDEPATH += include
@@ -47,17 +47,18 @@ DEFINES += QT_DEPRECATED_WARNINGS
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 # Input
-HEADERS += include/Fadc250Data.h \
-           include/Fadc250Decoder.h \
-           include/WfAnalyzer.h \
+HEADERS += include/WfAnalyzer.h \
            include/WfRootGraph.h \
+           include/Fadc250RootTree.h \
+           include/Fadc250Replay.h \
            include/FadcDataViewer.h \
            include/QRootCanvas.h \
            include/QMainCanvas.h \
 
-SOURCES += src/Fadc250Decoder.cpp \
-           src/WfAnalyzer.cpp \
+SOURCES += src/WfAnalyzer.cpp \
            src/WfRootGraph.cpp \
+           src/Fadc250RootTree.cpp \
+           src/Fadc250Replay.cpp \
            src/FadcDataViewer.cpp \
            src/QRootCanvas.cpp \
            src/QMainCanvas.cpp \
@@ -0,0 +1,78 @@
+#pragma once
+
+//
+// Headless batch replay of the FADC250 data
+// It decodes and analyzes (fdec::Analyzer) all events of a run, and saves the results to a compact root
+// tree (Fadc250RootTree) without building any graphics
+//
+// Splits are read in parallel by reader threads, one split per reader at a time, and the events are
+// analyzed in chunks by a pool of worker threads. Each split is saved in order to its own tree, and the trees are merged into
+// the output in split order at the end. Events are numbered the same way as in the GEM replay, from 1 at
+// the first event of the first replayed split, so the FADC timing can be joined with the GEM data offline.
+//
+
+#include "Fadc250Decoder.h"
+#include "WfAnalyzer.h"
+#include "Fadc250RootTree.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace fdec
+{
+
+class Fadc250Replay
+{
+public:
+    Fadc250Replay(const Analyzer &ana = Analyzer());
+    ~Fadc250Replay();
+
+    // replay the splits [split_start, split_end) of a run, split_end < 0: the path is a single file
+    // an empty output goes to Rootfiles/fadc_<split_start>_<run>.root, same as the GEM replay naming
+    // return the number of events replayed
+    int Replay(const std::string &path, int split_start = 0, int split_end = -1,
+               const std::string &output = "");
+
+    // number of threads analyzing the events, 0: all hardware threads
+    void SetThreads(unsigned int n) { _nthreads = n; }
+    // number of events analyzed by a worker at once
+    void SetChunkSize(size_t n) { _chunk_size = n > 0 ? n : 1; }
+    // can be called from any thread, the output is saved up to the last analyzed chunk
+    void Cancel() { _cancel = true; }
+
+    static std::string GetSplitFileName(const std::string &path, int split);
+    static std::string ParseOutputFileName(const std::string &input, const char *prefix = "Rootfiles/fadc");
+    // number of events in an evio (version 4) file from its block headers only, -1 if failed
+    static long CountEvents(const std::string &path);
+
+private:
+    struct Chunk;
+    struct Split;
+    friend class BankRecorder;
+
+    void readSplit(Split &split);
+    void analyzeChunks();
+    void analyzeChunk(Chunk &chunk, Fadc250Decoder &decoder, const Analyzer &ana) const;
+    void writeChunk(std::unique_ptr<Chunk> chunk);
+    void pushChunk(std::unique_ptr<Chunk> chunk);
+
+private:
+    Analyzer _ana;
+    unsigned int _nthreads = 0;
+    size_t _chunk_size = 500;
+    std::atomic<bool> _cancel{false};
+
+    // chunks waiting for analysis, bounded so the readers do not run too far ahead
+    std::deque<std::unique_ptr<Chunk>> _queue;
+    size_t _max_queue = 0;
+    bool _readers_done = false;
+    std::mutex _queue_mtx;
+    std::condition_variable _queue_cv;
+};
+
+}; // namespace fdec
@@ -0,0 +1,67 @@
+#pragma once
+
+//
+// A compact root tree for the replayed FADC250 data
+// One entry per evio event, the event number (evtID) is the same as the one in the GEM replay trees,
+// so the trees can be joined offline (AddFriend or BuildIndex("evtID"))
+//
+
+#include "Fadc250Data.h"
+#include "TFile.h"
+#include "TTree.h"
+#include <string>
+
+#define FADC_TREE_MAX_CHANNELS 512
+#define FADC_TREE_MAX_PEAKS (FADC_TREE_MAX_CHANNELS*FADC250_MAX_NPEAKS)
+
+namespace fdec
+{
+
+// analysis results of one channel
+struct ReplayChannel
+{
+    int ch;         // 16*(fadc bank index in the event) + channel
+    float ped_mean, ped_err;
+    int npeaks;
+};
+
+// a peak found in one channel
+struct ReplayPeak
+{
+    int ch;
+    float height, integral, time;
+    int overflow;
+};
+
+class Fadc250RootTree
+{
+public:
+    Fadc250RootTree(const char *path);
+    ~Fadc250RootTree();
+
+    void Fill(int evtID, const ReplayChannel *channels, size_t nch, const ReplayPeak *peaks, size_t npeaks);
+    void Write();
+
+    const std::string &GetPath() const { return _path; }
+    static const char *TreeName() { return "FADC"; }
+
+private:
+    TFile *_file = nullptr;
+    TTree *_tree = nullptr;
+    std::string _path;
+
+    // information to save
+    int _evtID, _nch, _npeak;
+    int _ch[FADC_TREE_MAX_CHANNELS];
+    float _ped_mean[FADC_TREE_MAX_CHANNELS];
+    float _ped_err[FADC_TREE_MAX_CHANNELS];
+    int _ch_npeaks[FADC_TREE_MAX_CHANNELS];
+
+    int _peak_ch[FADC_TREE_MAX_PEAKS];
+    float _height[FADC_TREE_MAX_PEAKS];
+    float _integral[FADC_TREE_MAX_PEAKS];
+    float _time[FADC_TREE_MAX_PEAKS];
+    int _overflow[FADC_TREE_MAX_PEAKS];
+};
+
+}; // namespace fdec
@@ -85,12 +85,20 @@ public:
     // analyze waveform samples
     void Analyze(Fadc250Data &data) const;
     Fadc250Data Analyze(const uint32_t *samples, size_t nsamples) const;
+    // analyze all channels of an event together, samples of all channels are laid out as rows of one
+    // contiguous buffer and each processing step runs over all channels before the next one
+    // a spectrum without flat baseline uses an iterative pedestal instead of TSpectrum
+    void Analyze(std::vector<Fadc250Data> &channels) const;
 
     // find pedestal, it assumes the pedestal is a constant (for simple FADC250 spectrum)
     Pedestal FindPedestal(const std::vector<double> &buffer, const std::vector<Peak> &/*peaks*/) const;
 
     // search local maxima as peak candidates
     std::vector<Peak> SearchMaxima(const std::vector<double> &buffer, double height_thres) const;
+    void SearchMaxima(const std::vector<double> &buffer, double height_thres,
+                      std::vector<Peak> &candidates) const;
+    void SearchMaxima(const double *buffer, size_t npts, double height_thres,
+                      std::vector<Peak> &candidates) const;
 
     // get
     double GetThreshold() const { return _thres; }
@@ -111,16 +119,39 @@ private:
     size_t _res, _npeds;
     uint32_t _overflow;
 
+    // scratch buffers reused by Analyze(Fadc250Data &), so analyzing a channel
+    // does no heap allocation in steady state
+    // (one analyzer per thread)
+    mutable std::vector<double> _buffer;
+    mutable std::vector<Peak> _candidates;
+    // batch analysis: raw and smoothed samples of all channels, one row per channel
+    mutable std::vector<double> _rows_raw, _rows;
+    // trend between neighboring samples
+    mutable std::vector<int> _trend;
+
+    Pedestal findPedestal(const double *buffer, size_t npts, bool use_tspectrum) const;
+    void fillPeaks(Fadc250Data &data, const double *buffer, std::vector<Peak> &candidates) const;
+
 
 public:
     // static methods
     template<typename T>
     static std::vector<double> SmoothSpectrum(const T *samples, size_t nsamples, size_t res)
+    {
+        std::vector<double> buffer;
+        SmoothSpectrum(samples, nsamples, res, buffer);
+        return buffer;
+    }
+
+    // smooth into a given buffer, its memory is reused
+    template<typename T>
+    static void SmoothSpectrum(const T *samples, size_t nsamples, size_t res, std::vector<double> &buffer)
     {
         if (res <= 1) {
-            return std::vector<double>(samples, samples + nsamples);
+            buffer.assign(samples, samples + nsamples);
+            return;
         }
-        std::vector<double> buffer(nsamples);
+        buffer.resize(nsamples);
         for (size_t i = 0; i < nsamples; ++i) {
             double val = samples[i];
             double weights = 1.0;
@@ -132,7 +163,40 @@ public:
             }
             buffer[i] = val/weights;
         }
-        return buffer;
+    }
+
+    // same result as SmoothSpectrum, the samples where all neighbors are inside the window share the
+    // same weights and are accumulated one neighbor at a time, so the loop vectorizes
+    static void SmoothRow(const double *samples, double *buffer, size_t nsamples, size_t res)
+    {
+        if (res <= 1) {
+            for (size_t i = 0; i < nsamples; ++i) { buffer[i] = samples[i]; }
+            return;
+        }
+        if (nsamples <= 2*res) {
+            smoothEdge(samples, buffer, nsamples, res, 0, nsamples);
+            return;
+        }
+
+        double weights = 1.0;
+        for (size_t j = 1; j < res; ++j) {
+            weights += 2.*(1.0 - j/static_cast<double>(res + 1));
+        }
+
+        // inner samples
+        const size_t end = nsamples - res + 1;
+        for (size_t i = res; i < end; ++i) { buffer[i] = samples[i]; }
+        for (size_t j = 1; j < res; ++j) {
+            const double weight = 1.0 - j/static_cast<double>(res + 1);
+            for (size_t i = res; i < end; ++i) {
+                buffer[i] += weight*(samples[i - j] + samples[i + j]);
+            }
+        }
+        for (size_t i = res; i < end; ++i) { buffer[i] /= weights; }
+
+        // edges
+        smoothEdge(samples, buffer, nsamples, res, 0, res);
+        smoothEdge(samples, buffer, nsamples, res, end, nsamples);
     }
 
     template<typename T>
@@ -157,6 +221,23 @@ public:
         return res;
     }
 
+private:
+    static void smoothEdge(const double *samples, double *buffer, size_t nsamples, size_t res,
+                           size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i) {
+            double val = samples[i];
+            double weights = 1.0;
+            for (size_t j = 1; j < res; ++j) {
+                if (j >= i || j + i >= nsamples) { continue; }
+                double weight = 1.0 - j/static_cast<double>(res + 1);
+                val += weight*(samples[i - j] + samples[i + j]);
+                weights += 2.*weight;
+            }
+            buffer[i] = val/weights;
+        }
+    }
+
 };  // class Analyzer
 
 };  // namespace fdec
@@ -0,0 +1,451 @@
+#include "Fadc250Replay.h"
+#include "EvioFileReader.h"
+#include "EventParser.h"
+#include "AbstractRawDecoder.h"
+#include "RolStruct.h"
+#include "TROOT.h"
+#include "TChain.h"
+#include <iostream>
+#include <cstdio>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+
+using namespace fdec;
+
+// evio version 4 block header
+#define EVIO_BLOCK_HEADER_SIZE 8
+#define EVIO_MAGIC 0xc0da0100
+#define EVIO_DICTIONARY_MASK 0x100
+
+// events read from a split, waiting for analysis or being analyzed
+struct Fadc250Replay::Chunk
+{
+    Split *split;
+    size_t seq;                 // chunk index in the split
+    int first_event;            // event number of the first event
+
+    // fadc banks of all events, copied from the evio buffer
+    std::vector<uint32_t> words;
+    std::vector<uint32_t> bank_begin, bank_len;
+    std::vector<uint32_t> event_banks{0};   // banks of event i: [event_banks[i], event_banks[i + 1])
+
+    // results, channels and peaks of event i: [event_ch[i], event_ch[i + 1])
+    std::vector<ReplayChannel> channels;
+    std::vector<ReplayPeak> peaks;
+    std::vector<uint32_t> event_ch, event_pk;
+
+    size_t NEvents() const { return event_banks.size() - 1; }
+};
+
+// a split file, its chunks are written in order to its own tree
+struct Fadc250Replay::Split
+{
+    std::string path, output;
+    int first_event = 1;
+    long expected_events = -1;
+
+    Fadc250RootTree *tree = nullptr;
+    std::mutex mtx;
+    size_t next_chunk = 0;
+    std::map<size_t, std::unique_ptr<Chunk>> pending;
+    int events = 0;
+};
+
+namespace fdec
+{
+
+// copy fadc banks of an event to the current chunk
+class BankRecorder : public AbstractRawDecoder
+{
+public:
+    void Decode(const uint32_t *pBuf, uint32_t fBufLen, [[maybe_unused]] std::vector<int> &vTagTrack)
+    {
+        chunk->bank_begin.push_back(chunk->words.size());
+        chunk->bank_len.push_back(fBufLen);
+        chunk->words.insert(chunk->words.end(), pBuf, pBuf + fBufLen);
+    }
+    void Clear() {}
+
+    Fadc250Replay::Chunk *chunk = nullptr;
+};
+
+}; // namespace fdec
+
+// constructor
+Fadc250Replay::Fadc250Replay(const Analyzer &ana)
+: _ana(ana)
+{
+    // place holder
+}
+
+// destructor
+Fadc250Replay::~Fadc250Replay()
+{
+    // place holder
+}
+
+// replay a run
+int Fadc250Replay::Replay(const std::string &path, int split_start, int split_end, const std::string &output)
+{
+    auto begin = std::chrono::steady_clock::now();
+    _cancel = false;
+
+    std::string out = output.empty() ? ParseOutputFileName(path, ("Rootfiles/fadc_" + std::to_string(split_start)).c_str())
+                                     : output;
+
+    // splits and the event number of their first events
+    std::vector<std::unique_ptr<Split>> splits;
+    if (split_end < 0) {
+        splits.emplace_back(new Split);
+        splits.back()->path = path;
+        splits.back()->output = out;
+    } else {
+        // temporary output of a split: xxx.root -> xxx_split<N>.root
+        auto split_output = [&out] (int i) {
+            std::string base = out;
+            if (base.size() > 5 && base.compare(base.size() - 5, 5, ".root") == 0) {
+                base.erase(base.size() - 5);
+            }
+            return base + "_split" + std::to_string(i) + ".root";
+        };
+
+        int first_event = 1;
+        for (int i = split_start; i < split_end; ++i) {
+            std::string split_path = GetSplitFileName(path, i);
+            if (split_path.empty()) {
+                std::cout << __func__ << " Error: only evio/dat files are accepted." << path << std::endl;
+                return 0;
+            }
+            long nev = CountEvents(split_path);
+            if (nev < 0) {
+                std::cout << "Skipped file: " << split_path << std::endl;
+                continue;
+            }
+            splits.emplace_back(new Split);
+            auto &split = *splits.back();
+            split.path = split_path;
+            split.output = split_output(i);
+            split.first_event = first_event;
+            split.expected_events = nev;
+            first_event += nev;
+        }
+        if (splits.size() == 1) {
+            splits.back()->output = out;
+        }
+    }
+    if (splits.empty()) {
+        return 0;
+    }
+
+    // trees of different splits are written from different threads
+    ROOT::EnableThreadSafety();
+
+    unsigned int nworkers = _nthreads > 0 ? _nthreads : std::max(1u, std::thread::hardware_concurrency());
+    size_t nreaders = std::min(splits.size(), static_cast<size_t>(nworkers));
+    _max_queue = 2*nworkers + nreaders;
+    _readers_done = false;
+    _queue.clear();
+
+    std::cout << "FADC replay of " << splits.size() << " file(s) with " << nreaders << " reader and "
+              << nworkers << " worker threads." << std::endl;
+
+    std::vector<std::thread> workers;
+    for (unsigned int i = 0; i < nworkers; ++i) {
+        workers.emplace_back(&Fadc250Replay::analyzeChunks, this);
+    }
+
+    // readers take the splits one after another
+    std::atomic<size_t> next_split{0};
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < nreaders; ++i) {
+        readers.emplace_back([&] () {
+            size_t k;
+            while (!_cancel && (k = next_split++) < splits.size()) {
+                readSplit(*splits[k]);
+            }
+        });
+    }
+    for (auto &th : readers) {
+        th.join();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_queue_mtx);
+        _readers_done = true;
+    }
+    _queue_cv.notify_all();
+    for (auto &th : workers) {
+        th.join();
+    }
+
+    // close all split trees
+    int count = 0;
+    for (auto &split : splits) {
+        if (split->tree) {
+            split->tree->Write();
+            delete split->tree;
+            split->tree = nullptr;
+        }
+        if (!_cancel && split->expected_events >= 0 && split->events != split->expected_events) {
+            std::cout << "Warning: " << split->path << " has " << split->events << " events, expected "
+                      << split->expected_events << " from the block headers, event numbers of the following "
+                      << "splits will not match the GEM replay." << std::endl;
+        }
+        count += split->events;
+    }
+
+    // merge splits in order
+    if (splits.size() > 1) {
+        TChain chain(Fadc250RootTree::TreeName());
+        for (auto &split : splits) {
+            if (split->events > 0) {
+                chain.Add(split->output.c_str());
+            }
+        }
+        if (chain.GetNtrees() > 0) {
+            chain.Merge(out.c_str(), "fast");
+        }
+        for (auto &split : splits) {
+            std::remove(split->output.c_str());
+        }
+    }
+    std::cout << "writing root file to: " << out << std::endl;
+
+    double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "Replayed " << count << " events in " << t << " s (" << (t > 0. ? count/t : 0.)
+              << " events/s)" << std::endl;
+    if (_cancel) {
+        std::cout << "Replay was cancelled, output saved up to the last analyzed chunk." << std::endl;
+    }
+    return count;
+}
+
+// read all events of a split into chunks
+void Fadc250Replay::readSplit(Split &split)
+{
+    EvioFileReader reader;
+    reader.SetFile(split.path);
+    if (!reader.OpenFile()) {
+        std::cout << "Skipped file: " << split.path << std::endl;
+        return;
+    }
+
+    EventParser parser;
+    BankRecorder recorder;
+    parser.RegisterRawDecoder(static_cast<int>(Bank_TagID::FADC), &recorder);
+
+    auto new_chunk = [&] (size_t seq, int first_event) {
+        std::unique_ptr<Chunk> chunk(new Chunk);
+        chunk->split = &split;
+        chunk->seq = seq;
+        chunk->first_event = first_event;
+        recorder.chunk = chunk.get();
+        return chunk;
+    };
+
+    size_t seq = 0;
+    int nev = 0;
+    auto chunk = new_chunk(seq, split.first_event);
+
+    const uint32_t *pBuf;
+    uint32_t fBufLen;
+    while (!_cancel && reader.ReadNoCopy(&pBuf, &fBufLen) == S_SUCCESS) {
+        parser.ParseEvent(pBuf, fBufLen);
+        chunk->event_banks.push_back(chunk->bank_begin.size());
+        nev++;
+
+        if (chunk->NEvents() >= _chunk_size) {
+            pushChunk(std::move(chunk));
+            chunk = new_chunk(++seq, split.first_event + nev);
+        }
+    }
+    if (chunk->NEvents() > 0) {
+        pushChunk(std::move(chunk));
+    }
+
+    reader.CloseFile();
+}
+
+// put a chunk in the queue, wait if the workers are behind
+void Fadc250Replay::pushChunk(std::unique_ptr<Chunk> chunk)
+{
+    std::unique_lock<std::mutex> lock(_queue_mtx);
+    _queue_cv.wait(lock, [this] () { return _queue.size() < _max_queue || _cancel; });
+    _queue.push_back(std::move(chunk));
+    lock.unlock();
+    _queue_cv.notify_all();
+}
+
+// worker thread, analyze chunks until all readers are done
+void Fadc250Replay::analyzeChunks()
+{
+    // each worker has its own decoder and analyzer (scratch buffers)
+    Fadc250Decoder decoder;
+    Analyzer ana(_ana);
+
+    while (true) {
+        std::unique_ptr<Chunk> chunk;
+        {
+            std::unique_lock<std::mutex> lock(_queue_mtx);
+            _queue_cv.wait(lock, [this] () { return !_queue.empty() || _readers_done; });
+            if (_queue.empty()) {
+                return;
+            }
+            chunk = std::move(_queue.front());
+            _queue.pop_front();
+        }
+        _queue_cv.notify_all();
+
+        analyzeChunk(*chunk, decoder, ana);
+        writeChunk(std::move(chunk));
+    }
+}
+
+// decode and analyze all events in a chunk
+void Fadc250Replay::analyzeChunk(Chunk &chunk, Fadc250Decoder &decoder, const Analyzer &ana) const
+{
+    std::vector<int> tags;
+    size_t nev = chunk.NEvents();
+    chunk.event_ch.assign(1, 0);
+    chunk.event_pk.assign(1, 0);
+
+    for (size_t i = 0; i < nev; ++i) {
+        for (uint32_t b = chunk.event_banks[i]; b < chunk.event_banks[i + 1]; ++b) {
+            decoder.Clear();
+            decoder.Decode(&chunk.words[chunk.bank_begin[b]], chunk.bank_len[b], tags);
+            auto &channels = decoder.GetDecodedEvent().channels;
+            ana.Analyze(channels);
+
+            int ch_offset = 16*(b - chunk.event_banks[i]);
+            for (size_t ch = 0; ch < channels.size(); ++ch) {
+                auto &data = channels[ch];
+                if (data.raw.empty()) { continue; }
+                int id = ch_offset + static_cast<int>(ch);
+                chunk.channels.push_back(ReplayChannel{id, static_cast<float>(data.ped.mean),
+                                                       static_cast<float>(data.ped.err),
+                                                       static_cast<int>(data.peaks.size())});
+                for (auto &peak : data.peaks) {
+                    chunk.peaks.push_back(ReplayPeak{id, static_cast<float>(peak.height),
+                                                     static_cast<float>(peak.integral),
+                                                     static_cast<float>(peak.time), peak.overflow ? 1 : 0});
+                }
+            }
+        }
+        chunk.event_ch.push_back(chunk.channels.size());
+        chunk.event_pk.push_back(chunk.peaks.size());
+    }
+
+    // raw data is not needed anymore
+    std::vector<uint32_t>().swap(chunk.words);
+}
+
+// write the chunk if it is the next one of its split, otherwise keep it until the previous ones are written
+void Fadc250Replay::writeChunk(std::unique_ptr<Chunk> chunk)
+{
+    Split &split = *chunk->split;
+    std::lock_guard<std::mutex> lock(split.mtx);
+
+    split.pending[chunk->seq] = std::move(chunk);
+    auto it = split.pending.begin();
+    while (it != split.pending.end() && it->first == split.next_chunk) {
+        auto &c = *it->second;
+        if (!split.tree) {
+            split.tree = new Fadc250RootTree(split.output.c_str());
+        }
+        for (size_t i = 0; i < c.NEvents(); ++i) {
+            split.tree->Fill(c.first_event + static_cast<int>(i),
+                             &c.channels[c.event_ch[i]], c.event_ch[i + 1] - c.event_ch[i],
+                             &c.peaks[c.event_pk[i]], c.event_pk[i + 1] - c.event_pk[i]);
+        }
+        split.events += c.NEvents();
+        split.next_chunk++;
+        it = split.pending.erase(it);
+    }
+}
+
+// get file name of a split: xxx.evio.N, same as the GEM replay
+std::string Fadc250Replay::GetSplitFileName(const std::string &path, int split)
+{
+    size_t pos = 0;
+    if (path.find("evio") != std::string::npos) {
+        pos = path.find("evio") + 4;
+    } else if (path.find("dat") != std::string::npos) {
+        pos = path.find("dat") + 3;
+    } else {
+        return std::string();
+    }
+
+    return path.substr(0, pos) + "." + std::to_string(split);
+}
+
+// output file name from the input file name, same as the GEM replay
+// xxxx_235.evio.0 -> <prefix>_xxxx_235.root
+std::string Fadc250Replay::ParseOutputFileName(const std::string &input, const char *prefix)
+{
+    size_t pos_start = 0;
+    if (input.find("evio") != std::string::npos) {
+        pos_start = input.find("evio");
+    } else if (input.find("dat") != std::string::npos) {
+        pos_start = input.find("dat");
+    } else {
+        std::cout << __func__ << " Warning: only evio/dat files are accepted: " << input << std::endl;
+        return std::string("fadc_replay.root");
+    }
+
+    size_t not_dir = input.find_last_of("/");
+    not_dir = (not_dir == std::string::npos) ? 0 : not_dir + 1;
+
+    return prefix + std::string("_") + input.substr(not_dir, pos_start - not_dir) + "root";
+}
+
+// count events from the block headers, the dictionary is not an event (evio skips it when reading)
+long Fadc250Replay::CountEvents(const std::string &path)
+{
+    FILE *f = std::fopen(path.c_str(), "rb");
+    if (!f) {
+        return -1;
+    }
+
+    auto swap32 = [] (uint32_t v) {
+        return ((v >> 24) & 0xff) | ((v >> 8) & 0xff00) | ((v << 8) & 0xff0000) | ((v << 24) & 0xff000000);
+    };
+
+    std::fseek(f, 0, SEEK_END);
+    long size = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+
+    long count = 0, offset = 0;
+    bool first_block = true;
+    uint32_t header[EVIO_BLOCK_HEADER_SIZE];
+    while (std::fread(header, sizeof(uint32_t), EVIO_BLOCK_HEADER_SIZE, f) == EVIO_BLOCK_HEADER_SIZE) {
+        if (header[7] != EVIO_MAGIC) {
+            if (swap32(header[7]) != EVIO_MAGIC) {
+                std::cout << __func__ << " Error: bad evio block header in " << path << std::endl;
+                count = -1;
+                break;
+            }
+            for (auto &w : header) { w = swap32(w); }
+        }
+        if (header[0] < EVIO_BLOCK_HEADER_SIZE) {
+            std::cout << __func__ << " Error: bad evio block length in " << path << std::endl;
+            count = -1;
+            break;
+        }
+        // only complete blocks are read by evio
+        offset += 4L*header[0];
+        if (offset > size || std::fseek(f, offset, SEEK_SET) != 0) {
+            break;
+        }
+        long nev = header[3];
+        if (first_block && (header[5] & EVIO_DICTIONARY_MASK) && nev > 0) {
+            nev--;
+        }
+        count += nev;
+        first_block = false;
+    }
+
+    std::fclose(f);
+    return count;
+}
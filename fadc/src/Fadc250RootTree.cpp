@@ -0,0 +1,66 @@
+#include "Fadc250RootTree.h"
+#include <iostream>
+#include <algorithm>
+
+
+using namespace fdec;
+
+Fadc250RootTree::Fadc250RootTree(const char *path)
+: _path(path)
+{
+    _file = new TFile(path, "RECREATE");
+    _tree = new TTree(TreeName(), "FADC250 replay");
+
+    _tree->Branch("evtID", &_evtID, "evtID/I");
+    _tree->Branch("nch", &_nch, "nch/I");
+    _tree->Branch("ch", _ch, "ch[nch]/I");
+    _tree->Branch("ped_mean", _ped_mean, "ped_mean[nch]/F");
+    _tree->Branch("ped_err", _ped_err, "ped_err[nch]/F");
+    _tree->Branch("npeaks", _ch_npeaks, "npeaks[nch]/I");
+
+    _tree->Branch("npeak", &_npeak, "npeak/I");
+    _tree->Branch("peak_ch", _peak_ch, "peak_ch[npeak]/I");
+    _tree->Branch("height", _height, "height[npeak]/F");
+    _tree->Branch("integral", _integral, "integral[npeak]/F");
+    _tree->Branch("time", _time, "time[npeak]/F");
+    _tree->Branch("overflow", _overflow, "overflow[npeak]/I");
+}
+
+Fadc250RootTree::~Fadc250RootTree()
+{
+    // the tree is deleted when the file is closed in Write()
+}
+
+void Fadc250RootTree::Fill(int evtID, const ReplayChannel *channels, size_t nch, const ReplayPeak *peaks,
+                           size_t npeaks)
+{
+    _evtID = evtID;
+    _nch = static_cast<int>(std::min(nch, static_cast<size_t>(FADC_TREE_MAX_CHANNELS)));
+    _npeak = static_cast<int>(std::min(npeaks, static_cast<size_t>(FADC_TREE_MAX_PEAKS)));
+
+    for (int i = 0; i < _nch; ++i) {
+        _ch[i] = channels[i].ch;
+        _ped_mean[i] = channels[i].ped_mean;
+        _ped_err[i] = channels[i].ped_err;
+        _ch_npeaks[i] = channels[i].npeaks;
+    }
+
+    for (int i = 0; i < _npeak; ++i) {
+        _peak_ch[i] = peaks[i].ch;
+        _height[i] = peaks[i].height;
+        _integral[i] = peaks[i].integral;
+        _time[i] = peaks[i].time;
+        _overflow[i] = peaks[i].overflow;
+    }
+
+    _tree->Fill();
+}
+
+void Fadc250RootTree::Write()
+{
+    _file->cd();
+    _tree->Write();
+    _file->Close();
+    delete _file;
+    _file = nullptr;
+}
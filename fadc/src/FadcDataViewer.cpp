@@ -138,22 +138,22 @@ std::vector<TMultiGraph*> FadcDataViewer::GetEvent()
     }
 
     event_parser -> ParseEvent(pBuf, fBufLen);
-    const Fadc250Event &event = fadc_decoder -> GetDecodedEvent();
+    Fadc250Event &event = fadc_decoder -> GetDecodedEvent();
+
+    // analyze all channels together, in place
+    waveform_ana.Analyze(event.channels);
 
     int nch = 0;
-    // analyze channel data
-    for(auto &i: event.channels)
+    for(auto &data: event.channels)
     {
         // get waveform
-        Fadc250Data data = i;
-        waveform_ana.Analyze(data);
         WfRootGraph g = get_waveform_graph(waveform_ana, data.raw);
         g.mg->SetTitle(Form("FADC channel %d", nch));
         res.push_back(g.mg);
 
         // get timing (for each peak) for current event
         current_event_timing[nch].clear();
-        for(auto &i: g.result.peaks) {
+        for(auto &i: data.peaks) {
             current_event_timing[nch].push_back(i.time);
         }
 
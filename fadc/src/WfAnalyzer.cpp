@@ -20,14 +20,69 @@ void Analyzer::Analyze(Fadc250Data &data) const
 
     data.peaks.clear();
 
-    auto buffer = SmoothSpectrum(samples, nsamples, _res);
+    auto &buffer = _buffer;
+    SmoothSpectrum(samples, nsamples, _res, buffer);
 
     // search local maxima
-    auto candidates = SearchMaxima(buffer, _thres);
+    auto &candidates = _candidates;
+    SearchMaxima(buffer, _thres, candidates);
 
     // get pedestal
     data.ped = FindPedestal(buffer, candidates);
 
+    fillPeaks(data, &buffer[0], candidates);
+}
+
+// analyze all channels of an event
+void Analyzer::Analyze(std::vector<Fadc250Data> &channels) const
+{
+    size_t nch = channels.size();
+    // one row per channel, rows padded to 8 samples (64 bytes)
+    size_t stride = 0;
+    for (auto &data : channels) {
+        stride = std::max(stride, data.raw.size());
+    }
+    stride = (stride + 7) & ~static_cast<size_t>(7);
+    if (!stride) { return; }
+
+    _rows_raw.resize(nch*stride);
+    _rows.resize(nch*stride);
+
+    // integer samples to floating point
+    for (size_t ch = 0; ch < nch; ++ch) {
+        const uint32_t *samples = channels[ch].raw.data();
+        double *row = &_rows_raw[ch*stride];
+        size_t nsamples = channels[ch].raw.size();
+        for (size_t i = 0; i < nsamples; ++i) {
+            row[i] = samples[i];
+        }
+    }
+
+    // smoothing
+    for (size_t ch = 0; ch < nch; ++ch) {
+        SmoothRow(&_rows_raw[ch*stride], &_rows[ch*stride], channels[ch].raw.size(), _res);
+    }
+
+    // candidates, pedestal and peaks
+    for (size_t ch = 0; ch < nch; ++ch) {
+        auto &data = channels[ch];
+        size_t nsamples = data.raw.size();
+        if (!nsamples) { continue; }
+
+        data.peaks.clear();
+        const double *buffer = &_rows[ch*stride];
+        SearchMaxima(buffer, nsamples, _thres, _candidates);
+        data.ped = findPedestal(buffer, nsamples, false);
+        fillPeaks(data, buffer, _candidates);
+    }
+}
+
+// get the peak properties from the candidates
+void Analyzer::fillPeaks(Fadc250Data &data, const double *buffer, std::vector<Peak> &candidates) const
+{
+    const uint32_t *samples = &data.raw[0];
+    size_t nsamples = data.raw.size();
+
     // get final results
     for (auto &peak : candidates) {
         // pedestal subtraction
@@ -108,26 +163,52 @@ Fadc250Data Analyzer::Analyze(const uint32_t *samples, size_t nsamples) const
 
 //find pedestal, it assumes the pedestal is a constant (for simple FADC250 spectrum)
 Pedestal Analyzer::FindPedestal(const std::vector<double> &buffer, const std::vector<Peak> &/*peaks*/) const
+{
+    return findPedestal(buffer.data(), buffer.size(), true);
+}
+
+Pedestal Analyzer::findPedestal(const double *buffer, size_t npts, bool use_tspectrum) const
 {
     Pedestal ped{0., 0.};
     // too few samples, use the minimum value as the pedestal
-    if (buffer.size() < _npeds) {
-        _calc_mean_err(ped.mean, ped.err, &buffer[0], buffer.size());
-        for (auto &val : buffer) {
-            if (val < ped.mean) { ped.mean = val; }
+    if (npts < _npeds) {
+        _calc_mean_err(ped.mean, ped.err, buffer, npts);
+        for (size_t i = 0; i < npts; ++i) {
+            if (buffer[i] < ped.mean) { ped.mean = buffer[i]; }
         }
         return ped;
     }
 
     // number of trailing samples for pedestal
-    int ntrails = std::max(_npeds, buffer.size()/12);
+    size_t ntrails = std::max(_npeds, npts/12);
     // criteria for good pedestal (some overflow events will have a few flat samples)
     double max_mean = _overflow*0.95;
     bool find_baseline = false;
 
+    // running sums over the window only pick the windows that can be flat and lower than the current
+    // baseline, they are accurate to far below the margins, mean and error of those windows are then
+    // calculated exactly as before
+    double sum = 0., sum2 = 0.;
+    for (size_t i = 0; i < ntrails; ++i) {
+        sum += buffer[i];
+        sum2 += buffer[i]*buffer[i];
+    }
+    double flat_cut = _ped_flat*_ped_flat*ntrails;
+
     // progressively find a good baseline
     ped.mean = max_mean;
-    for (size_t i = 0; i <= buffer.size() - ntrails; ++i) {
+    for (size_t i = 0; i <= npts - ntrails; ++i) {
+        if (i > 0) {
+            double in = buffer[i + ntrails - 1], out = buffer[i - 1];
+            sum += in - out;
+            sum2 += in*in - out*out;
+        }
+        // sum of squared deviations, and no chance to be lower than the current baseline
+        if ((sum2 - sum*sum/ntrails > flat_cut*(1. + 1e-6) + sum2*1e-9) ||
+            (sum/ntrails > ped.mean + std::abs(ped.mean)*1e-9)) {
+            continue;
+        }
+
         double mean = 0., err = 100.*_ped_flat;
         _calc_mean_err(mean, err, &buffer[i], ntrails);
         if(err < _ped_flat && mean < max_mean) {
@@ -140,7 +221,13 @@ Pedestal Analyzer::FindPedestal(const std::vector<double> &buffer, const std::ve
     }
 
     // complicated spectrum
-    auto ybuf = buffer;
+    if (!use_tspectrum) {
+        // iteratively drop the samples away from the mean, the peaks go first
+        _buffer.assign(buffer, buffer + npts);
+        return CalcPedestal(&_buffer[0], npts, 1.0, 10, _npeds);
+    }
+
+    std::vector<double> ybuf(buffer, buffer + npts);
     TSpectrum s;
     s.Background(&ybuf[0], ybuf.size(), ybuf.size()/4, TSpectrum::kBackDecreasingWindow,
                     TSpectrum::kBackOrder2, false, TSpectrum::kBackSmoothing3, false);
@@ -150,24 +237,44 @@ Pedestal Analyzer::FindPedestal(const std::vector<double> &buffer, const std::ve
 std::vector<Peak> Analyzer::SearchMaxima(const std::vector<double> &buffer, double height_thres) const
 {
     std::vector<Peak> candidates;
-    if (buffer.size() < 3) { return candidates; }
-
-    candidates.reserve(buffer.size()/3);
-    // get trend
-    auto trend = [] (double v1, double v2, double thr = 0.1) {
-        return std::abs(v1 - v2) < thr ? 0 : (v1 > v2 ? 1 : -1);
-    };
-    for (uint32_t i = 1; i < buffer.size() - 1; ++i) {
-        int tr1 = trend(buffer[i], buffer[i - 1]);
-        int tr2 = trend(buffer[i], buffer[i + 1]);
+    SearchMaxima(buffer, height_thres, candidates);
+    return candidates;
+}
+
+// search local maxima into a given vector, its memory is reused
+void Analyzer::SearchMaxima(const std::vector<double> &buffer, double height_thres,
+                            std::vector<Peak> &candidates) const
+{
+    SearchMaxima(buffer.data(), buffer.size(), height_thres, candidates);
+}
+
+void Analyzer::SearchMaxima(const double *buffer, size_t npts, double height_thres,
+                            std::vector<Peak> &candidates) const
+{
+    candidates.clear();
+    if (npts < 3) { return; }
+
+    candidates.reserve(npts/3);
+    // trend between neighboring samples, trend(buffer[i + 1], buffer[i]), computed for all samples first
+    const double thr = 0.1;
+    _trend.resize(npts - 1);
+    int *trend = _trend.data();
+    for (size_t i = 0; i < npts - 1; ++i) {
+        double diff = buffer[i + 1] - buffer[i];
+        trend[i] = (std::abs(diff) < thr) ? 0 : (diff > 0. ? 1 : -1);
+    }
+
+    for (uint32_t i = 1; i < npts - 1; ++i) {
+        int tr1 = trend[i - 1];
+        int tr2 = -trend[i];
         // peak at the rising (declining) edge
         if ((tr1 * tr2 >= 0) && (std::abs(tr1) > 0)) {
             uint32_t left = 1, right = 1;
             // search the peak range
-            while ((i > left + 1) && (trend(buffer[i - left], buffer[i - left - 1]) == tr1)) {
+            while ((i > left + 1) && (trend[i - left - 1] == tr1)) {
                 left ++;
             }
-            while ((i + right < buffer.size() - 1) && (trend(buffer[i + right], buffer[i + right + 1])*tr1 >= 0)) {
+            while ((i + right < npts - 1) && (-trend[i + right]*tr1 >= 0)) {
                 right ++;
             }
 
@@ -178,6 +285,4 @@ std::vector<Peak> Analyzer::SearchMaxima(const std::vector<double> &buffer, doub
             }
         }
     }
-    return candidates;
 }
-
@@ -0,0 +1,128 @@
+#include "GEMEventGenerator.h"
+
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+
+////////////////////////////////////////////////////////////////
+// Generate synthetic MPD (SSP or VME) evio data from a mapping
+// file, together with the true pedestal, common mode range and
+// the injected clusters (truth), see GEMEventGenerator.h
+//
+// usage:
+//     evio_generator <gem_map.txt> <output.evio> [options]
+//
+// outputs besides the evio file(s):
+//     <output>.truth  injected clusters and strips
+//     <output>.ped    pedestal (gem_ped.dat format)
+//     <output>.cm     common mode range (CommonModeRange.txt format)
+
+static void print_usage(const char* exe)
+{
+    std::cout<<"usage: "<<std::endl
+             <<"    "<<exe<<" <gem_map.txt> <output.evio> [options]"<<std::endl
+             <<"options:"<<std::endl
+             <<"    -n <events>        number of events (1000)"<<std::endl
+             <<"    -s <events>        events per split, writes output.evio.N (0: no split)"<<std::endl
+             <<"    -r <ssp|vme>       readout format (ssp)"<<std::endl
+             <<"    -a <apvs>          use the first n apvs of the map (0: all)"<<std::endl
+             <<"    -t <samples>       time samples, vme only (6)"<<std::endl
+             <<"    -o <occupancy>     average clusters per apv per event (0.05)"<<std::endl
+             <<"    -w <width>         cluster width, gaussian sigma in strips (1)"<<std::endl
+             <<"    -A <min> <max>     cluster amplitude range (200 1500)"<<std::endl
+             <<"    -N <noise>         average strip noise (10)"<<std::endl
+             <<"    -c <shift>         common mode shift sigma (20)"<<std::endl
+             <<"    -z <thres>         ssp online zero suppression, thres * noise"<<std::endl
+             <<"    -S <seed>          random seed (1)"<<std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc < 3) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::string map_file = argv[1], output = argv[2];
+    int nevents = 1000, events_per_split = 0, napvs = 0, nts = 6;
+    double occupancy = 0.05, width = 1., amp_min = 200., amp_max = 1500.;
+    double noise = 10., cm_shift = 20., zs_thres = -1.;
+    uint32_t seed = 1;
+    MPDReadout readout = MPDReadout::SSP;
+
+    for(int i=3; i<argc; i++)
+    {
+        bool has_arg = i + 1 < argc;
+        if(std::strcmp(argv[i], "-n") == 0 && has_arg)
+            nevents = std::atoi(argv[++i]);
+        else if(std::strcmp(argv[i], "-s") == 0 && has_arg)
+            events_per_split = std::atoi(argv[++i]);
+        else if(std::strcmp(argv[i], "-r") == 0 && has_arg) {
+            std::string r = argv[++i];
+            if(r == "vme")
+                readout = MPDReadout::VME;
+            else if(r == "ssp")
+                readout = MPDReadout::SSP;
+            else {
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+        else if(std::strcmp(argv[i], "-a") == 0 && has_arg)
+            napvs = std::atoi(argv[++i]);
+        else if(std::strcmp(argv[i], "-t") == 0 && has_arg)
+            nts = std::atoi(argv[++i]);
+        else if(std::strcmp(argv[i], "-o") == 0 && has_arg)
+            occupancy = std::atof(argv[++i]);
+        else if(std::strcmp(argv[i], "-w") == 0 && has_arg)
+            width = std::atof(argv[++i]);
+        else if(std::strcmp(argv[i], "-A") == 0 && i + 2 < argc) {
+            amp_min = std::atof(argv[++i]);
+            amp_max = std::atof(argv[++i]);
+        }
+        else if(std::strcmp(argv[i], "-N") == 0 && has_arg)
+            noise = std::atof(argv[++i]);
+        else if(std::strcmp(argv[i], "-c") == 0 && has_arg)
+            cm_shift = std::atof(argv[++i]);
+        else if(std::strcmp(argv[i], "-z") == 0 && has_arg)
+            zs_thres = std::atof(argv[++i]);
+        else if(std::strcmp(argv[i], "-S") == 0 && has_arg)
+            seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if(zs_thres >= 0 && readout != MPDReadout::SSP) {
+        std::cout<<"online zero suppression (-z) is only available for ssp readout"<<std::endl;
+        return 1;
+    }
+
+    GEMEventGenerator gen(map_file, seed);
+    gen.SetReadout(readout);
+    gen.SetTimeSamples(nts);
+    gen.SetAPVCount(napvs);
+    gen.SetNoise(noise);
+    gen.SetOccupancy(occupancy);
+    gen.SetClusterWidth(width);
+    gen.SetClusterAmplitude(amp_min, amp_max);
+    gen.SetCommonModeShift(cm_shift);
+    if(zs_thres >= 0)
+        gen.SetOnlineZeroSuppression(true, zs_thres);
+
+    if(gen.GetAPVCount() == 0) {
+        std::cout<<"no apv found in mapping file: "<<map_file<<std::endl;
+        return 1;
+    }
+
+    gen.WritePedestal(output + ".ped");
+    gen.WriteCommonModeRange(output + ".cm");
+    int count = gen.Generate(output, nevents, events_per_split, output + ".truth");
+
+    std::cout<<"generated "<<count<<" events, "<<gen.GetAPVCount()<<" apvs, "
+             <<gen.GetTimeSamples()<<" time samples to "<<output<<std::endl;
+
+    return count == nevents ? 0 : 1;
+}
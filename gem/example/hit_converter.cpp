@@ -0,0 +1,194 @@
+#include "GEMNativeHitFile.h"
+#include "APVStripMapping.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstring>
+
+#include <TFile.h>
+#include <TTree.h>
+
+////////////////////////////////////////////////////////////////
+// Convert GEM hit files between the root "GEMHit" tree format
+// (written by GEMRootHitTree) and the native columnar format
+// (written by GEMNativeHitWriter)
+//
+// usage:
+//     hit_converter root2native <in.root> <out.gemhit> [lz4]
+//     hit_converter native2root <in.gemhit> <out.root>
+//
+// note: the root hit tree does not carry the electronic channel
+// address, it is recovered from (prodID, axis, strip) with the
+// mapping in config/gem.conf, hits that cannot be mapped are dropped
+
+#define MAXHITS 20000
+#define ROOT_TIME_SAMPLES 6
+
+static void print_usage(const char* exe)
+{
+    std::cout<<"usage: "<<std::endl
+             <<"    "<<exe<<" root2native <in.root> <out.gemhit> [lz4]"<<std::endl
+             <<"    "<<exe<<" native2root <in.gemhit> <out.root>"<<std::endl;
+}
+
+////////////////////////////////////////////////////////////////
+// root tree -> native
+
+static int root2native(const char* in, const char* out, bool compress)
+{
+    TFile *f = new TFile(in, "READ");
+    if(f -> IsZombie()) {
+        std::cout<<"Error: cannot open file: "<<in<<std::endl;
+        return 1;
+    }
+    TTree *t = (TTree*)f -> Get("GEMHit");
+    if(t == nullptr) {
+        std::cout<<"Error: cannot find GEMHit tree in: "<<in<<std::endl;
+        return 1;
+    }
+
+    int evtID, nch;
+    static int Plane[MAXHITS], Prod[MAXHITS], Module[MAXHITS], Axis[MAXHITS], Strip[MAXHITS];
+    static int adc[ROOT_TIME_SAMPLES][MAXHITS];
+
+    t -> SetBranchAddress("evtID", &evtID);
+    t -> SetBranchAddress("nch", &nch);
+    t -> SetBranchAddress("planeID", Plane);
+    t -> SetBranchAddress("prodID", Prod);
+    t -> SetBranchAddress("moduleID", Module);
+    t -> SetBranchAddress("axis", Axis);
+    t -> SetBranchAddress("strip", Strip);
+    for(int ts=0; ts<ROOT_TIME_SAMPLES; ts++)
+        t -> SetBranchAddress(("adc" + std::to_string(ts)).c_str(), adc[ts]);
+
+    auto mapping = apv_strip_mapping::Mapping::Instance();
+    GEMNativeHitWriter writer(out, ROOT_TIME_SAMPLES, compress);
+
+    std::vector<uint32_t> v_addr(MAXHITS);
+    std::vector<int16_t> v_plane(MAXHITS), v_prod(MAXHITS), v_module(MAXHITS),
+        v_axis(MAXHITS), v_strip(MAXHITS), v_adc(MAXHITS * ROOT_TIME_SAMPLES);
+
+    uint64_t unmapped = 0;
+    GEMChannelAddress a;
+
+    Long64_t N = t -> GetEntries();
+    for(Long64_t i=0; i<N; i++)
+    {
+        t -> GetEntry(i);
+
+        int n = 0;
+        for(int k=0; k<nch; k++) {
+            if(!mapping -> GetChannelAddress(Prod[k], Axis[k], Strip[k], a)) {
+                unmapped++;
+                continue;
+            }
+            v_addr[n] = PackChannelAddress(a);
+            v_plane[n] = Plane[k];
+            v_prod[n] = Prod[k];
+            v_module[n] = Module[k];
+            v_axis[n] = Axis[k];
+            v_strip[n] = Strip[k];
+            for(int ts=0; ts<ROOT_TIME_SAMPLES; ts++)
+                v_adc[n*ROOT_TIME_SAMPLES + ts] = adc[ts][k];
+            n++;
+        }
+
+        writer.FillEvent(evtID, n, v_addr.data(), v_plane.data(), v_prod.data(),
+                v_module.data(), v_axis.data(), v_strip.data(), v_adc.data());
+    }
+
+    writer.Write();
+    f -> Close();
+
+    if(unmapped > 0)
+        std::cout<<"Warning: "<<unmapped<<" hits cannot be mapped to "
+                 <<"an electronic channel and were dropped."<<std::endl;
+    std::cout<<"converted "<<N<<" events."<<std::endl;
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////
+// native -> root tree, same layout as GEMRootHitTree
+
+static int native2root(const char* in, const char* out)
+{
+    GEMNativeHitReader reader;
+    if(!reader.Open(in))
+        return 1;
+
+    if(reader.GetTimeSamples() != ROOT_TIME_SAMPLES)
+        std::cout<<"Warning: native file has "<<reader.GetTimeSamples()
+                 <<" time samples, root tree only keeps the first "
+                 <<ROOT_TIME_SAMPLES<<std::endl;
+
+    int evtID, nch;
+    static int Plane[MAXHITS], Prod[MAXHITS], Module[MAXHITS], Axis[MAXHITS], Strip[MAXHITS];
+    static int adc[ROOT_TIME_SAMPLES][MAXHITS];
+
+    TFile *f = new TFile(out, "RECREATE");
+    TTree *t = new TTree("GEMHit", "Hit list");
+
+    t -> Branch("evtID", &evtID, "evtID/I");
+    t -> Branch("nch", &nch, "nch/I");
+    t -> Branch("planeID", Plane, "planeID[nch]/I");
+    t -> Branch("prodID", Prod, "prodID[nch]/I");
+    t -> Branch("moduleID", Module, "moduleID[nch]/I");
+    t -> Branch("axis", Axis, "axis[nch]/I");
+    t -> Branch("strip", Strip, "strip[nch]/I");
+    for(int ts=0; ts<ROOT_TIME_SAMPLES; ts++) {
+        std::string name = "adc" + std::to_string(ts);
+        t -> Branch(name.c_str(), adc[ts], (name + "[nch]/I").c_str());
+    }
+
+    uint32_t nts = reader.GetTimeSamples();
+    NativeHitEvent ev;
+    for(uint64_t i=0; i<reader.GetEntries(); i++)
+    {
+        if(!reader.GetEvent(i, ev))
+            break;
+
+        evtID = ev.evtID;
+        nch = ev.nch > MAXHITS ? MAXHITS : ev.nch;
+
+        for(int k=0; k<nch; k++) {
+            Plane[k] = ev.plane[k];
+            Prod[k] = ev.prod[k];
+            Module[k] = ev.module[k];
+            Axis[k] = ev.axis[k];
+            Strip[k] = ev.strip[k];
+            for(uint32_t ts=0; ts<ROOT_TIME_SAMPLES; ts++)
+                adc[ts][k] = ts < nts ? ev.ADC(k, ts) : 0;
+        }
+
+        t -> Fill();
+    }
+
+    f -> Write();
+    f -> Close();
+
+    std::cout<<"converted "<<reader.GetEntries()<<" events."<<std::endl;
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////
+// main
+
+int main(int argc, char* argv[])
+{
+    if(argc < 4) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if(strcmp(argv[1], "root2native") == 0) {
+        bool compress = (argc > 4 && strcmp(argv[4], "lz4") == 0);
+        return root2native(argv[2], argv[3], compress);
+    }
+    else if(strcmp(argv[1], "native2root") == 0) {
+        return native2root(argv[2], argv[3]);
+    }
+
+    print_usage(argv[0]);
+    return 1;
+}
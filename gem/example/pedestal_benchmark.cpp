@@ -0,0 +1,155 @@
+#include "GEMPedestal.h"
+
+#include <iostream>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+
+#include <TH1.h>
+#include <TH1I.h>
+
+////////////////////////////////////////////////////////////////
+// Benchmark the pedestal calculation: all strip samples stored
+// (RawAPVUnit_vec + GenerateAPVPedestal_using_vec) vs. dense
+// streaming statistics (RawAPVUnit_stat + GenerateAPVPedestal_using_stat)
+//
+// raw apv data are generated randomly, no evio file needed
+//
+// usage:
+//     pedestal_benchmark [number of events] [number of apvs] [time samples]
+
+typedef std::unordered_map<APVAddress, std::vector<int>> APVEvent;
+
+////////////////////////////////////////////////////////////////
+// generate pedestal events, every strip has its own offset and
+// noise, every time sample has its own common mode
+
+static std::vector<APVEvent> generate_events(int nevents, int napvs, int nts)
+{
+    std::mt19937 gen(12345);
+    std::uniform_real_distribution<double> offset_dist(600., 1000.);
+    std::uniform_real_distribution<double> noise_dist(5., 25.);
+    std::normal_distribution<double> unit(0., 1.);
+
+    std::vector<APVAddress> apvs;
+    std::vector<double> offset, noise;
+    for(int i=0; i<napvs; i++) {
+        apvs.emplace_back(i / 160, (i / 16) % 10, i % 16);
+        for(int strip=0; strip<APV_STRIP_SIZE; strip++) {
+            offset.push_back(offset_dist(gen));
+            noise.push_back(noise_dist(gen));
+        }
+    }
+
+    std::vector<APVEvent> res(nevents);
+    for(auto &ev: res)
+    {
+        for(int i=0; i<napvs; i++)
+        {
+            std::vector<int> &data = ev[apvs[i]];
+            data.resize(MPD_APV_TS_LEN * nts, 0);
+
+            for(int ts=0; ts<nts; ts++) {
+                double common_mode = 30. * unit(gen);
+                for(int strip=0; strip<APV_STRIP_SIZE; strip++) {
+                    int k = i*APV_STRIP_SIZE + strip;
+                    data[ts*MPD_APV_TS_LEN + strip] = static_cast<int>(
+                            offset[k] + common_mode + noise[k] * unit(gen));
+                }
+            }
+        }
+    }
+
+    return res;
+}
+
+////////////////////////////////////////////////////////////////
+// time one pedestal method
+
+template<typename Fill, typename Generate>
+static double run(GEMPedestal &ped, const std::vector<APVEvent> &events,
+        Fill fill, Generate generate)
+{
+    auto begin = std::chrono::steady_clock::now();
+
+    PedestalAccumulator acc;
+    for(auto &ev: events)
+        for(auto &apv: ev)
+            fill(ped, apv, acc);
+    ped.MergeAccumulator(acc);
+    generate(ped);
+
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+////////////////////////////////////////////////////////////////
+// compare the two results strip by strip
+
+static int compare(const GEMPedestal &a, const GEMPedestal &b)
+{
+    int ndiff = 0;
+    auto cmp = [&](const std::unordered_map<APVAddress, TH1I*> &ha,
+            const std::unordered_map<APVAddress, TH1I*> &hb)
+    {
+        for(auto &i: ha) {
+            auto it = hb.find(i.first);
+            if(it == hb.end()) {
+                ndiff += APV_STRIP_SIZE;
+                continue;
+            }
+            for(int strip=0; strip<APV_STRIP_SIZE; strip++)
+                if(i.second -> GetBinContent(strip + 10) != it -> second -> GetBinContent(strip + 10))
+                    ndiff++;
+        }
+    };
+
+    cmp(a.GetAPVNoiseHisto(), b.GetAPVNoiseHisto());
+    cmp(a.GetAPVOffsetHisto(), b.GetAPVOffsetHisto());
+    return ndiff;
+}
+
+////////////////////////////////////////////////////////////////
+// main
+
+int main(int argc, char* argv[])
+{
+    int nevents = (argc > 1) ? atoi(argv[1]) : 5000;
+    int napvs = (argc > 2) ? atoi(argv[2]) : 64;
+    int nts = (argc > 3) ? atoi(argv[3]) : 6;
+
+    // both methods create histograms with the same names
+    TH1::AddDirectory(kFALSE);
+
+    std::cout<<"generating "<<nevents<<" events, "<<napvs<<" apvs, "
+             <<nts<<" time samples..."<<std::endl;
+    auto events = generate_events(nevents, napvs, nts);
+
+    GEMPedestal ped_vec, ped_stat;
+
+    double t_vec = run(ped_vec, events,
+            [](GEMPedestal &p, const APVEvent::value_type &apv, PedestalAccumulator &acc)
+            {p.RawAPVUnit_vec(apv, acc);},
+            [](GEMPedestal &p) {p.GenerateAPVPedestal_using_vec();});
+
+    double t_stat = run(ped_stat, events,
+            [](GEMPedestal &p, const APVEvent::value_type &apv, PedestalAccumulator &acc)
+            {p.RawAPVUnit_stat(apv, acc);},
+            [](GEMPedestal &p) {p.GenerateAPVPedestal_using_stat();});
+
+    // memory held by the accumulators at the end of the run
+    size_t nstrips = static_cast<size_t>(napvs) * APV_STRIP_SIZE;
+    size_t mem_vec = nstrips * 2 * nevents * sizeof(int);
+    size_t mem_stat = nstrips * 2 * sizeof(StripStat);
+
+    std::cout<<"vector (all samples) : "<<t_vec<<" ms, ~"
+             <<mem_vec / 1024 / 1024<<" MB of samples"<<std::endl;
+    std::cout<<"dense streaming stat : "<<t_stat<<" ms, ~"
+             <<mem_stat / 1024<<" kB of statistics"<<std::endl;
+    std::cout<<"speed up             : "<<t_vec / t_stat<<std::endl;
+
+    int ndiff = compare(ped_vec, ped_stat);
+    std::cout<<"strips with different noise/offset: "<<ndiff<<std::endl;
+
+    return ndiff == 0 ? 0 : 1;
+}
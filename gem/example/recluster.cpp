@@ -0,0 +1,35 @@
+#include "GEMRecluster.h"
+
+#include <iostream>
+#include <string>
+
+////////////////////////////////////////////////////////////////
+// Re-cluster replayed hits with (new) cluster parameters
+//
+// usage:
+//     recluster <hit.root | hit.gemhit> <cluster.root> [nthreads] [cluster.conf]
+//
+// input is a GEMHit root tree or a native hit file (skim),
+// the default cluster configuration is the one in config/gem.conf
+
+int main(int argc, char* argv[])
+{
+    if(argc < 3) {
+        std::cout<<"usage: "<<argv[0]
+                 <<" <hit.root | hit.gemhit> <cluster.root> [nthreads] [cluster.conf]"
+                 <<std::endl;
+        return 1;
+    }
+
+    int nthreads = 4;
+    if(argc > 3)
+        nthreads = std::stoi(argv[3]);
+
+    GEMRecluster recluster("config/gem.conf", nthreads);
+    if(argc > 4)
+        recluster.SetClusterConfiguration(argv[4]);
+
+    recluster.Run(argv[1], argv[2]);
+
+    return 0;
+}
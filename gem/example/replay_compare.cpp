@@ -0,0 +1,313 @@
+#include "GEMSystem.h"
+#include "GEMDataHandler.h"
+#include "GEMGoldenOutput.h"
+#include "ConfigObject.h"
+#include "EvioFileReader.h"
+#include "EventParser.h"
+#include "MPDVMERawEventDecoder.h"
+#include "MPDSSPRawEventDecoder.h"
+#include "RolStruct.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <cstring>
+#include <cstdlib>
+
+////////////////////////////////////////////////////////////////
+// Golden output regression check of the replay chain
+//
+// the reference pipeline is the plain serial chain:
+//     EventParser -> MPD decoder -> GEMSystem::FillRawDataMPD
+//     (apv by apv) -> GEMSystem::Reconstruct
+// the candidate pipeline is GEMDataHandler::Replay (threaded zero
+// suppression, event process thread, and whatever optimization is
+// built in), its output files go to Rootfiles/ as in a normal replay
+//
+// zero suppressed strips and clusters are compared event by event,
+// see GEMGoldenOutput.h
+//
+// usage:
+//     replay_compare -i <evio> [options]
+//         run both pipelines on the input and compare them
+//     replay_compare -i <evio> -w <golden>
+//         save the candidate output as golden (e.g. before a change)
+//     replay_compare -i <evio> -g <golden>
+//         compare the candidate output to a golden file (after a change)
+//     replay_compare -A <golden> -B <golden>
+//         compare two golden files
+// options:
+//     -c <config>        gem configuration (config/gem.conf)
+//     -n <events>        number of events, 0 for all (1000)
+//     -p <ped> <cm>      pedestal and common mode range files
+//     -r                 -w/-g use the reference pipeline
+//     -s                 strips only, no clustering
+//     -t <abs> <rel>     float tolerance (1e-3 1e-5)
+//     -m <n>             number of differences to print (20)
+//     -q                 the candidate uses int16 fixed point apv processing
+//                        (GEMAPV::SetIntegerProcessing), compare it to the
+//                        float reference with -t 1 0
+//
+// exit code is 0 if the outputs agree, 2 if they differ
+
+typedef std::function<void(GEMGoldenEvent &)> GoldenCallback;
+
+////////////////////////////////////////////////////////////////
+// reference pipeline, everything in one thread, apv by apv
+
+static int run_reference(const std::string &config, const std::string &input,
+        const std::string &ped_file, const std::string &cm_file, int nevents,
+        bool cluster, GoldenCallback callback)
+{
+    GEMSystem gem_sys(config);
+    gem_sys.SetReplayMode(true);
+    // the reference is always the float processing
+    gem_sys.SetUnivIntegerProcessing(false);
+    gem_sys.ReadPedestalFile(ped_file, cm_file);
+
+    EvioFileReader reader(input);
+    EventParser parser;
+    MPDSSPRawEventDecoder ssp_decoder;
+    MPDVMERawEventDecoder vme_decoder;
+    parser.RegisterRawDecoder(static_cast<int>(Bank_TagID::MPD_SSP), &ssp_decoder);
+    parser.RegisterRawDecoder(static_cast<int>(Bank_TagID::MPD_VME), &vme_decoder);
+
+    EventData event;
+    GEMGoldenEvent golden;
+    const uint32_t *buf;
+    uint32_t buflen;
+    int count = 0;
+    while((nevents <= 0 || count < nevents) && reader.ReadNoCopy(&buf, &buflen) == S_SUCCESS)
+    {
+        parser.ParseEvent(buf, buflen);
+
+        event.Clear();
+        event.event_number = ++count;
+        auto feed = [&](const std::unordered_map<APVAddress, std::vector<int>> &apv_data,
+                const std::unordered_map<APVAddress, uint32_t> &apv_flags)
+        {
+            for(auto &i: apv_data)
+                if(gem_sys.GetAPV(i.first) != nullptr)
+                    gem_sys.FillRawDataMPD(i.first, i.second, apv_flags.at(i.first), event);
+        };
+        feed(ssp_decoder.GetAPV(), ssp_decoder.GetAPVDataFlags());
+        feed(vme_decoder.GetAPV(), vme_decoder.GetAPVDataFlags());
+
+        golden.Clear();
+        golden.CollectStrips(event);
+        if(cluster) {
+            gem_sys.Reconstruct(event);
+            golden.CollectClusters(&gem_sys);
+        }
+        golden.Sort();
+        callback(golden);
+    }
+
+    return count;
+}
+
+////////////////////////////////////////////////////////////////
+// candidate pipeline, GEMDataHandler::Replay, the callback is
+// called from the event process thread, events are in order
+
+static bool candidate_integer = false;
+
+static int run_candidate(const std::string &config, const std::string &input,
+        const std::string &ped_file, const std::string &cm_file, int nevents,
+        bool cluster, GoldenCallback callback)
+{
+    GEMSystem gem_sys(config);
+    gem_sys.SetReplayMode(true);
+    if(candidate_integer)
+        gem_sys.SetUnivIntegerProcessing(true);
+
+    GEMDataHandler handler;
+    handler.SetGEMSystem(&gem_sys);
+    handler.SetReplayMode(true);
+    if(cluster)
+        handler.TurnOnClustering();
+    else
+        handler.TurnOffClustering();
+
+    int count = 0;
+    GEMGoldenEvent golden;
+    handler.SetEventCallback([&](const EventData &ev)
+    {
+        if(nevents > 0 && count >= nevents) {
+            handler.Cancel();
+            return;
+        }
+        count++;
+        golden.Clear();
+        golden.CollectStrips(ev);
+        if(cluster)
+            golden.CollectClusters(&gem_sys);
+        golden.Sort();
+        callback(golden);
+    });
+
+    handler.Replay(input, 0, -1, ped_file, cm_file);
+
+    return count;
+}
+
+static void print_usage(const char* exe)
+{
+    std::cout<<"usage: "<<std::endl
+             <<"    "<<exe<<" -i <evio> [-w <golden> | -g <golden>] [options]"<<std::endl
+             <<"    "<<exe<<" -A <golden> -B <golden> [options]"<<std::endl
+             <<"options:"<<std::endl
+             <<"    -c <config>        gem configuration (config/gem.conf)"<<std::endl
+             <<"    -n <events>        number of events, 0 for all (1000)"<<std::endl
+             <<"    -p <ped> <cm>      pedestal and common mode range files"<<std::endl
+             <<"    -r                 -w/-g use the reference pipeline"<<std::endl
+             <<"    -s                 strips only, no clustering"<<std::endl
+             <<"    -t <abs> <rel>     float tolerance (1e-3 1e-5)"<<std::endl
+             <<"    -m <n>             number of differences to print (20)"<<std::endl
+             <<"    -q                 candidate uses int16 fixed point apv processing"<<std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string config = "config/gem.conf", input, ped_file, cm_file;
+    std::string golden_write, golden_read, file_a, file_b;
+    int nevents = 1000, max_reports = 20;
+    float abs_tol = 1e-3, rel_tol = 1e-5;
+    bool use_reference = false, cluster = true;
+
+    for(int i=1; i<argc; i++)
+    {
+        bool has_arg = i + 1 < argc;
+        if(std::strcmp(argv[i], "-i") == 0 && has_arg)
+            input = argv[++i];
+        else if(std::strcmp(argv[i], "-w") == 0 && has_arg)
+            golden_write = argv[++i];
+        else if(std::strcmp(argv[i], "-g") == 0 && has_arg)
+            golden_read = argv[++i];
+        else if(std::strcmp(argv[i], "-A") == 0 && has_arg)
+            file_a = argv[++i];
+        else if(std::strcmp(argv[i], "-B") == 0 && has_arg)
+            file_b = argv[++i];
+        else if(std::strcmp(argv[i], "-c") == 0 && has_arg)
+            config = argv[++i];
+        else if(std::strcmp(argv[i], "-n") == 0 && has_arg)
+            nevents = std::atoi(argv[++i]);
+        else if(std::strcmp(argv[i], "-p") == 0 && i + 2 < argc) {
+            ped_file = argv[++i];
+            cm_file = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "-r") == 0)
+            use_reference = true;
+        else if(std::strcmp(argv[i], "-s") == 0)
+            cluster = false;
+        else if(std::strcmp(argv[i], "-t") == 0 && i + 2 < argc) {
+            abs_tol = std::atof(argv[++i]);
+            rel_tol = std::atof(argv[++i]);
+        }
+        else if(std::strcmp(argv[i], "-m") == 0 && has_arg)
+            max_reports = std::atoi(argv[++i]);
+        else if(std::strcmp(argv[i], "-q") == 0)
+            candidate_integer = true;
+        else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    GEMGoldenCompare compare(abs_tol, rel_tol, max_reports > 0 ? max_reports : 0);
+
+    // golden file against golden file
+    if(!file_a.empty() || !file_b.empty()) {
+        GEMGoldenFile a, b;
+        if(file_a.empty() || file_b.empty() || !a.OpenRead(file_a) || !b.OpenRead(file_b)) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        GEMGoldenEvent ev_a, ev_b;
+        bool has_a = a.Read(ev_a), has_b = b.Read(ev_b);
+        for(; has_a && has_b; has_a = a.Read(ev_a), has_b = b.Read(ev_b))
+            compare.Compare(ev_a, ev_b);
+        for(; has_a; has_a = a.Read(ev_a))
+            compare.AddMissingEvent(ev_a, true);
+        for(; has_b; has_b = b.Read(ev_b))
+            compare.AddMissingEvent(ev_b, false);
+
+        compare.Print(std::cout);
+        return compare.Passed() ? 0 : 2;
+    }
+
+    if(input.empty()) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if(ped_file.empty()) {
+        ConfigObject conf;
+        if(!conf.ReadConfigFile(config)) {
+            std::cout<<"cannot read configuration file: "<<config<<std::endl;
+            return 1;
+        }
+        ped_file = conf.Value<std::string>("GEM Pedestal");
+        cm_file = conf.Value<std::string>("GEM Common Mode");
+    }
+
+    auto run = use_reference ? run_reference : run_candidate;
+
+    // save golden output
+    if(!golden_write.empty()) {
+        GEMGoldenFile out;
+        if(!out.OpenWrite(golden_write))
+            return 1;
+        int count = run(config, input, ped_file, cm_file, nevents, cluster,
+                [&](GEMGoldenEvent &ev) {out.Write(ev);});
+        std::cout<<"saved "<<count<<" events to golden file: "<<golden_write<<std::endl;
+        return count > 0 ? 0 : 1;
+    }
+
+    // compare to golden output
+    if(!golden_read.empty()) {
+        GEMGoldenFile in;
+        if(!in.OpenRead(golden_read))
+            return 1;
+        GEMGoldenEvent ref;
+        int count = run(config, input, ped_file, cm_file, nevents, cluster,
+                [&](GEMGoldenEvent &ev)
+                {
+                    if(in.Read(ref))
+                        compare.Compare(ref, ev);
+                    else
+                        compare.AddMissingEvent(ev, false);
+                });
+        if(nevents <= 0 || count < nevents) {
+            while(in.Read(ref))
+                compare.AddMissingEvent(ref, true);
+        }
+
+        compare.Print(std::cout);
+        return compare.Passed() ? 0 : 2;
+    }
+
+    // reference and candidate in the same run, reference events are kept
+    // in memory, limit the events with -n
+    std::vector<GEMGoldenEvent> reference;
+    run_reference(config, input, ped_file, cm_file, nevents, cluster,
+            [&](GEMGoldenEvent &ev) {reference.push_back(ev);});
+
+    size_t index = 0;
+    run_candidate(config, input, ped_file, cm_file, nevents, cluster,
+            [&](GEMGoldenEvent &ev)
+            {
+                if(index < reference.size())
+                    compare.Compare(reference[index++], ev);
+                else
+                    compare.AddMissingEvent(ev, false);
+            });
+    for(; index < reference.size(); index++)
+        compare.AddMissingEvent(reference[index], true);
+
+    std::cout<<std::endl;
+    compare.Print(std::cout);
+    return compare.Passed() ? 0 : 2;
+}
@@ -0,0 +1,334 @@
+#include "GEMSystem.h"
+#include "GEMDetector.h"
+#include "GEMPlane.h"
+#include "GEMAPV.h"
+#include "GEMCluster.h"
+#include "GEMRootHitTree.h"
+#include "GEMEventGenerator.h"
+#include "EvioFileReader.h"
+#include "EventParser.h"
+#include "MPDVMERawEventDecoder.h"
+#include "MPDSSPRawEventDecoder.h"
+#include "RolStruct.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+
+////////////////////////////////////////////////////////////////
+// Benchmark every stage of the GEM replay chain separately:
+//     EventParser::ParseEvent (bank walking only)
+//     MPDSSPRawEventDecoder / MPDVMERawEventDecoder
+//     GEMAPV::FillRawDataMPD + ZeroSuppression (CommonModeCorrection)
+//     GEMAPV::CollectZeroSupHits
+//     GEMSystem::ChooseEvent
+//     GEMCluster::FormClusters (all planes)
+//     GEMCluster::CartesianReconstruct (all detectors)
+//     GEMRootHitTree::Fill
+//
+// input is either synthetic (GEMEventGenerator, with the mapping of the
+// configuration and its true pedestal) or a recorded evio file (with the
+// pedestal of the configuration), reading/generating is not timed
+//
+// usage:
+//     stage_benchmark [options]
+//     -c <config>        gem configuration (config/gem.conf)
+//     -i <evio file>     recorded input, synthetic if not given
+//     -n <events>        number of events (1000)
+//     -r <ssp|vme>       synthetic readout format (ssp)
+//     -a <apvs>          synthetic, use the first n apvs of the map (0: all)
+//     -o <occupancy>     synthetic, average clusters per apv per event (0.05)
+//     -p <ped> <cm>      pedestal and common mode range files
+//     -w <root file>     hit tree output (stage_benchmark.root)
+//     -q                 int16 fixed point apv processing (see
+//                        GEMAPV::SetIntegerProcessing), float if not given
+
+////////////////////////////////////////////////////////////////
+// record the mpd data banks found by the event parser, so the
+// parser and the decoders can be timed separately
+
+class BankCapture : public AbstractRawDecoder
+{
+public:
+    struct Bank
+    {
+        const uint32_t *buf;
+        uint32_t len;
+        std::vector<int> tags;
+    };
+
+    void Decode(const uint32_t *pBuf, uint32_t fBufLen, std::vector<int> &vTagTrack)
+    {
+        if(nbanks >= banks.size())
+            banks.resize(nbanks + 1);
+        Bank &b = banks[nbanks++];
+        b.buf = pBuf;
+        b.len = fBufLen;
+        b.tags = vTagTrack;
+    }
+
+    void Clear() {nbanks = 0;}
+
+    std::vector<Bank> banks;
+    size_t nbanks = 0;
+};
+
+////////////////////////////////////////////////////////////////
+// accumulated time of one stage
+
+struct Stage
+{
+    std::string name;
+    double ns = 0;
+    bool used = false;
+
+    std::chrono::steady_clock::time_point begin;
+    void Start() {begin = std::chrono::steady_clock::now();}
+    void Stop()
+    {
+        ns += std::chrono::duration<double, std::nano>(
+                std::chrono::steady_clock::now() - begin).count();
+        used = true;
+    }
+};
+
+enum StageIndex
+{
+    Parse, DecodeSSP, DecodeVME, ZeroSup, CollectHits, Choose, FormClusters,
+    Cartesian, HitTree, NStages
+};
+
+static void print_usage(const char* exe)
+{
+    std::cout<<"usage: "<<std::endl
+             <<"    "<<exe<<" [-c config] [-i evio] [-n events] [-r ssp|vme] [-a apvs]"
+             <<" [-o occupancy] [-p ped cm] [-w root file] [-q]"<<std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string config = "config/gem.conf", input, ped_file, cm_file;
+    std::string output = "stage_benchmark.root";
+    int nevents = 1000, napvs = 0;
+    double occupancy = 0.05;
+    MPDReadout readout = MPDReadout::SSP;
+    bool integer_processing = false;
+
+    for(int i=1; i<argc; i++)
+    {
+        bool has_arg = i + 1 < argc;
+        if(std::strcmp(argv[i], "-c") == 0 && has_arg)
+            config = argv[++i];
+        else if(std::strcmp(argv[i], "-i") == 0 && has_arg)
+            input = argv[++i];
+        else if(std::strcmp(argv[i], "-n") == 0 && has_arg)
+            nevents = std::atoi(argv[++i]);
+        else if(std::strcmp(argv[i], "-r") == 0 && has_arg)
+            readout = (std::strcmp(argv[++i], "vme") == 0) ? MPDReadout::VME : MPDReadout::SSP;
+        else if(std::strcmp(argv[i], "-a") == 0 && has_arg)
+            napvs = std::atoi(argv[++i]);
+        else if(std::strcmp(argv[i], "-o") == 0 && has_arg)
+            occupancy = std::atof(argv[++i]);
+        else if(std::strcmp(argv[i], "-p") == 0 && i + 2 < argc) {
+            ped_file = argv[++i];
+            cm_file = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "-w") == 0 && has_arg)
+            output = argv[++i];
+        else if(std::strcmp(argv[i], "-q") == 0)
+            integer_processing = true;
+        else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    GEMSystem gem_sys(config);
+    gem_sys.SetReplayMode(true);
+    if(integer_processing)
+        gem_sys.SetUnivIntegerProcessing(true);
+    GEMCluster *cluster_method = gem_sys.GetClusterMethod();
+
+    // input
+    GEMEventGenerator *generator = nullptr;
+    EvioFileReader *reader = nullptr;
+    if(input.empty()) {
+        generator = new GEMEventGenerator(gem_sys.Value<std::string>("GEM Map"));
+        generator -> SetReadout(readout);
+        generator -> SetTimeSamples(gem_sys.Value<int>("Default Time Samples", 6, false));
+        generator -> SetAPVCount(napvs);
+        generator -> SetOccupancy(occupancy);
+        if(ped_file.empty()) {
+            ped_file = output + ".ped";
+            cm_file = output + ".cm";
+            generator -> WritePedestal(ped_file);
+            generator -> WriteCommonModeRange(cm_file);
+        }
+        std::cout<<"synthetic input: "<<generator -> GetAPVCount()<<" apvs, "
+                 <<(readout == MPDReadout::SSP ? "ssp" : "vme")<<" readout, occupancy "
+                 <<occupancy<<std::endl;
+    }
+    else {
+        reader = new EvioFileReader(input);
+        if(ped_file.empty()) {
+            ped_file = gem_sys.Value<std::string>("GEM Pedestal");
+            cm_file = gem_sys.Value<std::string>("GEM Common Mode");
+        }
+    }
+    gem_sys.ReadPedestalFile(ped_file, cm_file);
+
+    // decoding
+    EventParser parser;
+    BankCapture ssp_banks, vme_banks;
+    parser.RegisterRawDecoder(static_cast<int>(Bank_TagID::MPD_SSP), &ssp_banks);
+    parser.RegisterRawDecoder(static_cast<int>(Bank_TagID::MPD_VME), &vme_banks);
+    MPDSSPRawEventDecoder ssp_decoder;
+    MPDVMERawEventDecoder vme_decoder;
+
+    GEMRootHitTree hit_tree(output.c_str());
+    std::vector<GEMDetector*> detectors = gem_sys.GetDetectorList();
+
+    Stage stages[NStages];
+    stages[Parse].name = "EventParser::ParseEvent";
+    stages[DecodeSSP].name = "MPDSSPRawEventDecoder::Decode";
+    stages[DecodeVME].name = "MPDVMERawEventDecoder::Decode";
+    stages[ZeroSup].name = "GEMAPV::ZeroSuppression";
+    stages[CollectHits].name = "GEMAPV::CollectZeroSupHits";
+    stages[Choose].name = "GEMSystem::ChooseEvent";
+    stages[FormClusters].name = "GEMCluster::FormClusters";
+    stages[Cartesian].name = "GEMCluster::CartesianReconstruct";
+    stages[HitTree].name = "GEMRootHitTree::Fill";
+
+    EventData event;
+    long napv_total = 0, nhits_total = 0;
+    int count = 0;
+    for(; count < nevents; count++)
+    {
+        const uint32_t *buf = nullptr;
+        uint32_t buflen = 0;
+        if(generator) {
+            const std::vector<uint32_t> &ev = generator -> GenerateEvent(count + 1);
+            buf = ev.data();
+            buflen = static_cast<uint32_t>(ev.size());
+        }
+        else if(reader -> ReadNoCopy(&buf, &buflen) != S_SUCCESS) {
+            break;
+        }
+
+        stages[Parse].Start();
+        parser.ParseEvent(buf, buflen);
+        stages[Parse].Stop();
+
+        // decoders
+        auto decode = [](BankCapture &banks, AbstractRawDecoder &decoder, Stage &stage)
+        {
+            if(banks.nbanks == 0)
+                return;
+            stage.Start();
+            decoder.Clear();
+            for(size_t i=0; i<banks.nbanks; i++)
+                decoder.Decode(banks.banks[i].buf, banks.banks[i].len, banks.banks[i].tags);
+            stage.Stop();
+        };
+        decode(ssp_banks, ssp_decoder, stages[DecodeSSP]);
+        decode(vme_banks, vme_decoder, stages[DecodeVME]);
+
+        const auto &apv_data = (vme_banks.nbanks > 0) ? vme_decoder.GetAPV() : ssp_decoder.GetAPV();
+        const auto &apv_flags = (vme_banks.nbanks > 0) ? vme_decoder.GetAPVDataFlags()
+            : ssp_decoder.GetAPVDataFlags();
+
+        // zero suppression
+        std::vector<GEMAPV*> apvs;
+        std::vector<const std::pair<const APVAddress, std::vector<int>>*> data;
+        for(auto &i: apv_data) {
+            GEMAPV *apv = gem_sys.GetAPV(i.first);
+            if(apv) {
+                apvs.push_back(apv);
+                data.push_back(&i);
+            }
+        }
+        napv_total += apvs.size();
+
+        stages[ZeroSup].Start();
+        for(size_t i=0; i<apvs.size(); i++) {
+            apvs[i] -> FillRawDataMPD(data[i] -> second, apv_flags.at(data[i] -> first));
+            apvs[i] -> ZeroSuppression();
+        }
+        stages[ZeroSup].Stop();
+
+        event.Clear();
+        event.event_number = count + 1;
+        stages[CollectHits].Start();
+        for(auto &apv: apvs)
+            apv -> CollectZeroSupHits(event.get_gem_data());
+        stages[CollectHits].Stop();
+        nhits_total += event.gem_data.size();
+
+        // reconstruction
+        stages[Choose].Start();
+        gem_sys.ChooseEvent(event);
+        stages[Choose].Stop();
+
+        stages[FormClusters].Start();
+        for(auto &det: detectors)
+            for(auto &plane: det -> GetPlaneList())
+                if(plane)
+                    plane -> FormClusters(cluster_method);
+        stages[FormClusters].Stop();
+
+        stages[Cartesian].Start();
+        for(auto &det: detectors)
+        {
+            GEMPlane *plane_x = det -> GetPlane(GEMPlane::Plane_X);
+            GEMPlane *plane_y = det -> GetPlane(GEMPlane::Plane_Y);
+            if(!plane_x || !plane_y)
+                continue;
+            cluster_method -> CartesianReconstruct(plane_x -> GetStripClusters(),
+                    plane_y -> GetStripClusters(), det -> GetHits(),
+                    det -> GetDetID(), det -> GetResolution());
+        }
+        stages[Cartesian].Stop();
+
+        stages[HitTree].Start();
+        hit_tree.Fill(&gem_sys, event);
+        stages[HitTree].Stop();
+    }
+    hit_tree.Write();
+
+    if(count == 0) {
+        std::cout<<"no event processed."<<std::endl;
+        return 1;
+    }
+
+    double total = 0;
+    std::cout<<std::endl<<count<<" events, "<<napv_total / count<<" apvs/event, "
+             <<static_cast<double>(nhits_total) / count<<" strip hits/event"<<std::endl;
+    std::cout<<std::left<<std::setw(36)<<"stage"
+             <<std::right<<std::setw(14)<<"ms"<<std::setw(14)<<"events/s"
+             <<std::setw(14)<<"ns/apv"<<std::endl;
+    for(auto &s: stages)
+    {
+        if(!s.used)
+            continue;
+        total += s.ns;
+        std::cout<<std::left<<std::setw(36)<<s.name<<std::right<<std::fixed
+                 <<std::setprecision(2)<<std::setw(14)<<s.ns * 1e-6
+                 <<std::setprecision(0)<<std::setw(14)<<count / (s.ns * 1e-9)
+                 <<std::setprecision(1)<<std::setw(14)
+                 <<(napv_total > 0 ? s.ns / napv_total : 0.)<<std::endl;
+    }
+    std::cout<<std::left<<std::setw(36)<<"total"<<std::right
+             <<std::setprecision(2)<<std::setw(14)<<total * 1e-6
+             <<std::setprecision(0)<<std::setw(14)<<count / (total * 1e-9)
+             <<std::setprecision(1)<<std::setw(14)
+             <<(napv_total > 0 ? total / napv_total : 0.)<<std::endl;
+
+    delete generator;
+    delete reader;
+
+    return 0;
+}
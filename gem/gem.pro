@@ -57,6 +57,12 @@ OBJECTS_DIR = obj
 # deprecated API in order to know how to port your code away from it.
 DEFINES += QT_DEPRECATED_WARNINGS MULTI_THREAD
 
+# LZ4 compression for the native hit file format (optional)
+#DEFINES += USE_LZ4
+contains(DEFINES, USE_LZ4) {
+    LIBS += -llz4
+}
+
 # You can also make your code fail to compile if you use deprecated APIs.
 # In order to do so, uncomment the following line.
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
@@ -83,6 +89,12 @@ HEADERS += include/GEMStruct.h \
            include/APVStripMapping.h \
            include/GEMRootHitTree.h \
            include/GEMRootClusterTree.h \
+           include/GEMNativeHitFile.h \
+           include/GEMRecluster.h \
+           include/GEMEventGenerator.h \
+           include/GEMReplayStats.h \
+           include/GEMGoldenOutput.h \
+           include/GEMEventRing.h \
            include/PreAnalysis.h \
            include/hardcode.h \
 
@@ -104,6 +116,12 @@ SOURCES += src/GEMPedestal.cpp \
            src/GEMDataHandler.cpp \
            src/GEMRootHitTree.cpp \
            src/GEMRootClusterTree.cpp \
+           src/GEMNativeHitFile.cpp \
+           src/GEMRecluster.cpp \
+           src/GEMEventGenerator.cpp \
+           src/GEMReplayStats.cpp \
+           src/GEMGoldenOutput.cpp \
+           src/GEMEventRing.cpp \
            src/APVStripMapping.cpp \
            src/PreAnalysis.cpp \
            #src/main.cpp
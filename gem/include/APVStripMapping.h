@@ -262,6 +262,7 @@ public:
     void ExtractAPVAddress();
     void ExtractDetectorID();
     void ExtractLayerID();
+    void ExtractChannelAddress();
 
     // getters
     int GetPlaneID(const GEMChannelAddress &addr);
@@ -269,6 +270,9 @@ public:
     int GetModuleID(const GEMChannelAddress &addr);
     int GetAxis(const GEMChannelAddress &addr);
     int GetStrip(const std::string &detector_type, const GEMChannelAddress &addr);
+    // reverse of GetStrip(), chamber strip -> electronic channel address
+    bool GetChannelAddress(const int &prod_id, const int &axis, const int &strip,
+            GEMChannelAddress &addr) const;
     int GetTotalNumberOfDetectors();
     int GetTotalNumberOfLayers();
 
@@ -290,6 +294,9 @@ private:
 
     std::map<int, LayerInfo> layers;
 
+    // (prod_id, axis, chamber strip) -> electronic channel address
+    std::unordered_map<uint32_t, GEMChannelAddress> mStripChannel;
+
     bool map_loadded = false;
 
     ConfigObject txt_parser;
@@ -66,15 +66,17 @@ public:
     void FitPedestal();
     void FillRawDataSRS(const uint32_t *buf, const uint32_t &siz);
     void FillRawDataMPD(const std::vector<int> &buf, const uint32_t &flags=0);
-    void FillZeroSupData(const uint32_t &ch, const uint32_t &ts, const unsigned short &val);
+    void FillRawDataMPD(const int *buf, const uint32_t &siz, const uint32_t &flags=0);
+    void FillZeroSupData(const uint32_t &ch, const uint32_t &ts, const float &val);
     void FillZeroSupData(const uint32_t &ch, const std::vector<float> &vals);
+    void FillZeroSupData(const uint32_t &ch, const float *vals, const uint32_t &nts);
     void UpdatePedestal(std::vector<Pedestal> &ped);
     void UpdatePedestal(const Pedestal &ped, const uint32_t &index);
     void UpdatePedestal(const float &offset, const float &noise, const uint32_t &index);
     void UpdateCommonModeRange(const float &c_min, const float &c_max);
     void ZeroSuppression();
     void CommonModeCorrection(float *buf, const uint32_t &size);
-    void CollectZeroSupHits(std::vector<GEM_Strip_Data> &hits);
+    void CollectZeroSupHits(GEMStripHits &hits);
     void CollectZeroSupHits();
     void ResetHitPos();
     void PrintOutPedestal(std::ofstream &out);
@@ -104,6 +106,8 @@ public:
     float GetMaxCharge(const uint32_t &ch) const;
     float GetAveragedCharge(const uint32_t &ch) const;
     float GetIntegratedCharge(const uint32_t &ch) const;
+    // common mode of each time sample from the last ZeroSuppression()
+    const std::vector<float> &GetCommonMode() const {return commonMode;}
 
     // set parameters
     void SetMPD(GEMMPD *f, int adc_ch, bool force_set = false);
@@ -113,9 +117,14 @@ public:
     void SetTimeSample(const uint32_t &t);
     void SetOrientation(const int &o) {orient = o;}
     void SetCommonModeThresLevel(const float &t) {common_thres = t;}
-    void SetZeroSupThresLevel(const float &t) {zerosup_thres = t;}
+    void SetZeroSupThresLevel(const float &t) {zerosup_thres = t; fix_valid = false;}
     void SetCrossTalkThresLevel(const float &t) {crosstalk_thres = t;}
     void SetAddress(const APVAddress &apv_addr);
+    void SetIntegerProcessing(const bool &m);
+    bool GetIntegerProcessing() const {return integer_processing;}
+    // with integer processing, only the hits are in float after
+    // ZeroSuppression(), call it before reading the other channels
+    void ConvertCorrectedFrame();
 
 private:
     void initialize();
@@ -123,6 +132,19 @@ private:
     uint32_t getTimeSampleStart();
     void buildStripMap();
 
+    // kernels specialized on the number of time samples, NTS = 0 is the
+    // generic one using time_samples, chosen by selectKernels()
+    void selectKernels();
+    template<uint32_t NTS> void fillPedHist();
+    template<uint32_t NTS> void findZeroSupHits();
+    template<uint32_t NTS> void collectZeroSupHits(GEMStripHits &hits);
+    template<uint32_t NTS> void findZeroSupHitsFix();
+
+    // integer processing, see SetIntegerProcessing()
+    void updateFixedPoint();
+    void convertFixFrame();
+    void commonModeCorrectionFix(int16_t *buf);
+
 private:
     GEMMPD *mpd;
     GEMPlane *plane;
@@ -146,6 +168,8 @@ private:
     float common_mode_range_min = 0;     // common mode range loaded from file
     float common_mode_range_max = 5000;  // and used for offline analysis
     std::vector<float> commonModeDist;
+    std::vector<float> commonMode;     // last event, for online monitoring
+    float lastCommonMode = 0;
     StripNb strip_map[APV_STRIP_SIZE];
     bool hit_pos[APV_STRIP_SIZE];
 
@@ -160,6 +184,31 @@ private:
     // flags: lower 6-bit in effect. bit(6)=1: common mode subtracted
     //                               bit(5)=1: build all strips (zero suppression is disabled)
     uint32_t raw_data_flags = 0;
+
+    // what ClearData()/ResetPedHist() need to reset, so clearing an
+    // untouched apv costs nothing, see ClearData()
+    bool data_dirty = true;         // data filled since the last clear
+    bool data_full_dirty = true;    // not only zero suppressed hits filled
+    bool ped_dirty = true;          // pedestal data filled
+
+    // kernels for the current time samples, see selectKernels()
+    void (GEMAPV::*fill_ped_kernel)() = nullptr;
+    void (GEMAPV::*find_hits_kernel)() = nullptr;
+    void (GEMAPV::*collect_hits_kernel)(GEMStripHits &) = nullptr;
+    void (GEMAPV::*find_hits_fix_kernel)() = nullptr;
+
+    // integer processing, the mpd frame is kept in int16 fixed point and
+    // only the hits are converted to float, see SetIntegerProcessing()
+    bool integer_processing = false;
+    bool fix_frame = false;             // raw_fix holds a raw frame not yet processed
+    bool fix_corrected = false;         // raw_fix holds the corrected frame, only hits in float
+    bool fix_valid = false;             // fixed point constants are up to date
+    std::vector<int16_t> raw_fix;
+    int32_t ped_offset_fix[APV_STRIP_SIZE];
+    int32_t cm_thres_fix[APV_STRIP_SIZE];
+    int32_t zs_thres_fix[APV_STRIP_SIZE];
+    int32_t cm_min_fix = 0;
+    int32_t cm_max_fix = 0;
 };
 
 #endif
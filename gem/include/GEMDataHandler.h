@@ -3,18 +3,42 @@
 
 #include <string>
 #include <vector>
-#include <deque>
 #include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include "GEMStruct.h"
 #include "EventParser.h"
 #include "EvioFileReader.h"
 #include "GEMAPV.h"
+#include "GEMReplayStats.h"
+#include "GEMEventRing.h"
 
 class GEMSystem;
 class GEMRootHitTree;
 class GEMRootClusterTree;
+class GEMNativeHitWriter;
 class MPDVMERawEventDecoder;
 class MPDSSPRawEventDecoder;
+class AbstractRawDecoder;
+namespace fdec { class Fadc250Decoder; }
+
+////////////////////////////////////////////////////////////////////////////////
+// replay progress, reported through the progress callback
+
+struct ReplayProgress
+{
+    int events = 0;           // events processed in this replay
+    int split = -1;           // current file split, -1 if not splitted
+    int split_start = 0;
+    int split_end = -1;
+    double elapsed = 0.;      // seconds
+    double rate = 0.;         // events per second
+    double fraction = 0.;     // estimated fraction done [0, 1]
+    double eta = -1.;         // estimated seconds left, < 0 if unknown
+    bool finished = false;
+    bool cancelled = false;
+};
 
 class GEMDataHandler
 {
@@ -43,6 +67,10 @@ public:
             int split_end = -1, bool verbose = false);
     // read from single evio
     int ReadFromEvio(const std::string &path, int split=-1, bool verbose = false);
+    // read from a zero suppressed skim (native hit file)
+    int ReadFromSkim(const std::string &path);
+    static bool IsSkimFile(const std::string &path);
+    static std::string GetSplitFileName(const std::string &path, int split);
     // interface member
     void Replay(const std::string &r_path, int split_start = 0, int split_end = -1,
             const std::string &pedestal_input_file = "",
@@ -63,10 +91,15 @@ public:
     void FeedDataMPD(const APVAddress &addr, const std::vector<int> &raw_data, const uint32_t &flags);
     void FeedData(const std::vector<GEMZeroSupData> &gemData);
 
-    // event storage
-    unsigned int GetEventCount() const {return event_data.size();}
+    // event storage, online and pedestal modes keep the latest events in a
+    // ring, the oldest event is overwritten when it is full
+    // if no capacity is set, SetMode() sizes the ring for the working mode:
+    // online mode keeps the last event, pedestal mode GEM_EVENT_RING_CAPACITY
+    unsigned int GetEventCount() const {return event_data.Size();}
     const EventData &GetEvent(const unsigned int &index) const;
-    const std::deque<EventData> &GetEventData() const {return event_data;}
+    const GEMEventRing &GetEventData() const {return event_data;}
+    void SetEventBufferCapacity(size_t n) {fEventBufferCapacity = n; if(n > 0) event_data.SetCapacity(n);}
+    size_t GetEventBufferCapacity() const {return event_data.GetCapacity();}
 
     // analysis tools
     int FindEvent(int event_number) const;
@@ -76,15 +109,56 @@ public:
     void SetMode();
     void SetPedestalMode(bool m){pedestalMode = m; replayMode = !m; onlineMode = !m;}
     void SetReplayMode(bool m){replayMode = m; pedestalMode = !m; onlineMode = !m;}
-    void SetOnlineMode(bool m){onlineMode = m; pedestalMode = !m; onlineMode = !m;}
+    void SetOnlineMode(bool m){onlineMode = m; pedestalMode = !m; replayMode = !m;}
     void TurnOffClustering(){bReplayCluster = false;}
     void TurnOnClustering(){bReplayCluster = true;}
+    // write hits to the columnar native format instead of root tree,
+    // the output file can also be replayed again as a zero suppressed skim
+    void SetNativeHitOutput(bool m, bool compress = false)
+    {bNativeHitOutput = m; bNativeHitCompress = compress;}
+
+    // decode fadc250 banks in the same pass as the gem data, they are saved
+    // to EventData::fadc_data, used at next file
+    void SetFadcDecoding(bool m) {bFadcDecoding = m;}
+    // register another raw decoder to the same event parser, used at next file
+    // the decoder is owned by the caller
+    void RegisterRawDecoder(int tag, AbstractRawDecoder *decoder);
+    // called for every event with the combined event record (gem + fadc),
+    // from the event process thread, before the event is saved or cleared
+    // in cluster replay, the clusters of this event are already reconstructed
+    // in the gem system when it is called
+    void SetEventCallback(std::function<void(const EventData &)> f)
+    {event_callback = f;}
+
+    // progress report, called from the replay thread every n events
+    void SetProgressCallback(std::function<void(const ReplayProgress &)> f,
+            int every_n_events = 1000)
+    {progress_callback = f; fProgressInterval = every_n_events > 0 ? every_n_events : 1;}
+    // stop the running replay after the current event, output is still saved
+    // can be called from any thread, it stays in effect until ResetCancel(),
+    // so a cancel that arrives before Replay() starts is not lost
+    void Cancel() {bCancel = true;}
+    void ResetCancel() {bCancel = false;}
+    bool IsCancelled() const {return bCancel;}
+
+    // per-stage timing and throughput, always collected during Replay()
+    // the summary is written to summary_path at the end of replay (json if
+    // it ends with .json, csv otherwise), samples are streamed to
+    // stream_path (csv) every interval while the replay runs
+    // empty paths disable the outputs
+    void SetStatsOutput(const std::string &summary_path, const std::string &stream_path = "")
+    {fStatsOutput = summary_path; fStats.SetStreamFile(stream_path);}
+    void SetStatsSampleInterval(double seconds) {fStats.SetSampleInterval(seconds);}
+    const GEMReplayStats &GetReplayStats() const {return fStats;}
 
     // helpers
     std::string ParseOutputFileName(const std::string &input_file_name, const char* prefix="Rootfiles/hit");
 
 private:
     void waitEventProcess();
+    void registerRawDecoders();
+    void initProgress(const std::string &path, int split_start, int split_end);
+    void reportProgress(bool finished = false);
 
 private:
     EvioFileReader *evio_reader;
@@ -98,9 +172,14 @@ private:
     // decoders
     MPDVMERawEventDecoder *mpd_vme_decoder = nullptr;
     MPDSSPRawEventDecoder *mpd_ssp_decoder = nullptr;
+    fdec::Fadc250Decoder *fadc_decoder = nullptr;
+    bool bFadcDecoding = false;
+    std::vector<std::pair<int, AbstractRawDecoder*>> vRawDecoders; // registered by user
+    std::function<void(const EventData &)> event_callback;
 
     // data related
-    std::deque<EventData> event_data;
+    GEMEventRing event_data;
+    size_t fEventBufferCapacity = 0; // 0: sized by working mode
     EventData *new_event;
     EventData *proc_event;
 
@@ -113,10 +192,30 @@ private:
     std::string replay_hit_output_file = "";
     int fEventNumber = 0;
 
+    // replay data to native (columnar) hit file
+    GEMNativeHitWriter *native_hit_writer = nullptr;
+    bool bNativeHitOutput = false;
+    bool bNativeHitCompress = false;
+
     // replay data to root cluster tree
     GEMRootClusterTree *root_cluster_tree = nullptr;
     std::string replay_cluster_output_file = "";
     bool bReplayCluster = false;
+
+    // progress and cancel
+    std::function<void(const ReplayProgress &)> progress_callback;
+    int fProgressInterval = 1000;
+    std::atomic<bool> bCancel{false};
+    ReplayProgress fProgress;
+    std::chrono::steady_clock::time_point fReplayStart;
+    uint64_t fTotalBytes = 0;   // all input splits
+    uint64_t fBytesRead = 0;
+    uint64_t fTotalEvents = 0;  // if known in advance (skim, pedestal)
+
+    // stage timing
+    GEMReplayStats fStats;
+    std::string fStatsOutput;
+    std::atomic<bool> bProcessBusy{false}; // event process thread running
 };
 
 #endif
@@ -0,0 +1,184 @@
+#ifndef GEM_EVENT_GENERATOR_H
+#define GEM_EVENT_GENERATOR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <random>
+
+#include "MPDDataStruct.h"
+#include "APVStripMapping.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Synthetic MPD raw data generator
+//
+// It generates evio events for the APVs listed in a GEM mapping file, in the
+// word format of either MPDVMERawEventDecoder (bank tag 10) or
+// MPDSSPRawEventDecoder (bank tag 3561), so the whole decoding/replay chain
+// can be run and benchmarked without detector data.
+//
+// event structure (the same as CODA):
+//     event bank (tag 1, bank of banks)
+//         roc bank (tag = crate id, bank of banks)
+//             mpd data bank (tag 10 or 3561, uint32)
+//
+// every strip is
+//     adc = common mode (apv, time sample) + strip offset + noise + signal
+// the strip offsets and noise are fixed at construction (a function of the
+// seed), they can be saved as a pedestal file (gem_ped.dat format), together
+// with a common mode range file, so the generated data can be replayed with
+// the true pedestal
+//
+// signal clusters are injected into adjacent detector strips of one APV, with
+// an APV25 (CR-RC) pulse shape in time, the injected clusters and strips of
+// every event are kept as truth
+//
+// all random numbers are derived from the raw std::mt19937 output (which is
+// fixed by the standard), so a seed gives the same data with any compiler and
+// standard library
+
+enum class MPDReadout
+{
+    VME,
+    SSP,
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// truth of one injected cluster
+
+struct GEMTruthCluster
+{
+    int event;
+    APVAddress apv;
+    int layer_id, detector_id, dimension;
+    float center;       // strip number on the plane (Mapping::GetStrip convention)
+    int nstrips;
+    float amplitude;    // peak adc of the center strip
+    float peak_time;    // ns, relative to the first time sample
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// truth of one strip carrying an injected signal
+
+struct GEMTruthStrip
+{
+    int event;
+    APVAddress apv;
+    int ch;             // apv channel (decoded channel number)
+    int strip;          // strip number on the plane
+    int cluster;        // index in the truth clusters of this event
+    float max_adc;      // maximum noise free signal over time samples
+};
+
+class GEMEventGenerator
+{
+public:
+    GEMEventGenerator(const std::string &map_file, uint32_t seed = 1);
+
+    // settings, apv offsets and noise are regenerated by SetNoise() and
+    // SetAPVCount(), other settings only affect the following events
+    void SetReadout(MPDReadout r) {fReadout = r;}
+    // use the first n apvs of the mapping file, <= 0 for all
+    void SetAPVCount(int n);
+    // vme only, the ssp firmware always sends 6 time samples
+    void SetTimeSamples(int n) {fTimeSamples = n > 0 ? n : 1;}
+    // average number of clusters on one apv in one event
+    void SetOccupancy(double o) {fOccupancy = o > 0 ? o : 0;}
+    // average strip noise (adc), strips vary within +-20%
+    void SetNoise(double n);
+    // event by event common mode shift (sigma in adc)
+    void SetCommonModeShift(double s) {fCommonModeShift = s;}
+    // cluster amplitude is uniform in [min, max], width is the gaussian sigma in strips
+    void SetClusterAmplitude(double min, double max) {fAmpMin = min; fAmpMax = max;}
+    void SetClusterWidth(double sigma) {fClusterWidth = sigma > 0.1 ? sigma : 0.1;}
+    // ssp only, emulate the firmware online zero suppression: only strips with
+    // average adc above thres * noise are sent, with pedestal and common mode
+    // subtracted, flags have OnlineCommonModeSubtractionEnabled set
+    void SetOnlineZeroSuppression(bool m, double thres = 5.)
+    {bOnlineZeroSup = m; fZeroSupThres = thres;}
+
+    MPDReadout GetReadout() const {return fReadout;}
+    int GetTimeSamples() const;
+    size_t GetAPVCount() const {return vAPV.size();}
+    uint32_t GetAPVDataFlags() const;
+
+    // generate one event, the returned buffer is a complete evio event
+    const std::vector<uint32_t> &GenerateEvent(int event_number);
+    const std::vector<GEMTruthCluster> &GetTruthClusters() const {return vTruthCluster;}
+    const std::vector<GEMTruthStrip> &GetTruthStrips() const {return vTruthStrip;}
+
+    // generate nevents to an evio file, events_per_split > 0 writes splits
+    // path.0, path.1 ... (GEMDataHandler::GetSplitFileName), truth is saved
+    // to truth_path if not empty, return number of events written
+    int Generate(const std::string &path, int nevents, int events_per_split = 0,
+            const std::string &truth_path = "");
+
+    // true pedestal and common mode range of the generated data
+    bool WritePedestal(const std::string &path) const;
+    bool WriteCommonModeRange(const std::string &path) const;
+    void WriteTruthHeader(std::ofstream &out) const;
+    void WriteTruth(std::ofstream &out) const;
+
+private:
+    struct APVState
+    {
+        apv_strip_mapping::APVInfo info;
+        const int *strip_map = nullptr;     // apv channel -> strip on apv
+        int channel[APV_STRIP_SIZE];        // strip on apv -> apv channel
+        float offset[APV_STRIP_SIZE];
+        float noise[APV_STRIP_SIZE];
+        float common_mode;                  // base line of this apv
+    };
+
+    void loadMap(const std::string &path);
+    void initAPVs();
+    int planeStrip(const APVState &apv, int local) const;
+
+    void generateAPV(int event_number, const APVState &apv);
+
+    // evio encoding
+    size_t openBank(int tag, uint32_t type);
+    void closeBank(size_t pos);
+    void beginCrate(int event_number, int crate);
+    void endCrate(int crate, size_t begin);
+    void beginMPD(int event_number, int mpd);
+    void endMPD(int mpd, size_t begin);
+    void encodeAPV(const APVState &apv);
+
+    // random numbers
+    double uniform();
+    double gaus();
+    int poisson(double mean);
+
+private:
+    MPDReadout fReadout = MPDReadout::SSP;
+    int fTimeSamples = 6;
+    int fMaxAPVs = 0;
+    double fOccupancy = 0.05;
+    double fNoise = 10.;
+    double fCommonModeShift = 20.;
+    double fAmpMin = 200., fAmpMax = 1500.;
+    double fClusterWidth = 1.;
+    bool bOnlineZeroSup = false;
+    double fZeroSupThres = 5.;
+
+    std::mt19937 fGen;
+    uint32_t fSeed;
+    bool bHasSpare = false;
+    double fSpare = 0.;
+
+    std::vector<apv_strip_mapping::APVInfo> vMapAPV;
+    std::vector<std::string> vMapAPVType;
+    std::vector<APVState> vAPV;
+
+    // per event
+    std::vector<uint32_t> vEventBuf;
+    std::vector<float> vADC;          // [ts][ch] of the current apv
+    std::vector<float> vSignal;       // [ts][strip] of the current apv
+    std::vector<float> vCommonMode;   // [ts] of the current apv
+    std::vector<GEMTruthCluster> vTruthCluster;
+    std::vector<GEMTruthStrip> vTruthStrip;
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef GEM_EVENT_RING_H
+#define GEM_EVENT_RING_H
+
+#include <cstdint>
+#include <vector>
+#include "GEMStruct.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Fixed capacity ring of EventData slots, the oldest event is overwritten
+// when it is full, so the memory used to keep events is bounded
+//
+// an event is swapped into its slot, the caller gets back the buffers of
+// the overwritten (or empty) slot, so the slots are reused and nothing is
+// allocated for the event containers once the ring is filled
+//
+// not thread safe
+
+#define GEM_EVENT_RING_CAPACITY 1000
+
+class GEMEventRing
+{
+public:
+    GEMEventRing(size_t capacity = GEM_EVENT_RING_CAPACITY);
+
+    // the newest events are kept if the ring is shrunk, minimum 1
+    void SetCapacity(size_t n);
+    size_t GetCapacity() const {return vSlots.size();}
+    size_t Size() const {return fCount;}
+    bool Empty() const {return fCount == 0;}
+    bool Full() const {return fCount == vSlots.size();}
+    // number of events overwritten since the last Clear()
+    uint64_t GetOverwritten() const {return fOverwritten;}
+
+    // swap ev into the ring, ev gets the buffers of the slot it replaced
+    void Push(EventData &ev);
+    void PopFront();
+
+    // index 0 is the oldest event
+    const EventData &At(size_t i) const {return vSlots[(fHead + i) % vSlots.size()];}
+    const EventData &operator[](size_t i) const {return At(i);}
+    const EventData &Front() const {return At(0);}
+    const EventData &Back() const {return At(fCount - 1);}
+
+    // remove all events, slot memory is kept for reuse
+    void Clear();
+    // remove all events and release slot memory
+    void Release();
+
+private:
+    std::vector<EventData> vSlots;
+    size_t fHead = 0;
+    size_t fCount = 0;
+    uint64_t fOverwritten = 0;
+};
+
+#endif
@@ -0,0 +1,131 @@
+#ifndef GEM_GOLDEN_OUTPUT_H
+#define GEM_GOLDEN_OUTPUT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <ostream>
+
+#include "GEMStruct.h"
+
+class GEMSystem;
+
+////////////////////////////////////////////////////////////////////////////////
+// Golden output of the replay chain, used to check that an optimized replay
+// path gives the same results as the reference one
+//
+// one event keeps the zero suppressed strips (EventData::gem_data) and the
+// strip clusters of all planes (what GEMRootClusterTree saves), both sorted
+// in a canonical order, so the order the apvs/planes are processed in
+// (threads, data layout) does not matter
+//
+// the golden file is a text file, floats are written with 9 significant
+// digits (exact round trip), one event is
+//     E <event number> <number of strips> <number of clusters>
+//     S <crate> <mpd> <adc> <strip> <adc of every time sample>
+//     C <det id> <layer id> <plane> <position> <peak charge> <total charge>
+//       <cross talk> <number of strips> <strip>:<charge> ...
+
+struct GEMGoldenCluster
+{
+    int det_id = -1;
+    int layer_id = -1;
+    int plane = -1;
+    float position = 0.;
+    float peak_charge = 0.;
+    float total_charge = 0.;
+    bool cross_talk = false;
+    std::vector<int> strips;
+    std::vector<float> charges;
+};
+
+struct GEMGoldenEvent
+{
+    int event_number = 0;
+    std::vector<GEM_Strip_Data> strips;
+    std::vector<GEMGoldenCluster> clusters;
+
+    void Clear()
+    {
+        event_number = 0;
+        strips.clear();
+        clusters.clear();
+    }
+
+    // copy the zero suppressed strips of an event
+    void CollectStrips(const EventData &ev);
+    // copy the strip clusters of all planes, clusters must be reconstructed
+    void CollectClusters(GEMSystem *gem_sys);
+    // sort strips and clusters in the canonical order
+    void Sort();
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// golden file writer/reader
+
+class GEMGoldenFile
+{
+public:
+    GEMGoldenFile();
+    ~GEMGoldenFile();
+
+    bool OpenWrite(const std::string &path);
+    bool OpenRead(const std::string &path);
+    void Close();
+    bool IsOpen() const {return fOut.is_open() || fIn.is_open();}
+
+    void Write(const GEMGoldenEvent &ev);
+    // read the next event, false at the end of file or on a format error
+    bool Read(GEMGoldenEvent &ev);
+
+private:
+    std::ofstream fOut;
+    std::ifstream fIn;
+    std::string fPath;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// compare a candidate event to the reference one
+//
+// two floats are equal if |a - b| <= abs + rel * max(|a|, |b|)
+// strips are matched by address, clusters by (det, layer, plane) and then
+// position (within tolerance), every difference is counted, the first ones
+// are also kept as text
+
+class GEMGoldenCompare
+{
+public:
+    GEMGoldenCompare(float abs_tol = 1e-3, float rel_tol = 1e-5, size_t max_reports = 20);
+
+    void SetTolerance(float abs_tol, float rel_tol) {fAbsTol = abs_tol; fRelTol = rel_tol;}
+    void SetMaxReports(size_t n) {fMaxReports = n;}
+
+    // return number of differences in this event
+    size_t Compare(const GEMGoldenEvent &ref, const GEMGoldenEvent &cand);
+    // the reference or the candidate has more events
+    void AddMissingEvent(const GEMGoldenEvent &ev, bool in_reference);
+
+    bool Equal(float a, float b) const;
+    bool Passed() const {return fEventsDiffer == 0 && fEventsMissing == 0;}
+    size_t GetEventsCompared() const {return fEvents;}
+    size_t GetEventsDiffer() const {return fEventsDiffer;}
+    const std::vector<std::string> &GetReports() const {return vReports;}
+    void Print(std::ostream &os) const;
+
+private:
+    void report(const std::string &s);
+    size_t compareStrips(const GEMGoldenEvent &ref, const GEMGoldenEvent &cand);
+    size_t compareClusters(const GEMGoldenEvent &ref, const GEMGoldenEvent &cand);
+
+private:
+    float fAbsTol, fRelTol;
+    size_t fMaxReports;
+
+    size_t fEvents = 0, fEventsDiffer = 0, fEventsMissing = 0;
+    size_t fStrips = 0, fStripsMissing = 0, fStripsExtra = 0, fStripsDiffer = 0;
+    size_t fClusters = 0, fClustersMissing = 0, fClustersExtra = 0, fClustersDiffer = 0;
+    std::vector<std::string> vReports;
+};
+
+#endif
@@ -0,0 +1,262 @@
+#ifndef GEM_NATIVE_HIT_FILE_H
+#define GEM_NATIVE_HIT_FILE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <cstdio>
+
+#include "GEMStruct.h"
+
+class GEMSystem;
+
+////////////////////////////////////////////////////////////////////////////////
+// A simple chunked columnar binary format for replayed GEM hits.
+//
+// It carries the same information as the "GEMHit" tree written by
+// GEMRootHitTree, plus the electronic channel address of every hit, so that
+// the hits can be fed back into GEMSystem without a reverse mapping.
+//
+// file layout (little endian):
+//
+//     file header  : NativeHitFileHeader
+//     chunk 0      : NativeHitChunkHeader + columns
+//     chunk 1      : ...
+//     chunk index  : NativeHitChunkIndex[n_chunks]
+//     file trailer : NativeHitFileTrailer
+//
+// each chunk holds up to "events per chunk" events, its columns are stored
+// contiguously one after another (8-byte aligned), every column can be
+// LZ4 compressed individually (only if compiled with USE_LZ4)
+//
+//     evtID   : int32_t  [n_events]
+//     offset  : uint32_t [n_events + 1]  hit range of each event in this chunk
+//     addr    : uint32_t [n_hits]        PackChannelAddress (GEMStruct.h)
+//     plane   : int16_t  [n_hits]        layer id
+//     prod    : int16_t  [n_hits]        gem id (production id given by UVa)
+//     module  : int16_t  [n_hits]        gem location in layer
+//     axis    : int16_t  [n_hits]        x or y plane
+//     strip   : int16_t  [n_hits]        strip index on a single chamber
+//     adc     : int16_t  [n_hits * n_time_samples]   hit major
+
+#define GEM_NATIVE_HIT_MAGIC   0x54494847u  // "GHIT"
+#define GEM_NATIVE_CHUNK_MAGIC 0x4b4e4843u  // "CHNK"
+#define GEM_NATIVE_HIT_VERSION 1
+#define GEM_NATIVE_EVENTS_PER_CHUNK 4096
+
+namespace gem_native
+{
+    enum Column : uint32_t
+    {
+        EvtID = 0,
+        Offset,
+        Addr,
+        Plane,
+        Prod,
+        Module,
+        Axis,
+        Strip,
+        ADC,
+        NColumns,
+    };
+
+    enum Compression : uint32_t
+    {
+        None = 0,
+        LZ4 = 1,
+    };
+
+    struct NativeHitFileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t time_samples;
+        uint32_t compression;
+    };
+
+    struct ColumnInfo
+    {
+        uint32_t raw_size;    // size in bytes after decompression
+        uint32_t stored_size; // size in bytes on disk (without padding)
+    };
+
+    struct NativeHitChunkHeader
+    {
+        uint32_t magic;
+        uint32_t n_events;
+        uint32_t n_hits;
+        uint32_t reserved;
+        ColumnInfo column[NColumns];
+    };
+
+    struct NativeHitChunkIndex
+    {
+        uint64_t file_offset;
+        uint64_t first_event;  // index of the first event in this chunk
+    };
+
+    struct NativeHitFileTrailer
+    {
+        uint64_t index_offset;
+        uint64_t n_events;
+        uint32_t n_chunks;
+        uint32_t magic;
+    };
+
+    // a read-only view on contiguous memory, does not own the memory
+    template<typename T>
+    struct Span
+    {
+        const T *ptr = nullptr;
+        size_t len = 0;
+
+        Span() {}
+        Span(const T *p, size_t n) : ptr(p), len(n) {}
+
+        const T &operator[](size_t i) const {return ptr[i];}
+        const T *begin() const {return ptr;}
+        const T *end() const {return ptr + len;}
+        size_t size() const {return len;}
+        bool empty() const {return len == 0;}
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// one event in a native hit file, all spans point into the mapped file
+// (or into the decompressed chunk buffer for LZ4 files), they stay valid
+// until the reader moves to another chunk or gets destroyed
+
+struct NativeHitEvent
+{
+    int evtID = 0;
+    uint32_t nch = 0;
+    uint32_t time_samples = 0;
+
+    gem_native::Span<uint32_t> addr;
+    gem_native::Span<int16_t> plane;
+    gem_native::Span<int16_t> prod;
+    gem_native::Span<int16_t> module;
+    gem_native::Span<int16_t> axis;
+    gem_native::Span<int16_t> strip;
+    gem_native::Span<int16_t> adc;   // nch * time_samples
+
+    int16_t ADC(const uint32_t &hit, const uint32_t &ts) const
+    {
+        return adc[hit * time_samples + ts];
+    }
+
+    GEMChannelAddress Address(const uint32_t &hit) const
+    {
+        return UnpackChannelAddress(addr[hit]);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// writer, used the same way as GEMRootHitTree
+
+class GEMNativeHitWriter
+{
+public:
+    GEMNativeHitWriter(const char *path, uint32_t time_samples = 6,
+            bool compress = false, uint32_t events_per_chunk = GEM_NATIVE_EVENTS_PER_CHUNK);
+    ~GEMNativeHitWriter();
+
+    // same interface as GEMRootHitTree
+    void Write();
+    void Fill(GEMSystem *gem_sys, const EventData &ev);
+
+    // low level interface, fill one event from column arrays
+    // adc must hold nch * time_samples values, hit major
+    void FillEvent(int evtID, uint32_t nch, const uint32_t *addr,
+            const int16_t *plane, const int16_t *prod, const int16_t *module,
+            const int16_t *axis, const int16_t *strip, const int16_t *adc);
+
+    bool IsOpen() const {return pFile != nullptr;}
+    uint32_t GetTimeSamples() const {return fTimeSamples;}
+
+private:
+    void flushChunk();
+    void writeColumn(uint32_t col, const void *data, size_t bytes,
+            gem_native::NativeHitChunkHeader &header);
+    void writePadding(size_t bytes);
+
+private:
+    FILE *pFile = nullptr;
+    std::string fPath;
+    uint32_t fTimeSamples;
+    uint32_t fCompression;
+    uint32_t fEventsPerChunk;
+    uint64_t fEventCount = 0;
+    uint64_t fFileOffset = 0;
+
+    std::vector<gem_native::NativeHitChunkIndex> vChunkIndex;
+
+    // columns of the chunk being filled
+    std::vector<int32_t> cEvtID;
+    std::vector<uint32_t> cOffset;
+    std::vector<uint32_t> cAddr;
+    std::vector<int16_t> cPlane;
+    std::vector<int16_t> cProd;
+    std::vector<int16_t> cModule;
+    std::vector<int16_t> cAxis;
+    std::vector<int16_t> cStrip;
+    std::vector<int16_t> cADC;
+
+    // scratch buffer for compression
+    std::vector<char> vCompressBuf;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// reader, maps the whole file into memory
+
+class GEMNativeHitReader
+{
+public:
+    GEMNativeHitReader(const char *path = nullptr);
+    ~GEMNativeHitReader();
+
+    GEMNativeHitReader(const GEMNativeHitReader &) = delete;
+    GEMNativeHitReader &operator=(const GEMNativeHitReader &) = delete;
+
+    bool Open(const char *path);
+    void Close();
+    bool IsOpen() const {return pMap != nullptr;}
+
+    uint64_t GetEntries() const {return fEntries;}
+    uint32_t GetTimeSamples() const {return fTimeSamples;}
+    bool IsCompressed() const {return fCompression != gem_native::None;}
+
+    // get event by its index in file (0 ... GetEntries()-1)
+    bool GetEvent(const uint64_t &index, NativeHitEvent &ev);
+
+private:
+    bool loadChunk(const uint32_t &chunk);
+    const char *column(const uint32_t &col) const {return pColumn[col];}
+    // check if [offset, offset + bytes) lies inside the mapped file
+    bool inMap(const uint64_t &offset, const uint64_t &bytes) const
+    {
+        return offset <= fMapSize && bytes <= fMapSize - offset;
+    }
+
+private:
+    const char *pMap = nullptr;
+    size_t fMapSize = 0;
+    int fFd = -1;
+
+    uint32_t fTimeSamples = 0;
+    uint32_t fCompression = 0;
+    uint64_t fEntries = 0;
+
+    const gem_native::NativeHitChunkIndex *pChunkIndex = nullptr;
+    uint32_t fNChunks = 0;
+
+    // current chunk
+    int64_t fCurrentChunk = -1;
+    const gem_native::NativeHitChunkHeader *pChunkHeader = nullptr;
+    const char *pColumn[gem_native::NColumns];
+    // decompressed columns for LZ4 files
+    std::vector<char> vColumnBuf[gem_native::NColumns];
+};
+
+#endif
@@ -5,6 +5,7 @@
 #include "GEMStruct.h"
 #include "EvioFileReader.h"
 #include "EventParser.h"
+#include "SPSCQueue.h"
 
 #include <unordered_map>
 #include <vector>
@@ -12,6 +13,76 @@
 
 #include <TH1I.h>
 
+////////////////////////////////////////////////////////////////
+// streaming statistics for one strip, equivalent to filling a
+// TH1I with range [lo, hi) and asking for GetMean()/GetRMS():
+// entries outside the range do not enter the statistics
+
+struct StripStat
+{
+    uint32_t n = 0;
+    int64_t sum = 0;
+    int64_t sum2 = 0;
+
+    void Fill(const int &v, const int &lo, const int &hi)
+    {
+        if(v < lo || v >= hi)
+            return;
+        n++;
+        sum += v;
+        sum2 += static_cast<int64_t>(v) * v;
+    }
+
+    void Merge(const StripStat &r)
+    {
+        n += r.n;
+        sum += r.sum;
+        sum2 += r.sum2;
+    }
+
+    double GetMean() const
+    {
+        return n > 0 ? static_cast<double>(sum) / n : 0.;
+    }
+
+    double GetRMS() const;
+};
+
+////////////////////////////////////////////////////////////////
+// dense (apv slot x APV_STRIP_SIZE) strip statistics
+// slot index is assigned the first time an apv shows up, only
+// one address lookup per apv per event, no per strip hashing
+
+struct APVStripStat
+{
+    std::unordered_map<APVAddress, uint32_t> mSlot;
+    std::vector<APVAddress> vAPV;
+    std::vector<StripStat> vNoise;  // slot * APV_STRIP_SIZE + strip
+    std::vector<StripStat> vOffset; // slot * APV_STRIP_SIZE + strip
+
+    uint32_t GetSlot(const APVAddress &addr);
+    void Merge(const APVStripStat &r);
+    void Clear();
+    size_t GetNSlots() const {return vAPV.size();}
+};
+
+////////////////////////////////////////////////////////////////
+// per thread accumulator, each worker thread fills its own
+// accumulator, they are merged after all workers finished
+
+struct PedestalAccumulator
+{
+    // dense streaming statistics (RawAPVUnit_stat)
+    APVStripStat stat;
+    // all samples of each strip (RawAPVUnit_vec)
+    std::unordered_map<APVStripAddress, std::vector<int>> noise;
+    std::unordered_map<APVStripAddress, std::vector<int>> offset;
+};
+
+// an owned copy of one raw evio event
+typedef std::vector<uint32_t> EventBuffer;
+typedef SPSCQueue<EventBuffer> EventBufferQueue;
+
 class GEMPedestal
 {
 public:
@@ -19,9 +90,11 @@ public:
     ~GEMPedestal();
 
     void CalculatePedestal();
-    void CalculateEventRawPedestal(const std::unordered_map<APVAddress, std::vector<int>> &);
+    void CalculateEventRawPedestal(const std::unordered_map<APVAddress, std::vector<int>> &,
+            PedestalAccumulator &);
     void GenerateAPVPedestal_using_histo();
     void GenerateAPVPedestal_using_vec();
+    void GenerateAPVPedestal_using_stat();
     void SetDataFile(const char* path);
     void SetNumberOfEvents(int num);
     void Clear();
@@ -33,9 +106,15 @@ public:
     APVAddress ParseAPVAddressFromString(const std::string &);
     bool APVStripIsNew(const APVStripAddress &);
     void RawAPVUnit_histo(const std::unordered_map<APVAddress, std::vector<int>>::value_type &);
-    void RawAPVUnit_vec(const std::unordered_map<APVAddress, std::vector<int>>::value_type &);
+    void RawAPVUnit_vec(const std::unordered_map<APVAddress, std::vector<int>>::value_type &,
+            PedestalAccumulator &);
+    void RawAPVUnit_stat(const std::unordered_map<APVAddress, std::vector<int>>::value_type &,
+            PedestalAccumulator &);
     void RawPedestalThread(const std::unordered_map<APVAddress, std::vector<int>> &, int, int);
-    void GetEvent(EvioFileReader *, EventParser *, uint32_t &nEvents);
+    uint32_t ReadEvents(std::vector<EventBufferQueue*> &full, std::vector<EventBufferQueue*> &recycle);
+    void ProcessEvents(EventParser *, EventBufferQueue *full, EventBufferQueue *recycle,
+            PedestalAccumulator &acc);
+    void MergeAccumulator(PedestalAccumulator &acc);
     int GetMean(const std::vector<int> &);
     int GetRMS(const std::vector<int> &);
 
@@ -68,6 +147,8 @@ private:
     // for computing intensive jobs, use vector instead of TH1I
     std::unordered_map<APVStripAddress, std::vector<int>> mAPVStripNoiseVec;
     std::unordered_map<APVStripAddress, std::vector<int>> mAPVStripOffsetVec;
+    // streaming statistics, no samples stored, default
+    APVStripStat fAPVStripStat;
 
     // total number of events used for calculating pedestal
     uint32_t fNumberEvents = 5000;
@@ -0,0 +1,53 @@
+#ifndef GEM_RECLUSTER_H
+#define GEM_RECLUSTER_H
+
+#include <string>
+#include <vector>
+
+#include "GEMStruct.h"
+#include "GEMRootClusterTree.h"
+
+class GEMSystem;
+
+////////////////////////////////////////////////////////////////////////////////
+// re-cluster already replayed hits without decoding the raw data again
+//
+// input can be a root "GEMHit" tree written by GEMRootHitTree, or a native
+// hit file (skim) written by GEMNativeHitWriter. Events are read in batches,
+// each batch is reconstructed in parallel (every thread owns a GEMSystem),
+// the clusters are then written to a new cluster tree in input order.
+
+class GEMRecluster
+{
+public:
+    GEMRecluster(const std::string &config_file = "config/gem.conf", int nthreads = 4);
+    ~GEMRecluster();
+
+    GEMRecluster(const GEMRecluster &) = delete;
+    GEMRecluster &operator=(const GEMRecluster &) = delete;
+
+    // use a different cluster configuration than the one in gem.conf
+    void SetClusterConfiguration(const std::string &path);
+    void SetBatchSize(const size_t &n) {fBatchSize = (n > 0) ? n : 1;}
+
+    // return number of events processed
+    int Run(const std::string &input, const std::string &output);
+
+private:
+    int readHitTree(const std::string &path, GEMRootClusterTree &tree);
+    int readNativeHitFile(const std::string &path, GEMRootClusterTree &tree);
+    void processBatch(GEMRootClusterTree &tree);
+
+private:
+    std::vector<GEMSystem*> vGEMSystem;
+    size_t fBatchSize = 2000;
+
+    // current batch
+    std::vector<EventData> vBatch;
+    std::vector<ClusterTreeEvent> vBatchResult;
+
+    // hits that cannot be mapped back to an electronic channel
+    uint64_t fUnmappedHits = 0;
+};
+
+#endif
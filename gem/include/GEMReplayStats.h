@@ -0,0 +1,153 @@
+#ifndef GEM_REPLAY_STATS_H
+#define GEM_REPLAY_STATS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <fstream>
+#include <ostream>
+
+////////////////////////////////////////////////////////////////////////////////
+// Per-stage timing and throughput of a replay
+//
+// the replay chain is split into stages, every stage accumulates the time
+// spent in it (steady_clock, ns) and the number of calls:
+//     read     evio (or skim) reading
+//     parse    evio bank parsing, without the raw decoders
+//     decode   raw decoders (mpd, fadc ...)
+//     zs       pedestal/common mode subtraction and zero suppression
+//     cluster  clustering (cluster replay only)
+//     fill     output filling (root tree, native hit file, event storage)
+//     write    output writing at the end of replay
+//     wait     replay thread blocked by the event process thread
+// cluster and fill run in the event process thread, in parallel with the
+// other stages, so the stage fractions of wall time can add up to > 1
+//
+// events/s, MB/s, stage time and queue occupancy are sampled once per
+// interval (1 s by default), the samples can be streamed to a csv file
+// while the replay runs, and a summary (json or csv) is written at the end
+//
+// not thread safe, a stage must be only accumulated by one thread, and the
+// accumulators of another thread can only be read after it is joined
+
+enum class ReplayStage : int
+{
+    Read = 0,
+    Parse,
+    Decode,
+    ZeroSup,
+    Cluster,
+    Fill,
+    Write,
+    Wait,
+    Max,
+};
+
+class GEMReplayStats
+{
+public:
+    typedef std::chrono::steady_clock clock;
+
+    struct Sample
+    {
+        double time = 0.;       // s since start, end of the interval
+        uint64_t events = 0;    // events in the interval
+        double event_rate = 0.; // events/s
+        double mb_rate = 0.;    // MB/s of input
+        double queue_avg = 0.;  // average queue occupancy
+        size_t queue_max = 0;
+        double stage_ms[static_cast<int>(ReplayStage::Max)] = {0.};
+    };
+
+    GEMReplayStats();
+    ~GEMReplayStats();
+
+    // reset all counters and start the clock
+    void Start();
+    // stop the clock, close the stream file
+    void Stop();
+
+    static clock::time_point Now() {return clock::now();}
+    void Add(ReplayStage s, const clock::time_point &begin, const clock::time_point &end)
+    {
+        int i = static_cast<int>(s);
+        fStageTime[i] += std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+        fStageCalls[i]++;
+    }
+    void AddNanoseconds(ReplayStage s, uint64_t ns)
+    {
+        int i = static_cast<int>(s);
+        fStageTime[i] += ns;
+        fStageCalls[i]++;
+    }
+    void AddBytes(uint64_t bytes) {fBytes += bytes;}
+    // queue occupancy seen by the producer when an event is queued
+    void AddQueue(size_t depth, size_t capacity)
+    {
+        fQueueSum += depth; fQueueCount++;
+        if(depth > fQueueMax) fQueueMax = depth;
+        if(depth > fIntervalQueueMax) fIntervalQueueMax = depth;
+        if(capacity > fQueueCapacity) fQueueCapacity = capacity;
+    }
+    // count one event, take a sample if the interval has passed
+    void AddEvent()
+    {
+        fEvents++;
+        clock::time_point now = clock::now();
+        if(now - fLastSample >= fInterval)
+            takeSample(now);
+    }
+
+    // sampling interval, default 1 second
+    void SetSampleInterval(double seconds);
+    // stream every sample as a csv line, empty path to disable
+    // takes effect at next Start()
+    void SetStreamFile(const std::string &path) {fStreamPath = path;}
+
+    uint64_t GetEvents() const {return fEvents;}
+    uint64_t GetBytes() const {return fBytes;}
+    double GetElapsed() const;
+    double GetStageTime(ReplayStage s) const;   // seconds
+    uint64_t GetStageCalls(ReplayStage s) const {return fStageCalls[static_cast<int>(s)];}
+    const std::vector<Sample> &GetSamples() const {return vSamples;}
+    static const char *StageName(ReplayStage s);
+
+    // the stage that limits the replay speed
+    ReplayStage GetLimitingStage() const;
+
+    // summary, the format is json if the path ends with .json, csv otherwise
+    bool WriteSummary(const std::string &path) const;
+    void WriteJSON(std::ostream &os) const;
+    void WriteCSV(std::ostream &os) const;
+    void Print(std::ostream &os) const;
+
+private:
+    void takeSample(const clock::time_point &now);
+    void writeSampleHeader(std::ostream &os) const;
+    void writeSample(std::ostream &os, const Sample &s) const;
+
+private:
+    clock::time_point fStart, fStop, fLastSample;
+    clock::duration fInterval;
+    bool bRunning = false;
+
+    uint64_t fStageTime[static_cast<int>(ReplayStage::Max)];   // ns
+    uint64_t fStageCalls[static_cast<int>(ReplayStage::Max)];
+    uint64_t fEvents = 0;
+    uint64_t fBytes = 0;
+    uint64_t fQueueSum = 0, fQueueCount = 0;
+    size_t fQueueMax = 0, fQueueCapacity = 0;
+
+    // counters at the last sample
+    uint64_t fLastStageTime[static_cast<int>(ReplayStage::Max)];
+    uint64_t fLastEvents = 0, fLastBytes = 0;
+    uint64_t fLastQueueSum = 0, fLastQueueCount = 0;
+    size_t fIntervalQueueMax = 0;
+
+    std::vector<Sample> vSamples;
+    std::string fStreamPath;
+    std::ofstream fStream;
+};
+
+#endif
@@ -4,6 +4,9 @@
 #include <TTree.h>
 #include <TFile.h>
 
+#include <vector>
+#include <string>
+
 class GEMSystem;
 class GEMCluster;
 
@@ -13,6 +16,32 @@ class GEMCluster;
 #define MAXCLUSTERS 200000
 #define MAXCLUSTERSIZE 100
 
+////////////////////////////////////////////////////////////////////////////////
+// clusters of one event, extracted from gem system, so that events
+// reconstructed in parallel can be filled to the tree later in order
+// strips of cluster i are strip_no/strip_adc[strip_offset[i] ... strip_offset[i+1]-1],
+// Clear() keeps the memory, so a reused event does not allocate
+
+struct ClusterTreeEvent
+{
+    int evtID = 0;
+    std::vector<int> plane, prod, module, axis, size;
+    std::vector<float> adc, pos;
+    std::vector<int> strip_no;                  // chamber based strip no
+    std::vector<float> strip_adc;
+    std::vector<size_t> strip_offset{0};
+
+    void Clear()
+    {
+        evtID = 0;
+        plane.clear(); prod.clear(); module.clear(); axis.clear(); size.clear();
+        adc.clear(); pos.clear(); strip_no.clear(); strip_adc.clear();
+        strip_offset.assign(1, 0);
+    }
+
+    int GetNClusters() const {return static_cast<int>(plane.size());}
+};
+
 class GEMRootClusterTree
 {
 public:
@@ -21,6 +50,10 @@ public:
 
     void Write();
     void Fill(GEMSystem* gem_sys, const uint32_t &evt_num);
+    void Fill(const ClusterTreeEvent &ev);
+
+    // thread safe, only reads gem system
+    static void Collect(GEMSystem* gem_sys, const uint32_t &evt_num, ClusterTreeEvent &ev);
 
 private:
     TTree *pTree = nullptr;
@@ -45,6 +78,9 @@ private:
 
     // clustering method
     GEMCluster *cluster_method = nullptr;
+
+    // buffer for Fill(gem_sys, evt_num)
+    ClusterTreeEvent fEvent;
 };
 
 #endif
@@ -11,6 +11,8 @@
 // save replayed evio files to root tree
 
 #define MAXHITS 20000
+// time samples saved, branches adc0 ... adc5
+#define HIT_TREE_TIME_SAMPLES 6
 
 class GEMRootHitTree
 {
@@ -36,12 +38,7 @@ private:
     int Strip[MAXHITS];    // strip index on a single chamber
     int Axis[MAXHITS];  // x or y plane
 
-    int adc0[MAXHITS];
-    int adc1[MAXHITS];
-    int adc2[MAXHITS];
-    int adc3[MAXHITS];
-    int adc4[MAXHITS];
-    int adc5[MAXHITS];
+    int adc[HIT_TREE_TIME_SAMPLES][MAXHITS];
 };
 
 #endif
@@ -3,7 +3,9 @@
 
 #include <cstdint>
 #include <vector>
+#include <utility>
 #include "MPDDataStruct.h"
+#include "Fadc250Data.h"
 
 ////////////////////////////////////////////////////////////////
 // In mpd apv raw data, the length of one time sample 
@@ -82,6 +84,112 @@ struct GEM_Strip_Data
     }
 };
 
+////////////////////////////////////////////////////////////////
+// pack/unpack channel address to 32 bits, 8 bits for each field
+// the packed value sorts in the same order as (crate, mpd, adc, strip)
+
+inline uint32_t PackChannelAddress(const GEMChannelAddress &a)
+{
+    return ((static_cast<uint32_t>(a.crate) & 0xff) << 24)
+        | ((static_cast<uint32_t>(a.mpd) & 0xff) << 16)
+        | ((static_cast<uint32_t>(a.adc) & 0xff) << 8)
+        | (static_cast<uint32_t>(a.strip) & 0xff);
+}
+
+inline GEMChannelAddress UnpackChannelAddress(const uint32_t &a)
+{
+    return GEMChannelAddress((a >> 24) & 0xff, (a >> 16) & 0xff,
+            (a >> 8) & 0xff, a & 0xff);
+}
+
+////////////////////////////////////////////////////////////////
+// zero suppressed hits of one event, in structure of arrays layout
+// hit i has the packed address addr[i], and its adc values are
+// adc[i*stride] ... adc[i*stride + stride - 1], stride is the number of
+// time samples (set by the first hit), a hit with less time samples is
+// padded with 0, a hit with more time samples widens the stride
+// nts[i] keeps the number of time samples hit i really has
+// clear() keeps the memory, so a reused event does not allocate
+
+struct GEMStripHits
+{
+    std::vector<uint32_t> addr;
+    std::vector<float> adc;
+    std::vector<uint16_t> nts;
+    uint32_t stride = 0;
+
+    size_t size() const {return addr.size();}
+    bool empty() const {return addr.empty();}
+    // stride of the adc array, the maximum time samples of all hits
+    uint32_t time_samples() const {return stride;}
+    uint32_t time_samples(const size_t &i) const {return nts[i];}
+
+    void clear()
+    {
+        addr.clear();
+        adc.clear();
+        nts.clear();
+        stride = 0;
+    }
+
+    void reserve(const size_t &nhits, const uint32_t &n)
+    {
+        addr.reserve(nhits);
+        adc.reserve(nhits * n);
+        nts.reserve(nhits);
+    }
+
+    // append a hit, return the place for its adc values (valid until the
+    // next add_hit), the values are 0 initialized
+    float *add_hit(const uint32_t &packed_addr, const uint32_t &n)
+    {
+        if(n > stride)
+            widen(n);
+        addr.push_back(packed_addr);
+        nts.push_back(static_cast<uint16_t>(n));
+        adc.resize(adc.size() + stride, 0.);
+        return &adc[adc.size() - stride];
+    }
+
+    float *add_hit(const GEMChannelAddress &a, const uint32_t &n)
+    {
+        return add_hit(PackChannelAddress(a), n);
+    }
+
+    void add_hit(const GEMChannelAddress &a, const float *vals, const uint32_t &n)
+    {
+        float *dst = add_hit(a, n);
+        for(uint32_t i = 0; i < n; ++i)
+            dst[i] = vals[i];
+    }
+
+    GEMChannelAddress address(const size_t &i) const {return UnpackChannelAddress(addr[i]);}
+    const float *values(const size_t &i) const {return &adc[i*stride];}
+    float *values(const size_t &i) {return &adc[i*stride];}
+
+    // copy one hit in GEM_Strip_Data format, for the non-critical paths
+    GEM_Strip_Data strip(const size_t &i) const
+    {
+        GEM_Strip_Data s;
+        s.addr = address(i);
+        s.values.assign(values(i), values(i) + nts[i]);
+        return s;
+    }
+
+private:
+    void widen(const uint32_t &n)
+    {
+        if(!addr.empty()) {
+            std::vector<float> buf(addr.size() * n, 0.);
+            for(size_t i = 0; i < addr.size(); ++i)
+                for(uint32_t j = 0; j < stride; ++j)
+                    buf[i*n + j] = adc[i*stride + j];
+            adc.swap(buf);
+        }
+        stride = n;
+    }
+};
+
 ////////////////////////////////////////////////////////////////
 // raw event data structure
 
@@ -94,7 +202,12 @@ struct EventData
     uint64_t timestamp;
 
     // data banks
-    std::vector<GEM_Strip_Data> gem_data;
+    GEMStripHits gem_data;
+    // fadc250 banks (one per board) decoded in the same pass
+    std::vector<fdec::Fadc250Event> fadc_data;
+    // cleared fadc250 events kept for reuse, so their channel buffers are
+    // not allocated again
+    std::vector<fdec::Fadc250Event> fadc_spare;
 
     // constructors
     EventData()
@@ -111,6 +224,9 @@ struct EventData
         trigger = 0;
         timestamp = 0;
         gem_data.clear();
+        for(auto &e: fadc_data)
+            fadc_spare.push_back(std::move(e));
+        fadc_data.clear();
     }
 
     void update_type(const uint8_t &t) {type = t;}
@@ -121,11 +237,29 @@ struct EventData
     uint32_t get_trigger() const {return trigger;}
     uint64_t get_time() const {return timestamp;}
 
-    void add_gemhit(const GEM_Strip_Data &g) {gem_data.emplace_back(g);}
-    void add_gemhit(GEM_Strip_Data &&g) {gem_data.emplace_back(g);}
+    void add_gemhit(const GEM_Strip_Data &g)
+    {
+        gem_data.add_hit(g.addr, g.values.data(), static_cast<uint32_t>(g.values.size()));
+    }
+
+    GEMStripHits &get_gem_data() {return gem_data;}
+    const GEMStripHits &get_gem_data() const {return gem_data;}
 
-    std::vector<GEM_Strip_Data> &get_gem_data() {return gem_data;}
-    const std::vector<GEM_Strip_Data> &get_gem_data() const {return gem_data;}
+    // e is swapped with a reused slot, the caller gets back the buffers of an
+    // old event (content undefined), nothing is copied
+    void add_fadc_event(fdec::Fadc250Event &e)
+    {
+        if(fadc_spare.empty()) {
+            fadc_data.emplace_back();
+        }
+        else {
+            fadc_data.push_back(std::move(fadc_spare.back()));
+            fadc_spare.pop_back();
+        }
+        std::swap(fadc_data.back(), e);
+    }
+    std::vector<fdec::Fadc250Event> &get_fadc_data() {return fadc_data;}
+    const std::vector<fdec::Fadc250Event> &get_fadc_data() const {return fadc_data;}
 };
 
 
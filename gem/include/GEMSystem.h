@@ -128,6 +128,7 @@ public:
     void SetUnivCommonModeThresLevel(const float &thres);
     void SetUnivZeroSupThresLevel(const float &thres);
     void SetUnivTimeSample(const uint32_t &thres);
+    void SetUnivIntegerProcessing(const bool &m);
     void SetPedestalMode(const bool &m);
     void SetOnlineMode(const bool &m);
     void SetReplayMode(const bool &m);
@@ -144,7 +145,7 @@ public:
     GEMAPV *GetAPV(const APVAddress &addr) const;
     GEMAPV *GetAPV(const int &crate_id, const int &mpd, const int &adc) const;
 
-    std::vector<GEM_Strip_Data> GetZeroSupData() const;
+    GEMStripHits GetZeroSupData() const;
     std::vector<GEMAPV*> GetAPVList() const;
     std::vector<GEMMPD*> GetMPDList() const;
     std::vector<GEMDetector*> GetDetectorList() const;
@@ -177,6 +178,7 @@ private:
     float def_cth;
     float def_zth;
     float def_ctth;
+    bool def_int;
 
     // a locker for multi threading
     std::mutex __gem_locker;
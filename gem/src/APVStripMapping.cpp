@@ -150,6 +150,7 @@ void Mapping::LoadMap(const char* path)
     ExtractAPVAddress();
     ExtractLayerID();
     ExtractDetectorID();
+    ExtractChannelAddress();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -281,6 +282,56 @@ int Mapping::GetStrip(const std::string &detector_type, const GEMChannelAddress
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+// a helper, key for the reverse strip mapping
+
+static inline uint32_t strip_channel_key(const int &prod_id, const int &axis, const int &strip)
+{
+    return ((static_cast<uint32_t>(prod_id) & 0xffff) << 16)
+        | ((static_cast<uint32_t>(axis) & 0x1) << 15)
+        | (static_cast<uint32_t>(strip) & 0x7fff);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// reverse of GetStrip(), find electronic channel address from chamber strip
+// used for feeding replayed hit trees back to gem system
+
+bool Mapping::GetChannelAddress(const int &prod_id, const int &axis, const int &strip,
+        GEMChannelAddress &addr) const
+{
+    auto it = mStripChannel.find(strip_channel_key(prod_id, axis, strip));
+    if(it == mStripChannel.end())
+        return false;
+
+    addr = it -> second;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// build the reverse strip mapping, the detector type of each apv is
+// the gem type of the layer it belongs to
+
+void Mapping::ExtractChannelAddress()
+{
+    for(auto &i: apvs)
+    {
+        const APVInfo &info = i.second;
+        if(layers.find(info.layer_id) == layers.end())
+            continue;
+
+        const std::string &detector_type = layers.at(info.layer_id).gem_type;
+        if(mapped_strip_arr.find(detector_type) == mapped_strip_arr.end())
+            continue;
+
+        for(int ch=0; ch<APV_STRIP_SIZE; ++ch)
+        {
+            GEMChannelAddress addr(info.crate_id, info.mpd_id, info.adc_ch, ch);
+            int strip = GetStrip(detector_type, addr);
+            mStripChannel[strip_channel_key(info.detector_id, info.dimension, strip)] = addr;
+        }
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // extract all MPD IDs
 
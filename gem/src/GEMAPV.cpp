@@ -8,6 +8,7 @@
 
 #include <iostream>
 #include <iomanip>
+#include <cmath>
 #include "MPDDataStruct.h"
 #include "GEMSystem.h"
 #include "GEMMPD.h"
@@ -22,6 +23,23 @@
 // macro to get the data index
 #define DATA_INDEX(ch, ts) (ts_begin + ch + ts*MPD_APV_TS_LEN)
 
+////////////////////////////////////////////////////////////////////////////////
+// fixed point format of the integer processing, the adc values are saturated
+// to 13 bits, so there are 2 fraction bits left in int16
+#define APV_FIX_SHIFT 2
+#define APV_FIX_ADC_MIN (-8192)
+#define APV_FIX_ADC_MAX 8191
+
+static inline int16_t saturate_fix(const int32_t &v)
+{
+    return static_cast<int16_t>(v < -32768 ? -32768 : (v > 32767 ? 32767 : v));
+}
+
+static inline int32_t saturate_fix32(const double &v)
+{
+    return static_cast<int32_t>(v < -2147483648. ? -2147483648. : (v > 2147483647. ? 2147483647. : v));
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // use vector or TH1I for storing temporal data for pedestal generation
 // vector is faster than TH1I
@@ -96,6 +114,7 @@ GEMAPV::GEMAPV(const GEMAPV &that)
     // raw data related
     buffer_size = that.buffer_size;
     ts_begin = that.ts_begin;
+    selectKernels();
     // dangerous part, may fail due to lack of memory
     raw_data = new float[buffer_size];
     // copy values
@@ -104,6 +123,12 @@ GEMAPV::GEMAPV(const GEMAPV &that)
         raw_data[i] = that.raw_data[i];
     }
 
+    // integer processing
+    integer_processing = that.integer_processing;
+    fix_frame = that.fix_frame;
+    fix_corrected = that.fix_corrected;
+    raw_fix = that.raw_fix;
+
     // copy other arrays
     for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
     {
@@ -141,11 +166,18 @@ GEMAPV::GEMAPV(GEMAPV &&that)
     // raw_data related
     buffer_size = that.buffer_size;
     ts_begin = that.ts_begin;
+    selectKernels();
     raw_data = that.raw_data;
     // null the pointer of that
     that.buffer_size = 0;
     that.raw_data = nullptr;
 
+    // integer processing
+    integer_processing = that.integer_processing;
+    fix_frame = that.fix_frame;
+    fix_corrected = that.fix_corrected;
+    raw_fix.swap(that.raw_fix);
+
     // other arrays
     // static array, so no need to move, just copy elements
     for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
@@ -210,11 +242,19 @@ GEMAPV &GEMAPV::operator= (GEMAPV &&rhs)
     // raw_data related
     buffer_size = rhs.buffer_size;
     ts_begin = rhs.ts_begin;
+    selectKernels();
     raw_data = rhs.raw_data;
     // null the pointer of that
     rhs.buffer_size = 0;
     rhs.raw_data = nullptr;
 
+    // integer processing
+    integer_processing = rhs.integer_processing;
+    fix_frame = rhs.fix_frame;
+    fix_corrected = rhs.fix_corrected;
+    fix_valid = false;
+    raw_fix.swap(rhs.raw_fix);
+
     // other arrays
     // static array, so no need to move, just copy elements
     for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
@@ -230,6 +270,11 @@ GEMAPV &GEMAPV::operator= (GEMAPV &&rhs)
         rhs.noise_hist[i] = nullptr;
     }
 
+    // the moved data state is unknown, clear everything next time
+    data_dirty = true;
+    data_full_dirty = true;
+    ped_dirty = true;
+
     return *this;
 }
 
@@ -250,6 +295,34 @@ void GEMAPV::SetAddress(const APVAddress &apv_addr)
     adc_ch = apv_addr.adc_ch;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// integer processing of mpd frames
+// the frame is kept as int16 fixed point, the pedestal and common mode
+// subtraction and the zero suppression work on integers, only the hits are
+// converted to float, the result differs from the float processing by the
+// fixed point rounding of the pedestal and common mode (a fraction of an adc
+// count), so a strip right at the threshold may change, only the
+// DANNING_ALGORITHM common mode is supported
+
+void GEMAPV::SetIntegerProcessing(const bool &m)
+{
+#ifndef DANNING_ALGORITHM
+    // not supported, GEMSystem warns about it once
+    if(m)
+        return;
+#endif
+
+    integer_processing = m;
+    fix_frame = false;
+    fix_corrected = false;
+    fix_valid = false;
+
+    if(m)
+        raw_fix.resize(buffer_size);
+    else
+        std::vector<int16_t>().swap(raw_fix);
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////
 // connect the apv to GEM MPD
@@ -359,11 +432,16 @@ void GEMAPV::ResetPedHist()
 {
 #ifdef USE_VEC
     // using vector instead of using TH1I
+    // nothing to reset if no pedestal data filled since last reset
+    if(!ped_dirty)
+        return;
+
     for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
     {
         offset_vec[i].clear();
         noise_vec[i].clear();
     }
+    ped_dirty = false;
 #else
     // obsolete
     for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
@@ -406,26 +484,61 @@ void GEMAPV::SetTimeSample(const uint32_t &t)
 
     raw_data = new float[buffer_size];
 
+    if(integer_processing)
+        raw_fix.resize(buffer_size);
+    fix_frame = false;
+    fix_corrected = false;
+    fix_valid = false;
+
+    selectKernels();
+
+    // new buffer, needs a full clear
+    data_dirty = true;
+    data_full_dirty = true;
     ClearData();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // clear all the data
+// the cost depends on what was filled since the last clear: nothing for an
+// untouched apv, only the hit channels if only zero suppressed data was
+// filled (replayed data), the whole buffer after a raw data frame
 
 void GEMAPV::ClearData()
 {
-    // set to a high value that won't trigger zero suppression
-    for(uint32_t i = 0; i < buffer_size; ++i)
-        raw_data[i] = 5000.;
+    if(data_dirty && !data_full_dirty) {
+        // raw data is all cleared except the zero suppressed hits
+        for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
+        {
+            if(!hit_pos[i])
+                continue;
 
-    ResetHitPos();
+            for(uint32_t j = 0; j < time_samples; ++j)
+                raw_data[DATA_INDEX(i, j)] = 5000.;
+            hit_pos[i] = false;
+        }
+    }
+    else if(data_dirty) {
+        // set to a high value that won't trigger zero suppression
+        for(uint32_t i = 0; i < buffer_size; ++i)
+            raw_data[i] = 5000.;
+
+        ResetHitPos();
+    }
+
+    data_dirty = false;
+    data_full_dirty = false;
+    fix_corrected = false;
 
     commonModeDist.clear();
 
-    for(auto &i: offset_vec)
-        i.clear();
-    for(auto &i: noise_vec)
-        i.clear();
+    if(ped_dirty) {
+        for(auto &i: offset_vec)
+            i.clear();
+        for(auto &i: noise_vec)
+            i.clear();
+        ped_dirty = false;
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -435,6 +548,10 @@ void GEMAPV::ResetHitPos()
 {
     for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
         hit_pos[i] = false;
+
+    // the filled channels are not tracked anymore
+    if(data_dirty)
+        data_full_dirty = true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -444,6 +561,7 @@ void GEMAPV::ClearPedestal()
 {
     for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
         pedestal[i] = Pedestal(0, 0);
+    fix_valid = false;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -453,6 +571,7 @@ void GEMAPV::UpdatePedestal(std::vector<Pedestal> &ped)
 {
     for(uint32_t i = 0; (i < ped.size()) && (i < APV_STRIP_SIZE); ++i)
         pedestal[i] = ped[i];
+    fix_valid = false;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -464,6 +583,7 @@ void GEMAPV::UpdatePedestal(const Pedestal &ped, const uint32_t &index)
         return;
 
     pedestal[index] = ped;
+    fix_valid = false;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -476,6 +596,7 @@ void GEMAPV::UpdatePedestal(const float &offset, const float &noise, const uint3
 
     pedestal[index].offset = offset;
     pedestal[index].noise = noise;
+    fix_valid = false;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -488,6 +609,7 @@ void GEMAPV::UpdateCommonModeRange(const float &c_min, const float &c_max)
 
     common_mode_range_min = c_min;
     common_mode_range_max = c_max;
+    fix_valid = false;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -533,6 +655,10 @@ void GEMAPV::FillRawDataSRS(const uint32_t *buf, const uint32_t &size)
     }
 
     ts_begin = getTimeSampleStart();
+    fix_frame = false;
+    fix_corrected = false;
+    data_dirty = true;
+    data_full_dirty = true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -541,19 +667,42 @@ void GEMAPV::FillRawDataSRS(const uint32_t *buf, const uint32_t &size)
 
 void GEMAPV::FillRawDataMPD(const std::vector<int> &buf, const uint32_t &flags)
 {
-    if(buf.size() > buffer_size) {
-        std::cerr << "Received " << buf.size() << " adc words, "
+    FillRawDataMPD(buf.data(), static_cast<uint32_t>(buf.size()), flags);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// fill raw data from a flat buffer, no vector needed
+
+void GEMAPV::FillRawDataMPD(const int *buf, const uint32_t &siz, const uint32_t &flags)
+{
+    if(siz > buffer_size) {
+        std::cerr << "Received " << siz << " adc words, "
             << "but APV " << adc_ch << " in MPD " << mpd_id
             << " has only " << buffer_size << " channels" << std::endl;
         return;
     }
 
-    for(uint32_t i = 0; i < buf.size(); ++i)
-    {
-        raw_data[i] = static_cast<float>(buf[i]);
+    if(integer_processing) {
+        // saturate to the fixed point range, converted to float after zero
+        // suppression (only the hits)
+        for(uint32_t i = 0; i < siz; ++i)
+        {
+            int v = buf[i] < APV_FIX_ADC_MIN ? APV_FIX_ADC_MIN : buf[i];
+            raw_fix[i] = static_cast<int16_t>(v > APV_FIX_ADC_MAX ? APV_FIX_ADC_MAX : v);
+        }
+    }
+    else {
+        for(uint32_t i = 0; i < siz; ++i)
+        {
+            raw_data[i] = static_cast<float>(buf[i]);
+        }
     }
 
     ts_begin = getTimeSampleStart();
+    fix_frame = integer_processing;
+    fix_corrected = false;
+    data_dirty = true;
+    data_full_dirty = true;
 
     // set raw data flags
     raw_data_flags = flags;
@@ -562,9 +711,11 @@ void GEMAPV::FillRawDataMPD(const std::vector<int> &buf, const uint32_t &flags)
 ////////////////////////////////////////////////////////////////////////////////
 // fill zero suppressed data, for one specific time sample bin
 
-void GEMAPV::FillZeroSupData(const uint32_t &ch, const uint32_t &ts, const unsigned short &val)
+void GEMAPV::FillZeroSupData(const uint32_t &ch, const uint32_t &ts, const float &val)
 {
     ts_begin = 0;
+    fix_frame = false;
+    fix_corrected = false;
     uint32_t idx = DATA_INDEX(ch, ts);
     if(ts >= time_samples ||
             ch >= APV_STRIP_SIZE ||
@@ -579,27 +730,39 @@ void GEMAPV::FillZeroSupData(const uint32_t &ch, const uint32_t &ts, const unsig
 
     hit_pos[ch] = true;
     raw_data[idx] = val;
+    data_dirty = true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // fill zero suppressed data (for all time samples)
 
 void GEMAPV::FillZeroSupData(const uint32_t &ch, const std::vector<float> &vals)
+{
+    FillZeroSupData(ch, vals.data(), vals.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// fill zero suppressed data (for all time samples), from a flat array
+
+void GEMAPV::FillZeroSupData(const uint32_t &ch, const float *vals, const uint32_t &nts)
 {
     ts_begin = 0;
+    fix_frame = false;
+    fix_corrected = false;
 
-    if(vals.size() != time_samples || ch >= APV_STRIP_SIZE)
+    if(nts != time_samples || ch >= APV_STRIP_SIZE)
     {
         std::cerr << "GEM APV Error: Failed to fill zero suppressed data, "
-            << " channel " << ch << " or time sample " << vals.size()
+            << " channel " << ch << " or time sample " << nts
             << " is not allowed."
             << std::endl;
         return;
     }
 
     hit_pos[ch] = true;
+    data_dirty = true;
 
-    for(uint32_t i = 0; i < vals.size(); ++i)
+    for(uint32_t i = 0; i < nts; ++i)
     {
         uint32_t idx = DATA_INDEX(ch, i);
         raw_data[idx] = vals[i];
@@ -611,38 +774,12 @@ void GEMAPV::FillZeroSupData(const uint32_t &ch, const std::vector<float> &vals)
 
 void GEMAPV::FillPedHist()
 {
-    float average[time_samples];
-
-    for(uint32_t i = 0; i < time_samples; ++i)
-    {
-        getAverage(average[i], &raw_data[DATA_INDEX(0, i)]);
-    }
-
-    for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
-    {
-        float ch_average = 0.;
-        float noise_average = 0.;
-        for(uint32_t j = 0; j < time_samples; ++j)
-        {
-            ch_average += raw_data[DATA_INDEX(i, j)];
-            noise_average += raw_data[DATA_INDEX(i, j)] - average[j];
-        }
-#ifdef USE_VEC
-        offset_vec[i].push_back(ch_average/time_samples);
-        noise_vec[i].push_back(noise_average/time_samples);
-#else
-        // obsolete
-        if(offset_hist[i])
-            offset_hist[i]->Fill(ch_average/time_samples);
+    // pedestal runs are not the critical path, use the float kernel
+    if(fix_frame)
+        convertFixFrame();
 
-        // obsolete
-        if(noise_hist[i])
-            noise_hist[i]->Fill(noise_average/time_samples);
-#endif
-    }
-
-    // save common mode
-    commonModeDist.insert(commonModeDist.end(), average, average + time_samples);
+    (this->*fill_ped_kernel)();
+    ped_dirty = true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -746,44 +883,52 @@ void GEMAPV::ZeroSuppression()
         return;
     }
 
-    for(uint32_t ts = 0; ts < time_samples; ++ts)
-    {
-        CommonModeCorrection(&raw_data[DATA_INDEX(0, ts)], APV_STRIP_SIZE);
-    }
+    // common mode correction works in place on the raw data
+    data_dirty = true;
+    data_full_dirty = true;
 
-    for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
+#ifdef DANNING_ALGORITHM
+    // integer processing
+    if(fix_frame)
     {
-        float average = 0.;
-        for(uint32_t j = 0; j < time_samples; ++j)
+        if(!fix_valid)
+            updateFixedPoint();
+
+        commonMode.resize(time_samples);
+        for(uint32_t ts = 0; ts < time_samples; ++ts)
         {
-            average += raw_data[DATA_INDEX(i, j)];
+            commonModeCorrectionFix(&raw_fix[DATA_INDEX(0, ts)]);
+            commonMode[ts] = lastCommonMode;
         }
-        average /= time_samples;
 
-        if(average > pedestal[i].noise * zerosup_thres)
-            hit_pos[i] = true;
-        else
-            hit_pos[i] = false;
+        (this->*find_hits_fix_kernel)();
+        // raw_fix is common mode corrected now, it is not a raw frame anymore
+        fix_frame = false;
+        fix_corrected = true;
+        return;
     }
+#endif
+
+    commonMode.resize(time_samples);
+    for(uint32_t ts = 0; ts < time_samples; ++ts)
+    {
+        CommonModeCorrection(&raw_data[DATA_INDEX(0, ts)], APV_STRIP_SIZE);
+        commonMode[ts] = lastCommonMode;
+    }
+
+    (this->*find_hits_kernel)();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // collect zero suppressed hit in raw data space, need a container input
 
-void GEMAPV::CollectZeroSupHits(std::vector<GEM_Strip_Data> &hits)
+void GEMAPV::CollectZeroSupHits(GEMStripHits &hits)
 {
-    for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
-    {
-        if(!hit_pos[i])
-            continue;
+    // no hits since the last clear
+    if(!data_dirty)
+        return;
 
-        GEM_Strip_Data hit(crate_id, mpd_id, adc_ch, i);
-        for(uint32_t j = 0; j < time_samples; ++j)
-        {
-            hit.values.emplace_back(raw_data[DATA_INDEX(i, j)]);
-        }
-        hits.emplace_back(hit);
-    }
+    (this->*collect_hits_kernel)(hits);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -791,7 +936,7 @@ void GEMAPV::CollectZeroSupHits(std::vector<GEM_Strip_Data> &hits)
 
 void GEMAPV::CollectZeroSupHits()
 {
-    if(plane == nullptr)
+    if(plane == nullptr || !data_dirty)
         return;
 
     for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
@@ -930,6 +1075,8 @@ void GEMAPV::CommonModeCorrection(float *buf, const uint32_t &size)
             buf[i] -= average;
         }
     }
+
+    lastCommonMode = average;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1250,6 +1397,281 @@ void GEMAPV::getAverage(float &average, const float *buf)
     average /= (float)count;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// time sample kernels
+// the number of time samples is a template parameter, so the loops over time
+// samples are unrolled and the loops over strips can be vectorized, NTS = 0
+// is the generic version for any number of time samples
+// raw data of channel i at time sample j is data[i + j*MPD_APV_TS_LEN]
+
+// fill pedestal data, the average of each time sample is saved as the
+// common mode
+template<uint32_t NTS>
+void GEMAPV::fillPedHist()
+{
+    const uint32_t nts = NTS ? NTS : time_samples;
+    const float *data = &raw_data[ts_begin];
+
+    size_t cm_begin = commonModeDist.size();
+    commonModeDist.resize(cm_begin + nts);
+    float *average = &commonModeDist[cm_begin];
+
+    for(uint32_t j = 0; j < nts; ++j)
+    {
+        getAverage(average[j], &data[j*MPD_APV_TS_LEN]);
+    }
+
+    for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
+    {
+        float ch_average = 0.;
+        float noise_average = 0.;
+        for(uint32_t j = 0; j < nts; ++j)
+        {
+            ch_average += data[i + j*MPD_APV_TS_LEN];
+            noise_average += data[i + j*MPD_APV_TS_LEN] - average[j];
+        }
+#ifdef USE_VEC
+        offset_vec[i].push_back(ch_average/nts);
+        noise_vec[i].push_back(noise_average/nts);
+#else
+        // obsolete
+        if(offset_hist[i])
+            offset_hist[i]->Fill(ch_average/nts);
+
+        // obsolete
+        if(noise_hist[i])
+            noise_hist[i]->Fill(noise_average/nts);
+#endif
+    }
+}
+
+// zero suppression on the common mode corrected data
+template<uint32_t NTS>
+void GEMAPV::findZeroSupHits()
+{
+    const uint32_t nts = NTS ? NTS : time_samples;
+    const float *data = &raw_data[ts_begin];
+
+    for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
+    {
+        float average = 0.;
+        for(uint32_t j = 0; j < nts; ++j)
+        {
+            average += data[i + j*MPD_APV_TS_LEN];
+        }
+        average /= nts;
+
+        hit_pos[i] = average > pedestal[i].noise * zerosup_thres;
+    }
+}
+
+// copy the hits to the event hit storage
+template<uint32_t NTS>
+void GEMAPV::collectZeroSupHits(GEMStripHits &hits)
+{
+    const uint32_t nts = NTS ? NTS : time_samples;
+    const float *data = &raw_data[ts_begin];
+    uint32_t apv_addr = PackChannelAddress(GEMChannelAddress(crate_id, mpd_id, adc_ch, 0));
+
+    for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
+    {
+        if(!hit_pos[i])
+            continue;
+
+        float *dst = hits.add_hit(apv_addr | i, nts);
+        for(uint32_t j = 0; j < nts; ++j)
+        {
+            dst[j] = data[i + j*MPD_APV_TS_LEN];
+        }
+    }
+}
+
+// integer processing, zero suppression on the common mode corrected fixed
+// point data, then only the hits are converted to float, the other channels
+// are converted on request, see ConvertCorrectedFrame()
+// average > noise * threshold is sum > noise * threshold * time samples in
+// fixed point, see updateFixedPoint()
+template<uint32_t NTS>
+void GEMAPV::findZeroSupHitsFix()
+{
+    const uint32_t nts = NTS ? NTS : time_samples;
+    const int16_t *data = &raw_fix[ts_begin];
+    float *fdata = &raw_data[ts_begin];
+    const float scale = 1.f / (1 << APV_FIX_SHIFT);
+
+    for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
+    {
+        int32_t sum = 0;
+        for(uint32_t j = 0; j < nts; ++j)
+        {
+            sum += data[i + j*MPD_APV_TS_LEN];
+        }
+
+        hit_pos[i] = sum > zs_thres_fix[i];
+    }
+
+    for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
+    {
+        if(!hit_pos[i])
+            continue;
+
+        for(uint32_t j = 0; j < nts; ++j)
+        {
+            fdata[i + j*MPD_APV_TS_LEN] = data[i + j*MPD_APV_TS_LEN] * scale;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// choose the kernels for the current time samples, called when the number of
+// time samples is set, ssp firmware always has 6 (SSP_TIME_SAMPLE)
+
+#define SELECT_APV_KERNELS(n) \
+    fill_ped_kernel = &GEMAPV::fillPedHist<n>; \
+    find_hits_kernel = &GEMAPV::findZeroSupHits<n>; \
+    collect_hits_kernel = &GEMAPV::collectZeroSupHits<n>; \
+    find_hits_fix_kernel = &GEMAPV::findZeroSupHitsFix<n>
+
+void GEMAPV::selectKernels()
+{
+    switch(time_samples)
+    {
+    case 3: SELECT_APV_KERNELS(3); break;
+    case 6: SELECT_APV_KERNELS(6); break;
+    case 9: SELECT_APV_KERNELS(9); break;
+    case 12: SELECT_APV_KERNELS(12); break;
+    default: SELECT_APV_KERNELS(0); break;
+    }
+}
+
+#undef SELECT_APV_KERNELS
+
+////////////////////////////////////////////////////////////////////////////////
+// fixed point pedestal, common mode and zero suppression thresholds, updated
+// when any of their inputs changes
+
+void GEMAPV::updateFixedPoint()
+{
+    const double scale = 1 << APV_FIX_SHIFT;
+
+    for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
+    {
+        ped_offset_fix[i] = saturate_fix32(std::round(pedestal[i].offset * scale));
+#ifdef DANNING_ALGORITHM
+        cm_thres_fix[i] = saturate_fix32(std::round(DANNING_ALGORITHM_RMS_THRESHOLD
+                    * pedestal[i].noise * scale));
+#endif
+        zs_thres_fix[i] = saturate_fix32(std::floor(static_cast<double>(pedestal[i].noise)
+                    * zerosup_thres * scale * time_samples));
+    }
+
+    cm_min_fix = saturate_fix32(std::ceil(common_mode_range_min * scale));
+    cm_max_fix = saturate_fix32(std::floor(common_mode_range_max * scale));
+
+    fix_valid = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// integer processing only converts the hits to float in ZeroSuppression(),
+// convert the whole common mode corrected frame for the callers that also
+// read the other channels
+
+void GEMAPV::ConvertCorrectedFrame()
+{
+    if(!fix_corrected)
+        return;
+
+    const float scale = 1.f / (1 << APV_FIX_SHIFT);
+    for(uint32_t j = 0; j < time_samples; ++j)
+    {
+        for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
+        {
+            uint32_t idx = DATA_INDEX(i, j);
+            raw_data[idx] = raw_fix[idx] * scale;
+        }
+    }
+
+    fix_corrected = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// convert the fixed point frame back to float (raw adc values)
+// only for a raw frame, the frame is consumed by the zero suppression
+
+void GEMAPV::convertFixFrame()
+{
+    if(!fix_frame)
+        return;
+
+    for(size_t i = 0; i < raw_fix.size(); ++i)
+        raw_data[i] = static_cast<float>(raw_fix[i]);
+
+    fix_frame = false;
+
+    fix_corrected = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// integer version of CommonModeCorrection() (DANNING_ALGORITHM) for one time
+// sample, the input is the raw adc, the output is in fixed point
+// the loops have no branches, so the compiler can vectorize them
+
+void GEMAPV::commonModeCorrectionFix(int16_t *buf)
+{
+    // pedestal subtraction
+    if(!online_zero_suppression || TEST_BIT(raw_data_flags, OnlineBuildAllSamples))
+    {
+        for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
+            buf[i] = saturate_fix((static_cast<int32_t>(buf[i]) << APV_FIX_SHIFT) - ped_offset_fix[i]);
+    }
+    else
+    {
+        for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
+            buf[i] = static_cast<int16_t>(buf[i] * (1 << APV_FIX_SHIFT));
+    }
+
+    lastCommonMode = 0.;
+    if(online_zero_suppression && TEST_BIT(raw_data_flags, OnlineCommonModeSubtractionEnabled))
+        return;
+
+#ifdef DANNING_ALGORITHM
+    // 1) average A within the common mode range
+    int32_t sum = 0, count = 0;
+    for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
+    {
+        int32_t v = buf[i];
+        int32_t in = (v >= cm_min_fix) & (v <= cm_max_fix);
+        sum += v * in;
+        count += in;
+    }
+
+    if(count == 0)
+        return;
+
+    // 2) average B, v < A + thres is v - thres < ceil(A) for integer v
+    int32_t average_a = static_cast<int32_t>(std::ceil(static_cast<double>(sum) / count));
+    sum = 0;
+    count = 0;
+    for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
+    {
+        int32_t v = buf[i];
+        int32_t in = (v - cm_thres_fix[i]) < average_a;
+        sum += v * in;
+        count += in;
+    }
+
+    if(count == 0)
+        return;
+
+    double average = static_cast<double>(sum) / count;
+    int32_t average_fix = static_cast<int32_t>(std::lround(average));
+    for(uint32_t i = 0; i < APV_STRIP_SIZE; ++i)
+        buf[i] = saturate_fix(buf[i] - average_fix);
+
+    lastCommonMode = static_cast<float>(average / (1 << APV_FIX_SHIFT));
+#endif
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Build strip map
 // both local strip map and plane strip map are related to the connected plane
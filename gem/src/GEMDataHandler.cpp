@@ -3,14 +3,19 @@
 #include "GEMException.h"
 #include "MPDVMERawEventDecoder.h"
 #include "MPDSSPRawEventDecoder.h"
+#include "Fadc250Decoder.h"
 #include "RolStruct.h"
 #include "GEMRootHitTree.h"
 #include "GEMRootClusterTree.h"
+#include "GEMNativeHitFile.h"
+#include "PreAnalysis.h"
 #include "APVStripMapping.h"
 #include "hardcode.h"
 
 #include <iostream>
 #include <chrono>
+#include <algorithm>
+#include <sys/stat.h>
 
 ////////////////////////////////////////////////////////////////////////////////
 // ctor
@@ -40,6 +45,7 @@ GEMDataHandler::GEMDataHandler(const GEMDataHandler &that)
 GEMDataHandler::GEMDataHandler(GEMDataHandler &&that)
     : evio_reader(nullptr), event_parser(nullptr), 
     gem_sys(nullptr), event_data(std::move(that.event_data)),
+    fEventBufferCapacity(that.fEventBufferCapacity),
     new_event(new EventData(std::move(*that.new_event))),
     proc_event(new EventData(std::move(*that.proc_event))),
     root_hit_tree(nullptr)
@@ -106,7 +112,11 @@ void GEMDataHandler::Decode([[maybe_unused]]const void *buffer)
 void GEMDataHandler::ReplayEvent_test(const uint32_t *pBuf, const uint32_t &fBufLen, 
         const int &ev_number)
 {
+    GEMReplayStats::clock::time_point t0 = GEMReplayStats::Now();
+    uint64_t decode_ns = event_parser -> GetDecodeTime();
     event_parser -> ParseEvent(pBuf, fBufLen);
+    GEMReplayStats::clock::time_point t1 = GEMReplayStats::Now();
+    decode_ns = event_parser -> GetDecodeTime() - decode_ns;
 #ifdef USE_VME
     MPDVMERawEventDecoder* decoder = dynamic_cast<MPDVMERawEventDecoder*>(
             event_parser->GetRawDecoder(static_cast<int>(Bank_TagID::MPD_VME)) 
@@ -121,6 +131,20 @@ void GEMDataHandler::ReplayEvent_test(const uint32_t *pBuf, const uint32_t &fBuf
     const std::unordered_map<APVAddress, uint32_t> & decoded_data_flags
         = decoder -> GetAPVDataFlags();
 
+    // fadc250 banks from the same parse, swapped into the event, the decoder
+    // gets recycled buffers back
+    if(fadc_decoder != nullptr) {
+        for(size_t i=0; i<fadc_decoder -> GetNDecodedEvents(); i++)
+            new_event -> add_fadc_event(fadc_decoder -> GetDecodedEvent(i));
+    }
+
+    // parse time excludes the raw decoders
+    GEMReplayStats::clock::time_point t2 = GEMReplayStats::Now();
+    uint64_t parse_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+    fStats.AddNanoseconds(ReplayStage::Parse, parse_ns > decode_ns ? parse_ns - decode_ns : 0);
+    fStats.AddNanoseconds(ReplayStage::Decode, decode_ns +
+            std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+
 #ifdef MULTI_THREAD
     const auto & apvs = apv_strip_mapping::Mapping::Instance() -> GetAPVAddressVec();
 
@@ -162,6 +186,7 @@ void GEMDataHandler::ReplayEvent_test(const uint32_t *pBuf, const uint32_t &fBuf
         FeedDataMPD(i.first, i.second, decoded_data_flags.at(i.first));
     }
 #endif
+    fStats.Add(ReplayStage::ZeroSup, t2, GEMReplayStats::Now());
 
     EndofThisEvent(ev_number);
 }
@@ -169,9 +194,11 @@ void GEMDataHandler::ReplayEvent_test(const uint32_t *pBuf, const uint32_t &fBuf
 ////////////////////////////////////////////////////////////////////////////////
 // read from single evio file
 
-int GEMDataHandler::ReadFromEvio(const std::string &path, [[maybe_unused]]int split, 
+int GEMDataHandler::ReadFromEvio(const std::string &path, int split, 
         [[maybe_unused]]bool verbose)
 {
+    fProgress.split = split;
+
     // open evio file
     if(evio_reader != nullptr) {
         evio_reader->CloseFile();
@@ -181,7 +208,9 @@ int GEMDataHandler::ReadFromEvio(const std::string &path, [[maybe_unused]]int sp
     evio_reader -> SetFile(path.c_str());
 
     // open evio file
+    GEMReplayStats::clock::time_point t_open = GEMReplayStats::Now();
     bool status = evio_reader -> OpenFile();
+    fStats.Add(ReplayStage::Read, t_open, GEMReplayStats::Now());
     // failed openning file
     if(!status) {
         std::cout<<"Skipped file: "<<path<<std::endl;
@@ -193,6 +222,7 @@ int GEMDataHandler::ReadFromEvio(const std::string &path, [[maybe_unused]]int sp
         event_parser -> Reset();
     else
         event_parser = new EventParser();
+    event_parser -> SetDecodeTiming(true);
 #ifdef USE_VME
     // setup raw event decoder
     if(mpd_vme_decoder == nullptr) {
@@ -210,24 +240,38 @@ int GEMDataHandler::ReadFromEvio(const std::string &path, [[maybe_unused]]int sp
         event_parser -> RegisterRawDecoder(static_cast<int>(Bank_TagID::MPD_SSP), mpd_ssp_decoder);
     }
 #endif
+    // other detectors decoded in the same pass
+    registerRawDecoders();
 
     // parse event
     int count = 0;
     const uint32_t *pBuf;
     uint32_t fBufLen;
+    GEMReplayStats::clock::time_point t0 = GEMReplayStats::Now();
     while(evio_reader -> ReadNoCopy(&pBuf, &fBufLen) == S_SUCCESS)
     {
+        fStats.Add(ReplayStage::Read, t0, GEMReplayStats::Now());
+        fStats.AddBytes(fBufLen * sizeof(uint32_t));
+
         count++; // event number in current split evio file
 
         fEventNumber++; // event number in current run
 
         ReplayEvent_test(pBuf, fBufLen, fEventNumber);
 
+        fBytesRead += fBufLen * sizeof(uint32_t);
+        if(++fProgress.events % fProgressInterval == 0)
+            reportProgress();
+        if(bCancel)
+            break;
+
         if(pedestalMode)
         {
             if(fEventNumber > 5000) // pedestal mode only need 5000 events
                 break;
         }
+
+        t0 = GEMReplayStats::Now();
     }
 
     // wait for end process
@@ -236,40 +280,220 @@ int GEMDataHandler::ReadFromEvio(const std::string &path, [[maybe_unused]]int sp
     return count;
 } 
 
+////////////////////////////////////////////////////////////////////////////////
+// register another raw decoder, all decoders work on the same event parsing
+
+void GEMDataHandler::RegisterRawDecoder(int tag, AbstractRawDecoder *decoder)
+{
+    vRawDecoders.emplace_back(tag, decoder);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// register fadc and user decoders to the event parser if not yet
+
+void GEMDataHandler::registerRawDecoders()
+{
+    if(bFadcDecoding) {
+        if(fadc_decoder == nullptr)
+            fadc_decoder = new fdec::Fadc250Decoder();
+        if(event_parser -> GetRawDecoder(static_cast<int>(Bank_TagID::FADC)) == nullptr)
+            event_parser -> RegisterRawDecoder(static_cast<int>(Bank_TagID::FADC), fadc_decoder);
+    }
+
+    for(auto &i: vRawDecoders)
+    {
+        if(event_parser -> GetRawDecoder(i.first) == nullptr)
+            event_parser -> RegisterRawDecoder(i.first, i.second);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// read from a zero suppressed skim file (native hit file written in replay mode)
+// the strips are fed back to gem system through FillZeroSupData, no raw frame
+// decoding, pedestal subtraction or zero suppression is needed
+
+int GEMDataHandler::ReadFromSkim(const std::string &path)
+{
+    GEMNativeHitReader reader;
+    if(!reader.Open(path.c_str())) {
+        std::cout<<"Skipped file: "<<path<<std::endl;
+        return 0;
+    }
+
+    int count = 0;
+    fTotalEvents = reader.GetEntries();
+    uint32_t nts = reader.GetTimeSamples();
+    std::vector<GEMZeroSupData> data_pack;
+    NativeHitEvent ev;
+
+    for(uint64_t i=0; i<reader.GetEntries(); i++)
+    {
+        GEMReplayStats::clock::time_point t0 = GEMReplayStats::Now();
+        if(!reader.GetEvent(i, ev))
+            break;
+
+        data_pack.clear();
+        for(uint32_t k=0; k<ev.nch; k++)
+        {
+            GEMChannelAddress a = ev.Address(k);
+            GEMZeroSupData data;
+            data.addr = APVAddress(a.crate, a.mpd, a.adc);
+            data.channel = a.strip;
+            for(uint32_t ts=0; ts<nts; ts++) {
+                data.time_sample = ts;
+                data.adc_value = ev.ADC(k, ts);
+                data_pack.push_back(data);
+            }
+        }
+        fStats.Add(ReplayStage::Read, t0, GEMReplayStats::Now());
+
+        // the end process (clustering) works on the same APVs,
+        // it must finish before feeding the next event
+        waitEventProcess();
+        GEMReplayStats::clock::time_point t1 = GEMReplayStats::Now();
+        FeedData(data_pack);
+        fStats.Add(ReplayStage::ZeroSup, t1, GEMReplayStats::Now());
+
+        count++;
+        fEventNumber = ev.evtID;
+        EndofThisEvent(ev.evtID);
+
+        if(++fProgress.events % fProgressInterval == 0)
+            reportProgress();
+        if(bCancel)
+            break;
+    }
+
+    // wait for end process
+    waitEventProcess();
+
+    return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// check if the input file is a skim file
+
+bool GEMDataHandler::IsSkimFile(const std::string &path)
+{
+    const std::string suffix = ".gemhit";
+    return path.size() > suffix.size() &&
+        path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // read from splitted evio file
 
 int GEMDataHandler::ReadFromSplitEvio(const std::string &path, int split_start, 
         int split_end, bool verbose)
 {
+    if(IsSkimFile(path)) // skim files are not splitted
+        return ReadFromSkim(path);
+
     if(split_end < 0) { // default input, no split
         return ReadFromEvio(path.c_str(), -1, verbose);
     } else {
         int count = 0;
-        for(int i=split_start;i<split_end;i++)
+        for(int i=split_start;i<split_end && !bCancel;i++)
         {
             // parse all input files
-            size_t pos = 0;
-            if(path.find("evio") != std::string::npos) {
-                pos = path.find("evio") + 4;
-            }
-            else if(path.find("dat") != std::string::npos) {
-                pos = path.find("dat") + 3;
-            }
-            else 
+            std::string split_path = GetSplitFileName(path, i);
+            if(split_path.empty())
             {
                 std::cout<<__func__<<" Error: only evio/dat files are accepted."
                          <<path << std::endl;
                 return count;
             }
-            std::string split_path = path.substr(0, pos);
-            split_path = split_path + "." + std::to_string(i);
-            count += ReadFromEvio(split_path.c_str(), -1, verbose);
+            count += ReadFromEvio(split_path.c_str(), i, verbose);
         }
         return count;
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// get file name of a split: xxx.evio.N, return empty string if the input
+// is not an evio/dat file
+
+std::string GEMDataHandler::GetSplitFileName(const std::string &path, int split)
+{
+    size_t pos = 0;
+    if(path.find("evio") != std::string::npos) {
+        pos = path.find("evio") + 4;
+    }
+    else if(path.find("dat") != std::string::npos) {
+        pos = path.find("dat") + 3;
+    }
+    else {
+        return std::string();
+    }
+
+    return path.substr(0, pos) + "." + std::to_string(split);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// reset progress, the total size of input files is used to estimate
+// the fraction done
+
+void GEMDataHandler::initProgress(const std::string &path, int split_start, int split_end)
+{
+    fProgress = ReplayProgress();
+    fProgress.split_start = split_start;
+    fProgress.split_end = split_end;
+    fReplayStart = std::chrono::steady_clock::now();
+    fBytesRead = 0;
+    fTotalBytes = 0;
+    fTotalEvents = 0;
+    fStats.Start();
+
+    auto file_size = [](const std::string &f) -> uint64_t
+    {
+        struct stat st;
+        if(stat(f.c_str(), &st) != 0)
+            return 0;
+        return static_cast<uint64_t>(st.st_size);
+    };
+
+    if(pedestalMode) {
+        // pedestal mode stops after 5000 events
+        fTotalEvents = 5000;
+    }
+    else if(IsSkimFile(path)) {
+        // number of events set when the skim is opened
+    }
+    else if(split_end < 0) {
+        fTotalBytes = file_size(path);
+    }
+    else {
+        for(int i=split_start; i<split_end; i++)
+            fTotalBytes += file_size(GetSplitFileName(path, i));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// report progress through the callback
+
+void GEMDataHandler::reportProgress(bool finished)
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    fProgress.elapsed = std::chrono::duration<double>(now - fReplayStart).count();
+    fProgress.rate = fProgress.elapsed > 0. ? fProgress.events / fProgress.elapsed : 0.;
+
+    if(fTotalEvents > 0)
+        fProgress.fraction = std::min(1., static_cast<double>(fProgress.events) / fTotalEvents);
+    else if(fTotalBytes > 0)
+        fProgress.fraction = std::min(1., static_cast<double>(fBytesRead) / fTotalBytes);
+
+    if(finished)
+        fProgress.eta = 0.;
+    else if(fProgress.fraction > 0.)
+        fProgress.eta = fProgress.elapsed * (1. - fProgress.fraction) / fProgress.fraction;
+
+    fProgress.finished = finished;
+    fProgress.cancelled = bCancel;
+
+    if(progress_callback)
+        progress_callback(fProgress);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // replay the raw data file, do zero suppression and save it to root format
 
@@ -284,11 +508,15 @@ void GEMDataHandler::Replay(const std::string &r_path, int split_start, int spli
 
     // set mode before work starts
     SetMode();
+    initProgress(r_path, split_start, split_end);
 
     if(replayMode) {
-        std::cout<<"INFO::Loading pedestal from : "<<_pedestal_input<<std::endl;
-        std::cout<<"INFO::Loading common mode from : "<<_common_mode_input<<std::endl;
-        gem_sys -> ReadPedestalFile(_pedestal_input, _common_mode_input);
+        // skim files are already zero suppressed, no pedestal needed
+        if(!IsSkimFile(r_path)) {
+            std::cout<<"INFO::Loading pedestal from : "<<_pedestal_input<<std::endl;
+            std::cout<<"INFO::Loading common mode from : "<<_common_mode_input<<std::endl;
+            gem_sys -> ReadPedestalFile(_pedestal_input, _common_mode_input);
+        }
         // parse output path
         //replay_hit_output_file = ParseOutputFileName(r_path, "Rootfiles/hit_"+std::to_string(split_start));
         //replay_cluster_output_file = ParseOutputFileName(r_path, "Rootfiles/cluster_"+std::to_string(split_start));
@@ -310,17 +538,26 @@ void GEMDataHandler::Replay(const std::string &r_path, int split_start, int spli
 
     int count = ReadFromSplitEvio(r_path, split_start, split_end);
 
+    GEMReplayStats::clock::time_point write_begin = GEMReplayStats::Now();
     if(replayMode) {
         // save replay root tree
         if(!bReplayCluster) {
             if(root_hit_tree != nullptr)
                 root_hit_tree -> Write();    // gem hit tree
+            if(native_hit_writer != nullptr) {
+                native_hit_writer -> Write();// native hit file
+                // the root hit tree saves these plots in its Write()
+                PreAnalysis::Instance()->SavePlots();
+            }
         }
         else {
             if(root_cluster_tree != nullptr)
                 root_cluster_tree -> Write();// gem cluster tree
         }
     }
+    else if(pedestalMode && bCancel) {
+        std::cout<<"Pedestal cancelled, pedestal file is not saved."<<std::endl;
+    }
     else if(pedestalMode) {
         // save pedestal
         gem_sys -> FitPedestal();
@@ -330,12 +567,22 @@ void GEMDataHandler::Replay(const std::string &r_path, int split_start, int spli
         std::cout<<"saving commonMode file to : "<<commonMode_output_file<<std::endl;
         gem_sys -> SaveCommonModeRange(commonMode_output_file.c_str());
     }
+    fStats.Add(ReplayStage::Write, write_begin, GEMReplayStats::Now());
+    fStats.Stop();
 
     // get time end
     std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
     int _t = (int)std::chrono::duration_cast<std::chrono::seconds>(end - begin).count();
     std::cout<<"Replayed "<<count<<" events";
     std::cout<<" in "<< _t/60 <<" minutes "<<_t%60 <<" seconds"<<std::endl;
+    if(bCancel)
+        std::cout<<"Replay was cancelled, output saved up to the last event."<<std::endl;
+
+    fStats.Print(std::cout);
+    if(!fStatsOutput.empty() && fStats.WriteSummary(fStatsOutput))
+        std::cout<<"Replay stats saved to : "<<fStatsOutput<<std::endl;
+
+    reportProgress(true);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -344,7 +591,7 @@ void GEMDataHandler::Replay(const std::string &r_path, int split_start, int spli
 void GEMDataHandler::Clear()
 {
     // used memory won't be released, but it can be used again for new data file
-    event_data = std::deque<EventData>();
+    event_data.Clear();
     event_parser -> SetEventNumber(0);
 
     if(gem_sys)
@@ -369,11 +616,15 @@ void GEMDataHandler::EndofThisEvent(const int &ev)
     // wait for the process thread
     waitEventProcess();
 
+    // the process thread is joined, its stage timing can be sampled
+    fStats.AddEvent();
+
     // swap pointers
     EventData *tmp = new_event;
     new_event = proc_event;
     proc_event = tmp;
 
+    bProcessBusy = true;
     end_thread = std::thread(&GEMDataHandler::EndProcess, this, proc_event);
 }
 
@@ -383,8 +634,15 @@ void GEMDataHandler::EndofThisEvent(const int &ev)
 
 inline void GEMDataHandler::waitEventProcess()
 {
-    if(end_thread.joinable())
-        end_thread.join();
+    if(!end_thread.joinable())
+        return;
+
+    // double buffered, the queue holds at most one event in process
+    fStats.AddQueue(bProcessBusy ? 1 : 0, 1);
+
+    GEMReplayStats::clock::time_point begin = GEMReplayStats::Now();
+    end_thread.join();
+    fStats.Add(ReplayStage::Wait, begin, GEMReplayStats::Now());
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -392,34 +650,69 @@ inline void GEMDataHandler::waitEventProcess()
 
 void GEMDataHandler::EndProcess(EventData *ev)
 {
+    GEMReplayStats::clock::time_point begin = GEMReplayStats::Now();
+    uint64_t cluster_ns = 0;
+
     FillHistograms(*ev);
 
-    // online mode only saves the last event, to reduce usage of memory
-    if(onlineMode && event_data.size())
-        event_data.pop_front();
+    // reconstruct clusters before the callback, so it can also use them
+    if(replayMode && bReplayCluster) {
+        GEMReplayStats::clock::time_point t0 = GEMReplayStats::Now();
+        gem_sys -> Reconstruct(*ev);
+        cluster_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                GEMReplayStats::Now() - t0).count();
+        fStats.AddNanoseconds(ReplayStage::Cluster, cluster_ns);
+    }
+
+    if(event_callback)
+        event_callback(*ev);
 
     if(replayMode) {
-        if(root_hit_tree == nullptr && !bReplayCluster) {
+        if(!bReplayCluster && bNativeHitOutput && native_hit_writer == nullptr) {
+            // Rootfiles/hit_xxx.root -> Rootfiles/hit_xxx.gemhit
+            std::string path = replay_hit_output_file;
+            if(path.size() >= 4 && path.substr(path.size() - 4) == "root")
+                path = path.substr(0, path.size() - 4);
+            path += "gemhit";
+            uint32_t ts = 6;
+            auto apvs = gem_sys -> GetAPVList();
+            if(apvs.size() > 0)
+                ts = apvs[0] -> GetNTimeSamples();
+            native_hit_writer = new GEMNativeHitWriter(path.c_str(), ts, bNativeHitCompress);
+        }
+        if(root_hit_tree == nullptr && !bReplayCluster && !bNativeHitOutput) {
             root_hit_tree = new GEMRootHitTree(replay_hit_output_file.c_str());
         }
         if(root_cluster_tree == nullptr && bReplayCluster) {
             root_cluster_tree = new GEMRootClusterTree(replay_cluster_output_file.c_str());
         }
 
-        if(!bReplayCluster)
-            root_hit_tree -> Fill(gem_sys, *ev);
+        if(!bReplayCluster) {
+            if(bNativeHitOutput) {
+                native_hit_writer -> Fill(gem_sys, *ev);
+                // the root hit tree updates pre-analysis in its Fill()
+                PreAnalysis::Instance()->UpdateEvent(*ev);
+            }
+            else
+                root_hit_tree -> Fill(gem_sys, *ev);
+        }
         else {
-            // reconstruct clusters
-            gem_sys -> Reconstruct(*ev);
             // cluster tree will use gem_sys to extract cluster information
             root_cluster_tree -> Fill(gem_sys, (*ev).event_number);
         }
     }
     else {
-        event_data.emplace_back(std::move(*ev)); // save event
+        // save event, ev gets the buffers of the overwritten one
+        event_data.Push(*ev);
     }
 
     ev->Clear();
+
+    // everything except clustering is counted as filling
+    uint64_t total_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            GEMReplayStats::Now() - begin).count();
+    fStats.AddNanoseconds(ReplayStage::Fill, total_ns > cluster_ns ? total_ns - cluster_ns : 0);
+    bProcessBusy = false;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -467,13 +760,13 @@ void GEMDataHandler::FeedData(const std::vector<GEMZeroSupData> &gemData)
 const EventData &GEMDataHandler::GetEvent(const unsigned int &index)
     const
 {
-    if(!event_data.size())
+    if(event_data.Empty())
         throw GEMException("Data Handler Error", "Empty data bank!");
 
-    if(index >= event_data.size()) {
-        return event_data.back();
+    if(index >= event_data.Size()) {
+        return event_data.Back();
     } else {
-        return event_data.at(index);
+        return event_data.At(index);
     }
 }
 
@@ -505,6 +798,12 @@ void GEMDataHandler::SetMode()
 
     else if(gem_sys->GetReplayMode())
         SetReplayMode(true);
+
+    // online mode only saves the last event, to reduce usage of memory
+    if(fEventBufferCapacity > 0)
+        event_data.SetCapacity(fEventBufferCapacity);
+    else
+        event_data.SetCapacity(onlineMode ? 1 : GEM_EVENT_RING_CAPACITY);
 }
 
 
@@ -527,6 +826,11 @@ void GEMDataHandler::Reset()
         delete root_cluster_tree;
         root_cluster_tree = nullptr;
     }
+
+    if(native_hit_writer != nullptr) {
+        delete native_hit_writer;
+        native_hit_writer = nullptr;
+    }
 } 
 
 
@@ -534,6 +838,7 @@ void GEMDataHandler::Reset()
 // automatically generate output file name (based on input file name)
 // input file name: xxxx_235.evio.0
 //                  xxxx_235.dat.0
+//                  xxxx_235.gemhit (skim)
 
 std::string GEMDataHandler::ParseOutputFileName(const std::string &input, const char* prefix)
 {
@@ -542,6 +847,9 @@ std::string GEMDataHandler::ParseOutputFileName(const std::string &input, const
     if( input.find("evio") != std::string::npos) {
         pos_start = input.find("evio");
     }
+    else if(IsSkimFile(input)) {
+        pos_start = input.rfind("gemhit");
+    }
     else if(input.find("dat") != std::string::npos) {
         pos_start = input.find("dat");
     }
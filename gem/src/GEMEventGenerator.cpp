@@ -0,0 +1,675 @@
+#include "GEMEventGenerator.h"
+#include "GEMDataHandler.h"
+#include "EvioFileWriter.h"
+#include "RolStruct.h"
+#include "MPDSSPRawEventDecoder.h"
+#include "MPDVMERawEventDecoder.h"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <cctype>
+#include <map>
+
+#define EVIO_BANK_TYPE 0x10
+#define EVIO_UINT32_TYPE 0x1
+#define EVENT_TAG 1
+
+#define APV_SAMPLE_PERIOD 25.  // ns
+#define APV_SHAPING_TIME 50.   // ns
+#define VME_ADC_MAX 4095
+#define SSP_ADC_MIN -4096
+#define SSP_ADC_MAX 4095
+
+////////////////////////////////////////////////////////////////////////////////
+// ctor
+
+GEMEventGenerator::GEMEventGenerator(const std::string &map_file, uint32_t seed)
+: fGen(seed), fSeed(seed)
+{
+    loadMap(map_file);
+    initAPVs();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// read apvs and layers from the mapping file, the same format as
+// apv_strip_mapping::Mapping::LoadMap(), but no config file needed
+
+void GEMEventGenerator::loadMap(const std::string &path)
+{
+    std::ifstream f(path);
+    if(!f.is_open()) {
+        std::cout<<__func__<<" Error: cannot open mapping file: "<<path<<std::endl;
+        return;
+    }
+
+    std::map<int, std::string> layer_type;
+    std::string line;
+    while(std::getline(f, line))
+    {
+        size_t begin = line.find_first_not_of(" \t");
+        if(begin == std::string::npos || line[begin] == '#')
+            continue;
+
+        std::string tmp = line.substr(begin);
+        if(tmp.compare(0, 5, "Layer") == 0) {
+            apv_strip_mapping::LayerInfo layer(tmp);
+            // remove white spaces of gem type
+            std::string type;
+            for(auto &c: layer.gem_type)
+                if(!std::isspace(static_cast<unsigned char>(c)))
+                    type += c;
+            layer_type[layer.layer_id] = type;
+        }
+        else if(tmp.compare(0, 3, "APV") == 0) {
+            vMapAPV.emplace_back(tmp);
+        }
+    }
+
+    for(auto &i: vMapAPV)
+    {
+        if(layer_type.find(i.layer_id) != layer_type.end())
+            vMapAPVType.push_back(layer_type[i.layer_id]);
+        else
+            vMapAPVType.push_back("");
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// use the first n apvs of the mapping file
+
+void GEMEventGenerator::SetAPVCount(int n)
+{
+    fMaxAPVs = n;
+    initAPVs();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// set strip noise level
+
+void GEMEventGenerator::SetNoise(double n)
+{
+    fNoise = n > 0 ? n : 0;
+    initAPVs();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// generate the pedestal of all apvs in use, the random sequence restarts
+// from the seed, so the pedestal only depends on the seed and settings
+
+void GEMEventGenerator::initAPVs()
+{
+    fGen.seed(fSeed);
+    bHasSpare = false;
+
+    size_t napvs = vMapAPV.size();
+    if(fMaxAPVs > 0 && static_cast<size_t>(fMaxAPVs) < napvs)
+        napvs = fMaxAPVs;
+
+    vAPV.clear();
+    vAPV.resize(napvs);
+    for(size_t i=0; i<napvs; i++)
+    {
+        APVState &apv = vAPV[i];
+        apv.info = vMapAPV[i];
+
+        auto it = apv_strip_mapping::mapped_strip_arr.find(vMapAPVType[i]);
+        apv.strip_map = (it == apv_strip_mapping::mapped_strip_arr.end()) ?
+            nullptr : it -> second;
+
+        for(int ch=0; ch<APV_STRIP_SIZE; ch++) {
+            int strip = apv.strip_map ? apv.strip_map[ch] : ch;
+            apv.channel[strip] = ch;
+        }
+
+        // strip offsets average to 0, the base line goes to common mode,
+        // the same as what GEMAPV::FillPedHist() gets for the offsets
+        float average = 0;
+        for(int ch=0; ch<APV_STRIP_SIZE; ch++) {
+            apv.offset[ch] = static_cast<float>(100. * (uniform() - 0.5));
+            apv.noise[ch] = static_cast<float>(fNoise * (0.8 + 0.4 * uniform()));
+            average += apv.offset[ch];
+        }
+        average /= APV_STRIP_SIZE;
+        for(int ch=0; ch<APV_STRIP_SIZE; ch++)
+            apv.offset[ch] -= average;
+
+        apv.common_mode = static_cast<float>(400. + 300. * uniform());
+    }
+
+    // data banks are organized by crate and mpd
+    std::stable_sort(vAPV.begin(), vAPV.end(), [](const APVState &a, const APVState &b)
+    {
+        if(a.info.crate_id != b.info.crate_id)
+            return a.info.crate_id < b.info.crate_id;
+        if(a.info.mpd_id != b.info.mpd_id)
+            return a.info.mpd_id < b.info.mpd_id;
+        return a.info.adc_ch < b.info.adc_ch;
+    });
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// number of time samples in the generated data
+
+int GEMEventGenerator::GetTimeSamples() const
+{
+    if(fReadout == MPDReadout::SSP)
+        return SSP_TIME_SAMPLE;
+    return fTimeSamples;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// apv data flags sent by ssp
+
+uint32_t GEMEventGenerator::GetAPVDataFlags() const
+{
+    if(fReadout != MPDReadout::SSP)
+        return 0;
+    if(bOnlineZeroSup)
+        return OnlineCommonModeSubtractionEnabled;
+    return OnlineBuildAllSamples;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// strip on the plane, the same as apv_strip_mapping::Mapping::GetStrip()
+
+int GEMEventGenerator::planeStrip(const APVState &apv, int local) const
+{
+    if(apv.info.invert)
+        local = APV_STRIP_SIZE - 1 - local;
+    return apv.info.apv_pos * APV_STRIP_SIZE + local;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// generate one event
+
+const std::vector<uint32_t> &GEMEventGenerator::GenerateEvent(int event_number)
+{
+    vEventBuf.clear();
+    vTruthCluster.clear();
+    vTruthStrip.clear();
+
+    size_t event_pos = openBank(EVENT_TAG, EVIO_BANK_TYPE);
+
+    size_t i = 0;
+    while(i < vAPV.size())
+    {
+        int crate = vAPV[i].info.crate_id;
+        size_t roc_pos = openBank(crate, EVIO_BANK_TYPE);
+        int tag = (fReadout == MPDReadout::SSP) ? static_cast<int>(Bank_TagID::MPD_SSP)
+            : static_cast<int>(Bank_TagID::MPD_VME);
+        size_t data_pos = openBank(tag, EVIO_UINT32_TYPE);
+
+        size_t crate_begin = vEventBuf.size();
+        beginCrate(event_number, crate);
+        while(i < vAPV.size() && vAPV[i].info.crate_id == crate)
+        {
+            int mpd = vAPV[i].info.mpd_id;
+            size_t mpd_begin = vEventBuf.size();
+            beginMPD(event_number, mpd);
+            for(; i < vAPV.size() && vAPV[i].info.crate_id == crate
+                    && vAPV[i].info.mpd_id == mpd; i++)
+            {
+                generateAPV(event_number, vAPV[i]);
+                encodeAPV(vAPV[i]);
+            }
+            endMPD(mpd, mpd_begin);
+        }
+        endCrate(crate, crate_begin);
+
+        closeBank(data_pos);
+        closeBank(roc_pos);
+    }
+
+    closeBank(event_pos);
+
+    return vEventBuf;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// generate raw data of one apv to vADC, with injected clusters
+
+void GEMEventGenerator::generateAPV(int event_number, const APVState &apv)
+{
+    int nts = GetTimeSamples();
+
+    vSignal.assign(nts * APV_STRIP_SIZE, 0.f);
+    vADC.resize(nts * APV_STRIP_SIZE);
+    vCommonMode.resize(nts);
+
+    int nclusters = poisson(fOccupancy);
+    for(int k=0; k<nclusters; k++)
+    {
+        double center = APV_STRIP_SIZE * uniform();
+        double amp = fAmpMin + (fAmpMax - fAmpMin) * uniform();
+        double t0 = 2. * APV_SAMPLE_PERIOD * uniform();
+
+        // strips within 3 sigma, clusters do not go across apvs
+        int first = std::max(0, static_cast<int>(std::ceil(center - 3. * fClusterWidth)));
+        int last = std::min(APV_STRIP_SIZE - 1,
+                static_cast<int>(std::floor(center + 3. * fClusterWidth)));
+
+        GEMTruthCluster cluster;
+        cluster.event = event_number;
+        cluster.apv = APVAddress(apv.info.crate_id, apv.info.mpd_id, apv.info.adc_ch);
+        cluster.layer_id = apv.info.layer_id;
+        cluster.detector_id = apv.info.detector_id;
+        cluster.dimension = apv.info.dimension;
+        cluster.center = static_cast<float>(apv.info.apv_pos * APV_STRIP_SIZE +
+                (apv.info.invert ? APV_STRIP_SIZE - 1 - center : center));
+        cluster.nstrips = last - first + 1;
+        cluster.amplitude = static_cast<float>(amp);
+        cluster.peak_time = static_cast<float>(t0 + APV_SHAPING_TIME);
+        int cluster_index = static_cast<int>(vTruthCluster.size());
+        vTruthCluster.push_back(cluster);
+
+        for(int s=first; s<=last; s++)
+        {
+            double d = (s - center) / fClusterWidth;
+            double strip_amp = amp * std::exp(-0.5 * d * d);
+
+            // apv25 cr-rc shaping, peaks at t0 + shaping time
+            float max_adc = 0;
+            for(int ts=0; ts<nts; ts++)
+            {
+                double x = (ts * APV_SAMPLE_PERIOD - t0) / APV_SHAPING_TIME;
+                if(x <= 0) continue;
+                float val = static_cast<float>(strip_amp * x * std::exp(1. - x));
+                vSignal[ts * APV_STRIP_SIZE + s] += val;
+                max_adc = std::max(max_adc, val);
+            }
+
+            GEMTruthStrip strip;
+            strip.event = event_number;
+            strip.apv = cluster.apv;
+            strip.ch = apv.channel[s];
+            strip.strip = planeStrip(apv, s);
+            strip.cluster = cluster_index;
+            strip.max_adc = max_adc;
+            vTruthStrip.push_back(strip);
+        }
+    }
+
+    for(int ts=0; ts<nts; ts++)
+    {
+        vCommonMode[ts] = static_cast<float>(apv.common_mode + fCommonModeShift * gaus());
+        for(int ch=0; ch<APV_STRIP_SIZE; ch++)
+        {
+            int s = apv.strip_map ? apv.strip_map[ch] : ch;
+            vADC[ts * APV_STRIP_SIZE + ch] = vCommonMode[ts] + apv.offset[ch]
+                + static_cast<float>(apv.noise[ch] * gaus())
+                + vSignal[ts * APV_STRIP_SIZE + s];
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// open an evio bank, return its position for closeBank()
+
+size_t GEMEventGenerator::openBank(int tag, uint32_t type)
+{
+    size_t pos = vEventBuf.size();
+    vEventBuf.push_back(0);
+    vEventBuf.push_back((static_cast<uint32_t>(tag) << 16) | (type << 8));
+    return pos;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// fill bank length (exclusive)
+
+void GEMEventGenerator::closeBank(size_t pos)
+{
+    vEventBuf[pos] = static_cast<uint32_t>(vEventBuf.size() - pos - 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ssp words are described in sspApvdec.h, vme words in MPDVMERawEventDecoder.h
+// only the fields used by the decoders are meaningful
+//
+// ssp: one block per crate, one mpd frame per mpd, 3 words per strip
+// vme: one block per mpd, one apv header per apv, 128 adc words and
+//      one apv trailer per time sample
+
+static inline uint32_t ssp_word(uint32_t type, uint32_t payload)
+{
+    return (1u << 31) | ((type & 0xf) << 27) | (payload & 0x7ffffff);
+}
+
+static inline uint32_t vme_word(MPD_VME_Raw_Data_Type type, uint32_t payload)
+{
+    return (static_cast<uint32_t>(type) << 21) | (payload & 0x1fffff);
+}
+
+static inline uint32_t vme_apv_word(APV_Ch_Data_Info info, uint32_t payload)
+{
+    return vme_word(MPD_VME_Raw_Data_Type::APV_Ch_Data,
+            (static_cast<uint32_t>(info) << 19) | (payload & 0x7ffff));
+}
+
+void GEMEventGenerator::beginCrate(int event_number, int crate)
+{
+    if(fReadout != MPDReadout::SSP)
+        return;
+
+    uint32_t slot = static_cast<uint32_t>(crate) & 0x1f;
+    uint32_t ev = static_cast<uint32_t>(event_number);
+    // block header: slot, module id, block number, 1 event in block
+    vEventBuf.push_back(ssp_word(0, (slot << 22) | ((ev & 0x3ff) << 8) | 1));
+    // event header: trigger number
+    vEventBuf.push_back(ssp_word(2, ev));
+    // trigger time, low and high 24 bits
+    uint64_t time = static_cast<uint64_t>(ev) * 10000;
+    vEventBuf.push_back(ssp_word(3, time & 0xffffff));
+    vEventBuf.push_back((time >> 24) & 0xffffff);
+}
+
+void GEMEventGenerator::endCrate(int crate, size_t begin)
+{
+    if(fReadout != MPDReadout::SSP)
+        return;
+
+    uint32_t slot = static_cast<uint32_t>(crate) & 0x1f;
+    uint32_t nwords = static_cast<uint32_t>(vEventBuf.size() - begin + 1);
+    vEventBuf.push_back(ssp_word(1, (slot << 22) | (nwords & 0x3fffff)));
+}
+
+void GEMEventGenerator::beginMPD(int event_number, int mpd)
+{
+    uint32_t id = static_cast<uint32_t>(mpd) & 0x1f;
+    if(fReadout == MPDReadout::SSP) {
+        // mpd frame: flags, fiber (decoded as mpd id), mpd id
+        vEventBuf.push_back(ssp_word(5, ((GetAPVDataFlags() & 0x3f) << 21)
+                    | (id << 16) | id));
+        return;
+    }
+
+    uint32_t ev = static_cast<uint32_t>(event_number);
+    vEventBuf.push_back(vme_word(MPD_VME_Raw_Data_Type::Block_Header, id << 16));
+    vEventBuf.push_back(vme_word(MPD_VME_Raw_Data_Type::Event_Header, (id << 16) | (ev & 0xffff)));
+    // coarse trigger time, high and low 20 bits
+    uint64_t time = static_cast<uint64_t>(ev) * 10000;
+    vEventBuf.push_back(vme_word(MPD_VME_Raw_Data_Type::Trigger_Time, (time >> 20) & 0xfffff));
+    vEventBuf.push_back(vme_word(MPD_VME_Raw_Data_Type::Trigger_Time,
+                (1 << 20) | (time & 0xfffff)));
+}
+
+void GEMEventGenerator::endMPD(int mpd, size_t begin)
+{
+    if(fReadout == MPDReadout::SSP)
+        return;
+
+    uint32_t id = static_cast<uint32_t>(mpd) & 0x1f;
+    // event trailer: leading bit 0, number of words, fine trigger time
+    uint32_t nwords = static_cast<uint32_t>(vEventBuf.size() - begin);
+    vEventBuf.push_back(vme_word(MPD_VME_Raw_Data_Type::Event_Trailer, (nwords & 0xfff) << 8));
+    vEventBuf.push_back(vme_word(MPD_VME_Raw_Data_Type::Block_Trailer, id << 16));
+}
+
+void GEMEventGenerator::encodeAPV(const APVState &apv)
+{
+    int nts = GetTimeSamples();
+    auto adc = [&](int ch, int ts) -> int
+    {
+        return static_cast<int>(std::lround(vADC[ts * APV_STRIP_SIZE + ch]));
+    };
+
+    if(fReadout == MPDReadout::VME)
+    {
+        vEventBuf.push_back(vme_apv_word(APV_Ch_Data_Info::APV_Header,
+                    static_cast<uint32_t>(apv.info.adc_ch) & 0xf));
+        for(int ts=0; ts<nts; ts++)
+        {
+            for(int ch=0; ch<APV_STRIP_SIZE; ch++) {
+                int val = std::min(std::max(adc(ch, ts), 0), VME_ADC_MAX);
+                vEventBuf.push_back(vme_apv_word(APV_Ch_Data_Info::ADC_Value,
+                            static_cast<uint32_t>(val)));
+            }
+            vEventBuf.push_back(vme_apv_word(APV_Ch_Data_Info::APV_Trailer,
+                        (static_cast<uint32_t>(ts) & 0xf) << 8));
+        }
+        vEventBuf.push_back(vme_apv_word(APV_Ch_Data_Info::Trailer, 0));
+        return;
+    }
+
+    int sample[SSP_TIME_SAMPLE];
+    for(int ch=0; ch<APV_STRIP_SIZE; ch++)
+    {
+        if(bOnlineZeroSup)
+        {
+            // firmware subtracts pedestal and common mode, and keeps strips
+            // with average above threshold
+            float average = 0;
+            for(int ts=0; ts<nts; ts++) {
+                float val = vADC[ts * APV_STRIP_SIZE + ch] - apv.offset[ch] - vCommonMode[ts];
+                sample[ts] = static_cast<int>(std::lround(val));
+                average += val;
+            }
+            if(average / nts <= fZeroSupThres * apv.noise[ch])
+                continue;
+        }
+        else
+        {
+            for(int ts=0; ts<nts; ts++)
+                sample[ts] = adc(ch, ts);
+        }
+
+        for(int ts=0; ts<nts; ts++)
+            sample[ts] = std::min(std::max(sample[ts], SSP_ADC_MIN), SSP_ADC_MAX) & 0x1fff;
+
+        uint32_t c = static_cast<uint32_t>(ch);
+        vEventBuf.push_back(((c & 0x1f) << 26) | (sample[1] << 13) | sample[0]);
+        vEventBuf.push_back((((c >> 5) & 0x3) << 26) | (sample[3] << 13) | sample[2]);
+        vEventBuf.push_back(((static_cast<uint32_t>(apv.info.adc_ch) & 0x1f) << 26)
+                | (sample[5] << 13) | sample[4]);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// generate events to evio file(s)
+
+int GEMEventGenerator::Generate(const std::string &path, int nevents, int events_per_split,
+        const std::string &truth_path)
+{
+    std::ofstream truth;
+    if(!truth_path.empty()) {
+        truth.open(truth_path);
+        if(!truth.is_open()) {
+            std::cout<<__func__<<" Error: cannot open truth file: "<<truth_path<<std::endl;
+            return 0;
+        }
+        WriteTruthHeader(truth);
+    }
+
+    EvioFileWriter writer;
+    int split = -1;
+    int count = 0;
+    for(int i=0; i<nevents; i++)
+    {
+        int current_split = (events_per_split > 0) ? i / events_per_split : 0;
+        if(current_split != split)
+        {
+            split = current_split;
+            std::string file = path;
+            if(events_per_split > 0) {
+                file = GEMDataHandler::GetSplitFileName(path, split);
+                if(file.empty()) {
+                    std::cout<<__func__<<" Error: only evio/dat files can be splitted: "
+                             <<path<<std::endl;
+                    return count;
+                }
+            }
+            writer.SetFile(file);
+            if(!writer.OpenFile())
+                return count;
+        }
+
+        // event number starts from 1, the same as GEMDataHandler
+        const std::vector<uint32_t> &buf = GenerateEvent(i + 1);
+        if(writer.Write(buf.data()) != S_SUCCESS) {
+            std::cout<<__func__<<" Error: failed writing event "<<i + 1<<std::endl;
+            break;
+        }
+        count++;
+
+        if(truth.is_open())
+            WriteTruth(truth);
+    }
+    writer.CloseFile();
+
+    return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// the same format as GEMAPV::PrintOutPedestal()
+
+bool GEMEventGenerator::WritePedestal(const std::string &path) const
+{
+    std::ofstream out(path);
+    if(!out.is_open()) {
+        std::cout<<__func__<<" Error: cannot open file: "<<path<<std::endl;
+        return false;
+    }
+
+    for(auto &apv: vAPV)
+    {
+        out << "APV "
+            << std::setw(16) << apv.info.crate_id
+            << std::setw(16) << apv.info.mpd_id
+            << std::setw(16) << apv.info.adc_ch
+            << std::endl;
+
+        for(int i=0; i<APV_STRIP_SIZE; ++i)
+        {
+            out << std::setw(16) << i
+                << std::setw(16) << std::setprecision(4) << apv.offset[i]
+                << std::setw(16) << std::setprecision(4) << apv.noise[i]
+                << std::endl;
+        }
+    }
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// the same format as GEMAPV::PrintOutCommonModeRange(), the range covers
+// 5 sigma of the common mode shift and strip noise
+
+bool GEMEventGenerator::WriteCommonModeRange(const std::string &path) const
+{
+    std::ofstream out(path);
+    if(!out.is_open()) {
+        std::cout<<__func__<<" Error: cannot open file: "<<path<<std::endl;
+        return false;
+    }
+
+    for(auto &apv: vAPV)
+    {
+        int max = static_cast<int>(apv.common_mode + 5. * (fCommonModeShift + 1.2 * fNoise));
+
+        out << std::setw(12) << apv.info.crate_id
+            << std::setw(12) << apv.info.mpd_id
+            << std::setw(12) << apv.info.adc_ch
+            << std::setw(12) << 0
+            << std::setw(12) << max
+            << std::endl;
+    }
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// truth file header, settings and record formats
+
+void GEMEventGenerator::WriteTruthHeader(std::ofstream &out) const
+{
+    out << "# GEMEventGenerator truth" << std::endl
+        << "# readout = " << (fReadout == MPDReadout::SSP ? "SSP" : "VME") << std::endl
+        << "# seed = " << fSeed << std::endl
+        << "# apvs = " << vAPV.size() << std::endl
+        << "# time samples = " << GetTimeSamples() << std::endl
+        << "# occupancy = " << fOccupancy << std::endl
+        << "# noise = " << fNoise << std::endl
+        << "# common mode shift = " << fCommonModeShift << std::endl
+        << "# cluster amplitude = " << fAmpMin << " " << fAmpMax << std::endl
+        << "# cluster width = " << fClusterWidth << std::endl
+        << "# online zero suppression = " << (bOnlineZeroSup ? "on " : "off ")
+        << fZeroSupThres << std::endl
+        << "# apv data flags = " << GetAPVDataFlags() << std::endl
+        << "#" << std::endl
+        << "# C event crate mpd adc layer detector dimension center nstrips amplitude peak_time"
+        << std::endl
+        << "# S event crate mpd adc ch strip cluster max_adc" << std::endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// truth of the last generated event
+
+void GEMEventGenerator::WriteTruth(std::ofstream &out) const
+{
+    for(auto &c: vTruthCluster)
+    {
+        out << "C " << c.event << " " << c.apv.crate_id << " " << c.apv.mpd_id
+            << " " << c.apv.adc_ch << " " << c.layer_id << " " << c.detector_id
+            << " " << c.dimension << " " << c.center << " " << c.nstrips
+            << " " << c.amplitude << " " << c.peak_time << "\n";
+    }
+
+    for(auto &s: vTruthStrip)
+    {
+        out << "S " << s.event << " " << s.apv.crate_id << " " << s.apv.mpd_id
+            << " " << s.apv.adc_ch << " " << s.ch << " " << s.strip
+            << " " << s.cluster << " " << s.max_adc << "\n";
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// uniform in (0, 1), from the raw mt19937 output
+
+double GEMEventGenerator::uniform()
+{
+    return (static_cast<double>(fGen()) + 0.5) / 4294967296.;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// standard normal, Marsaglia polar method
+
+double GEMEventGenerator::gaus()
+{
+    if(bHasSpare) {
+        bHasSpare = false;
+        return fSpare;
+    }
+
+    double u, v, s;
+    do {
+        u = 2. * uniform() - 1.;
+        v = 2. * uniform() - 1.;
+        s = u * u + v * v;
+    } while(s >= 1. || s == 0.);
+
+    s = std::sqrt(-2. * std::log(s) / s);
+    fSpare = v * s;
+    bHasSpare = true;
+
+    return u * s;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// poisson, Knuth's method (small mean only)
+
+int GEMEventGenerator::poisson(double mean)
+{
+    if(mean <= 0)
+        return 0;
+
+    double limit = std::exp(-mean);
+    double p = uniform();
+    int k = 0;
+    while(p > limit) {
+        p *= uniform();
+        k++;
+    }
+
+    return k;
+}
@@ -0,0 +1,86 @@
+#include "GEMEventRing.h"
+
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////
+// ctor
+
+GEMEventRing::GEMEventRing(size_t capacity)
+{
+    SetCapacity(capacity);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// set capacity, the newest events are kept
+
+void GEMEventRing::SetCapacity(size_t n)
+{
+    if(n < 1)
+        n = 1;
+    if(n == vSlots.size())
+        return;
+
+    size_t keep = fCount < n ? fCount : n;
+    std::vector<EventData> slots(n);
+    for(size_t i=0; i<keep; i++)
+        std::swap(slots[i], vSlots[(fHead + fCount - keep + i) % vSlots.size()]);
+
+    vSlots.swap(slots);
+    fHead = 0;
+    fCount = keep;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// add an event, overwrite the oldest one if full
+
+void GEMEventRing::Push(EventData &ev)
+{
+    if(fCount < vSlots.size()) {
+        std::swap(vSlots[(fHead + fCount) % vSlots.size()], ev);
+        fCount++;
+        return;
+    }
+
+    std::swap(vSlots[fHead], ev);
+    fHead = (fHead + 1) % vSlots.size();
+    fOverwritten++;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// remove the oldest event
+
+void GEMEventRing::PopFront()
+{
+    if(fCount == 0)
+        return;
+
+    vSlots[fHead].Clear();
+    fHead = (fHead + 1) % vSlots.size();
+    fCount--;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// remove all events, keep memory
+
+void GEMEventRing::Clear()
+{
+    for(size_t i=0; i<fCount; i++)
+        vSlots[(fHead + i) % vSlots.size()].Clear();
+
+    fHead = 0;
+    fCount = 0;
+    fOverwritten = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// remove all events, release memory
+
+void GEMEventRing::Release()
+{
+    std::vector<EventData> slots(vSlots.size());
+    vSlots.swap(slots);
+
+    fHead = 0;
+    fCount = 0;
+    fOverwritten = 0;
+}
@@ -0,0 +1,441 @@
+#include "GEMGoldenOutput.h"
+#include "GEMSystem.h"
+#include "GEMDetector.h"
+#include "GEMPlane.h"
+
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+////////////////////////////////////////////////////////////////////////////////
+// canonical order of strips and clusters
+
+static inline std::tuple<int, int, int, int> strip_key(const GEM_Strip_Data &s)
+{
+    return std::make_tuple(s.addr.crate, s.addr.mpd, s.addr.adc, s.addr.strip);
+}
+
+static inline std::tuple<int, int, int> plane_key(const GEMGoldenCluster &c)
+{
+    return std::make_tuple(c.det_id, c.layer_id, c.plane);
+}
+
+static std::string address_str(const GEMChannelAddress &a)
+{
+    std::ostringstream s;
+    s<<"crate "<<a.crate<<", mpd "<<a.mpd<<", adc "<<a.adc<<", strip "<<a.strip;
+    return s.str();
+}
+
+static std::string plane_str(const GEMGoldenCluster &c)
+{
+    std::ostringstream s;
+    s<<"det "<<c.det_id<<", layer "<<c.layer_id<<", plane "<<c.plane;
+    return s.str();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// copy the zero suppressed strips of an event
+
+void GEMGoldenEvent::CollectStrips(const EventData &ev)
+{
+    event_number = static_cast<int>(ev.event_number);
+    const GEMStripHits &hits = ev.get_gem_data();
+    strips.resize(hits.size());
+    for(size_t i=0; i<hits.size(); i++)
+        strips[i] = hits.strip(i);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// copy the strip clusters of all planes
+
+void GEMGoldenEvent::CollectClusters(GEMSystem *gem_sys)
+{
+    clusters.clear();
+
+    for(auto &det: gem_sys -> GetDetectorList())
+    {
+        for(auto &pln: det -> GetPlaneList())
+        {
+            if(pln == nullptr)
+                continue;
+
+            for(auto &c: pln -> GetStripClusters())
+            {
+                GEMGoldenCluster g;
+                g.det_id = det -> GetDetID();
+                g.layer_id = det -> GetLayerID();
+                g.plane = static_cast<int>(pln -> GetType());
+                g.position = c.position;
+                g.peak_charge = c.peak_charge;
+                g.total_charge = c.total_charge;
+                g.cross_talk = c.cross_talk;
+                for(auto &h: c.hits) {
+                    g.strips.push_back(h.strip);
+                    g.charges.push_back(h.charge);
+                }
+                clusters.push_back(std::move(g));
+            }
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// sort strips by address and clusters by plane and position
+
+void GEMGoldenEvent::Sort()
+{
+    std::sort(strips.begin(), strips.end(),
+            [](const GEM_Strip_Data &a, const GEM_Strip_Data &b)
+            {return strip_key(a) < strip_key(b);});
+
+    std::sort(clusters.begin(), clusters.end(),
+            [](const GEMGoldenCluster &a, const GEMGoldenCluster &b)
+            {
+                if(plane_key(a) != plane_key(b))
+                    return plane_key(a) < plane_key(b);
+                return a.position < b.position;
+            });
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ctor
+
+GEMGoldenFile::GEMGoldenFile()
+{
+    // place holder
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// dtor
+
+GEMGoldenFile::~GEMGoldenFile()
+{
+    Close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// open a golden file for writing
+
+bool GEMGoldenFile::OpenWrite(const std::string &path)
+{
+    Close();
+
+    fPath = path;
+    fOut.open(path);
+    if(!fOut.is_open()) {
+        std::cout<<__func__<<" Error: cannot open golden file: "<<path<<std::endl;
+        return false;
+    }
+
+    fOut<<std::setprecision(9);
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// open a golden file for reading
+
+bool GEMGoldenFile::OpenRead(const std::string &path)
+{
+    Close();
+
+    fPath = path;
+    fIn.open(path);
+    if(!fIn.is_open()) {
+        std::cout<<__func__<<" Error: cannot open golden file: "<<path<<std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// close file
+
+void GEMGoldenFile::Close()
+{
+    if(fOut.is_open())
+        fOut.close();
+    if(fIn.is_open())
+        fIn.close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// write one event
+
+void GEMGoldenFile::Write(const GEMGoldenEvent &ev)
+{
+    fOut<<"E "<<ev.event_number<<" "<<ev.strips.size()<<" "<<ev.clusters.size()<<"\n";
+
+    for(auto &s: ev.strips)
+    {
+        fOut<<"S "<<s.addr.crate<<" "<<s.addr.mpd<<" "<<s.addr.adc<<" "<<s.addr.strip;
+        for(auto &v: s.values)
+            fOut<<" "<<v;
+        fOut<<"\n";
+    }
+
+    for(auto &c: ev.clusters)
+    {
+        fOut<<"C "<<c.det_id<<" "<<c.layer_id<<" "<<c.plane<<" "<<c.position<<" "
+            <<c.peak_charge<<" "<<c.total_charge<<" "<<(c.cross_talk ? 1 : 0)<<" "
+            <<c.strips.size();
+        for(size_t i=0; i<c.strips.size(); i++)
+            fOut<<" "<<c.strips[i]<<":"<<c.charges[i];
+        fOut<<"\n";
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// read the next event
+
+bool GEMGoldenFile::Read(GEMGoldenEvent &ev)
+{
+    ev.Clear();
+
+    std::string line;
+    if(!std::getline(fIn, line))
+        return false;
+
+    std::istringstream head(line);
+    char tag;
+    size_t nstrips = 0, nclusters = 0;
+    if(!(head>>tag>>ev.event_number>>nstrips>>nclusters) || tag != 'E') {
+        std::cout<<__func__<<" Error: bad event header in "<<fPath<<": "<<line<<std::endl;
+        return false;
+    }
+
+    ev.strips.resize(nstrips);
+    for(auto &s: ev.strips)
+    {
+        if(!std::getline(fIn, line))
+            return false;
+        std::istringstream in(line);
+        if(!(in>>tag>>s.addr.crate>>s.addr.mpd>>s.addr.adc>>s.addr.strip) || tag != 'S') {
+            std::cout<<__func__<<" Error: bad strip line in "<<fPath<<": "<<line<<std::endl;
+            return false;
+        }
+        float v;
+        while(in>>v)
+            s.values.push_back(v);
+    }
+
+    ev.clusters.resize(nclusters);
+    for(auto &c: ev.clusters)
+    {
+        if(!std::getline(fIn, line))
+            return false;
+        std::istringstream in(line);
+        int cross_talk = 0;
+        size_t n = 0;
+        if(!(in>>tag>>c.det_id>>c.layer_id>>c.plane>>c.position>>c.peak_charge
+                  >>c.total_charge>>cross_talk>>n) || tag != 'C') {
+            std::cout<<__func__<<" Error: bad cluster line in "<<fPath<<": "<<line<<std::endl;
+            return false;
+        }
+        c.cross_talk = (cross_talk != 0);
+        c.strips.resize(n);
+        c.charges.resize(n);
+        char colon;
+        for(size_t i=0; i<n; i++)
+            in>>c.strips[i]>>colon>>c.charges[i];
+    }
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ctor
+
+GEMGoldenCompare::GEMGoldenCompare(float abs_tol, float rel_tol, size_t max_reports)
+    : fAbsTol(abs_tol), fRelTol(rel_tol), fMaxReports(max_reports)
+{
+    // place holder
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// float comparison with tolerance
+
+bool GEMGoldenCompare::Equal(float a, float b) const
+{
+    float scale = std::max(std::fabs(a), std::fabs(b));
+    return std::fabs(a - b) <= fAbsTol + fRelTol * scale;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// keep the first differences
+
+void GEMGoldenCompare::report(const std::string &s)
+{
+    if(vReports.size() < fMaxReports)
+        vReports.push_back(s);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// compare one event
+
+size_t GEMGoldenCompare::Compare(const GEMGoldenEvent &ref, const GEMGoldenEvent &cand)
+{
+    fEvents++;
+
+    size_t ndiff = 0;
+    if(ref.event_number != cand.event_number) {
+        std::ostringstream s;
+        s<<"event "<<ref.event_number<<": candidate event number is "<<cand.event_number;
+        report(s.str());
+        ndiff++;
+    }
+
+    ndiff += compareStrips(ref, cand);
+    ndiff += compareClusters(ref, cand);
+
+    if(ndiff > 0)
+        fEventsDiffer++;
+
+    return ndiff;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// one of the inputs has more events than the other
+
+void GEMGoldenCompare::AddMissingEvent(const GEMGoldenEvent &ev, bool in_reference)
+{
+    fEventsMissing++;
+
+    std::ostringstream s;
+    s<<"event "<<ev.event_number<<": only in "<<(in_reference ? "reference" : "candidate");
+    report(s.str());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// compare the zero suppressed strips, both sorted by address
+
+size_t GEMGoldenCompare::compareStrips(const GEMGoldenEvent &ref, const GEMGoldenEvent &cand)
+{
+    size_t ndiff = 0, i = 0, j = 0;
+    fStrips += ref.strips.size();
+
+    while(i < ref.strips.size() || j < cand.strips.size())
+    {
+        std::ostringstream s;
+        s<<"event "<<ref.event_number<<": ";
+
+        if(j >= cand.strips.size() ||
+           (i < ref.strips.size() && strip_key(ref.strips[i]) < strip_key(cand.strips[j]))) {
+            s<<"strip missing in candidate ("<<address_str(ref.strips[i].addr)<<")";
+            report(s.str());
+            fStripsMissing++; ndiff++; i++;
+            continue;
+        }
+        if(i >= ref.strips.size() || strip_key(cand.strips[j]) < strip_key(ref.strips[i])) {
+            s<<"extra strip in candidate ("<<address_str(cand.strips[j].addr)<<")";
+            report(s.str());
+            fStripsExtra++; ndiff++; j++;
+            continue;
+        }
+
+        const std::vector<float> &a = ref.strips[i].values, &b = cand.strips[j].values;
+        bool same = (a.size() == b.size());
+        size_t ts = 0;
+        for(; same && ts<a.size(); ts++)
+            same = Equal(a[ts], b[ts]);
+        if(!same) {
+            s<<"strip adc differs ("<<address_str(ref.strips[i].addr)<<")";
+            if(a.size() != b.size())
+                s<<", time samples "<<a.size()<<" vs "<<b.size();
+            else
+                s<<", time sample "<<ts - 1<<": "<<a[ts - 1]<<" vs "<<b[ts - 1];
+            report(s.str());
+            fStripsDiffer++; ndiff++;
+        }
+        i++; j++;
+    }
+
+    return ndiff;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// compare the clusters, both sorted by plane and position
+
+size_t GEMGoldenCompare::compareClusters(const GEMGoldenEvent &ref, const GEMGoldenEvent &cand)
+{
+    size_t ndiff = 0, i = 0, j = 0;
+    fClusters += ref.clusters.size();
+
+    auto before = [&](const GEMGoldenCluster &a, const GEMGoldenCluster &b)
+    {
+        if(plane_key(a) != plane_key(b))
+            return plane_key(a) < plane_key(b);
+        return !Equal(a.position, b.position) && a.position < b.position;
+    };
+
+    while(i < ref.clusters.size() || j < cand.clusters.size())
+    {
+        std::ostringstream s;
+        s<<"event "<<ref.event_number<<": ";
+
+        if(j >= cand.clusters.size() ||
+           (i < ref.clusters.size() && before(ref.clusters[i], cand.clusters[j]))) {
+            s<<"cluster missing in candidate ("<<plane_str(ref.clusters[i])
+             <<", position "<<ref.clusters[i].position<<")";
+            report(s.str());
+            fClustersMissing++; ndiff++; i++;
+            continue;
+        }
+        if(i >= ref.clusters.size() || before(cand.clusters[j], ref.clusters[i])) {
+            s<<"extra cluster in candidate ("<<plane_str(cand.clusters[j])
+             <<", position "<<cand.clusters[j].position<<")";
+            report(s.str());
+            fClustersExtra++; ndiff++; j++;
+            continue;
+        }
+
+        const GEMGoldenCluster &a = ref.clusters[i], &b = cand.clusters[j];
+        std::string what;
+        if(!Equal(a.peak_charge, b.peak_charge))
+            what = "peak charge";
+        else if(!Equal(a.total_charge, b.total_charge))
+            what = "total charge";
+        else if(a.cross_talk != b.cross_talk)
+            what = "cross talk flag";
+        else if(a.strips != b.strips)
+            what = "strips";
+        else {
+            for(size_t k=0; k<a.charges.size() && what.empty(); k++)
+                if(!Equal(a.charges[k], b.charges[k]))
+                    what = "strip charge";
+        }
+
+        if(!what.empty()) {
+            s<<"cluster "<<what<<" differs ("<<plane_str(a)<<", position "<<a.position<<")";
+            report(s.str());
+            fClustersDiffer++; ndiff++;
+        }
+        i++; j++;
+    }
+
+    return ndiff;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// print summary and the first differences
+
+void GEMGoldenCompare::Print(std::ostream &os) const
+{
+    os<<"compared "<<fEvents<<" events, "<<fEventsDiffer<<" differ, "
+      <<fEventsMissing<<" only in one input"<<std::endl
+      <<"    strips:   "<<fStrips<<" in reference, "<<fStripsMissing<<" missing, "
+      <<fStripsExtra<<" extra, "<<fStripsDiffer<<" differ"<<std::endl
+      <<"    clusters: "<<fClusters<<" in reference, "<<fClustersMissing<<" missing, "
+      <<fClustersExtra<<" extra, "<<fClustersDiffer<<" differ"<<std::endl;
+
+    if(vReports.empty())
+        return;
+
+    os<<"first differences:"<<std::endl;
+    for(auto &r: vReports)
+        os<<"    "<<r<<std::endl;
+}
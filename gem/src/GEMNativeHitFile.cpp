@@ -0,0 +1,548 @@
+#include "GEMNativeHitFile.h"
+#include "GEMSystem.h"
+#include "GEMAPV.h"
+#include "GEMPlane.h"
+#include "GEMDetector.h"
+#include "APVStripMapping.h"
+
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
+
+using namespace gem_native;
+
+// all columns are aligned to 8 bytes in file
+static inline size_t padded_size(const size_t &s)
+{
+    return (s + 7) & ~static_cast<size_t>(7);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ctor
+
+GEMNativeHitWriter::GEMNativeHitWriter(const char *path, uint32_t time_samples,
+        bool compress, uint32_t events_per_chunk)
+    : fPath(path), fTimeSamples(time_samples), fCompression(None),
+    fEventsPerChunk(events_per_chunk)
+{
+    if(compress) {
+#ifdef USE_LZ4
+        fCompression = LZ4;
+#else
+        std::cout<<__func__<<" Warning: not compiled with USE_LZ4, "
+                 <<"native hit file will be written uncompressed."<<std::endl;
+#endif
+    }
+
+    if(fEventsPerChunk == 0)
+        fEventsPerChunk = GEM_NATIVE_EVENTS_PER_CHUNK;
+
+    pFile = fopen(path, "wb");
+    if(pFile == nullptr) {
+        std::cout<<__func__<<" Error: cannot open file: "<<path<<std::endl;
+        return;
+    }
+
+    NativeHitFileHeader header;
+    header.magic = GEM_NATIVE_HIT_MAGIC;
+    header.version = GEM_NATIVE_HIT_VERSION;
+    header.time_samples = fTimeSamples;
+    header.compression = fCompression;
+    fwrite(&header, sizeof(header), 1, pFile);
+    fFileOffset = sizeof(header);
+
+    cOffset.push_back(0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// dtor
+
+GEMNativeHitWriter::~GEMNativeHitWriter()
+{
+    // close file if user forgot to call Write()
+    if(pFile != nullptr)
+        Write();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// fill event, same content as GEMRootHitTree::Fill()
+
+void GEMNativeHitWriter::Fill(GEMSystem *gem_sys, const EventData &ev)
+{
+    const GEMStripHits &strip_data = ev.get_gem_data();
+    uint32_t nch = strip_data.size();
+
+    // keep the same convention as the root hit tree: empty events are not saved
+    if(nch == 0)
+        return;
+
+    auto mapping = apv_strip_mapping::Mapping::Instance();
+
+    size_t hit_begin = cAddr.size();
+
+    cAddr.resize(hit_begin + nch);
+    cPlane.resize(hit_begin + nch);
+    cProd.resize(hit_begin + nch);
+    cModule.resize(hit_begin + nch);
+    cAxis.resize(hit_begin + nch);
+    cStrip.resize(hit_begin + nch);
+    cADC.resize((hit_begin + nch) * fTimeSamples, 0);
+
+    for(uint32_t i=0; i<nch; i++)
+    {
+        GEMChannelAddress a = strip_data.address(i);
+        size_t k = hit_begin + i;
+
+        cAddr[k] = strip_data.addr[i];
+        cPlane[k] = static_cast<int16_t>(mapping -> GetPlaneID(a));
+        cProd[k] = static_cast<int16_t>(mapping -> GetProdID(a));
+        cModule[k] = static_cast<int16_t>(mapping -> GetModuleID(a));
+        cAxis[k] = static_cast<int16_t>(mapping -> GetAxis(a));
+
+        const std::string & detector_type = gem_sys -> GetAPV(a.crate, a.mpd, a.adc)
+            -> GetPlane() -> GetDetector() -> GetType();
+        cStrip[k] = static_cast<int16_t>(mapping -> GetStrip(detector_type, a));
+
+        const float *values = strip_data.values(i);
+        uint32_t nts = std::min(strip_data.time_samples(i), fTimeSamples);
+        int16_t *dst = &cADC[k * fTimeSamples];
+        for(uint32_t ts=0; ts<nts; ts++)
+            dst[ts] = static_cast<int16_t>(static_cast<int>(values[ts]));
+    }
+
+    cEvtID.push_back(ev.event_number);
+    cOffset.push_back(static_cast<uint32_t>(hit_begin + nch));
+
+    if(cEvtID.size() >= fEventsPerChunk)
+        flushChunk();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// fill event from column arrays
+
+void GEMNativeHitWriter::FillEvent(int evtID, uint32_t nch, const uint32_t *addr,
+        const int16_t *plane, const int16_t *prod, const int16_t *module,
+        const int16_t *axis, const int16_t *strip, const int16_t *adc)
+{
+    if(nch == 0)
+        return;
+
+    cEvtID.push_back(evtID);
+    cAddr.insert(cAddr.end(), addr, addr + nch);
+    cPlane.insert(cPlane.end(), plane, plane + nch);
+    cProd.insert(cProd.end(), prod, prod + nch);
+    cModule.insert(cModule.end(), module, module + nch);
+    cAxis.insert(cAxis.end(), axis, axis + nch);
+    cStrip.insert(cStrip.end(), strip, strip + nch);
+    cADC.insert(cADC.end(), adc, adc + nch * fTimeSamples);
+    cOffset.push_back(static_cast<uint32_t>(cAddr.size()));
+
+    if(cEvtID.size() >= fEventsPerChunk)
+        flushChunk();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// write padding bytes
+
+void GEMNativeHitWriter::writePadding(size_t bytes)
+{
+    static const char zeros[8] = {0};
+    if(bytes > 0)
+        fwrite(zeros, 1, bytes, pFile);
+    fFileOffset += bytes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// write one column, compress it if requested and if it pays off
+
+void GEMNativeHitWriter::writeColumn(uint32_t col, const void *data, size_t bytes,
+        NativeHitChunkHeader &header)
+{
+    const char *out = static_cast<const char*>(data);
+    size_t out_bytes = bytes;
+
+#ifdef USE_LZ4
+    if(fCompression == LZ4 && bytes > 0) {
+        int bound = LZ4_compressBound(static_cast<int>(bytes));
+        if(vCompressBuf.size() < static_cast<size_t>(bound))
+            vCompressBuf.resize(bound);
+        int n = LZ4_compress_default(out, vCompressBuf.data(),
+                static_cast<int>(bytes), bound);
+        // store it uncompressed if compression does not help
+        if(n > 0 && static_cast<size_t>(n) < bytes) {
+            out = vCompressBuf.data();
+            out_bytes = n;
+        }
+    }
+#endif
+
+    header.column[col].raw_size = static_cast<uint32_t>(bytes);
+    header.column[col].stored_size = static_cast<uint32_t>(out_bytes);
+
+    if(out_bytes > 0)
+        fwrite(out, 1, out_bytes, pFile);
+    fFileOffset += out_bytes;
+    writePadding(padded_size(out_bytes) - out_bytes);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// write the current chunk to disk
+
+void GEMNativeHitWriter::flushChunk()
+{
+    if(pFile == nullptr || cEvtID.empty())
+        return;
+
+    NativeHitChunkIndex index;
+    index.file_offset = fFileOffset;
+    index.first_event = fEventCount;
+    vChunkIndex.push_back(index);
+
+    NativeHitChunkHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = GEM_NATIVE_CHUNK_MAGIC;
+    header.n_events = static_cast<uint32_t>(cEvtID.size());
+    header.n_hits = static_cast<uint32_t>(cAddr.size());
+
+    // write a placeholder header, column sizes are filled afterwards
+    long header_pos = ftell(pFile);
+    fwrite(&header, sizeof(header), 1, pFile);
+    fFileOffset += sizeof(header);
+
+    writeColumn(EvtID, cEvtID.data(), cEvtID.size() * sizeof(int32_t), header);
+    writeColumn(Offset, cOffset.data(), cOffset.size() * sizeof(uint32_t), header);
+    writeColumn(Addr, cAddr.data(), cAddr.size() * sizeof(uint32_t), header);
+    writeColumn(Plane, cPlane.data(), cPlane.size() * sizeof(int16_t), header);
+    writeColumn(Prod, cProd.data(), cProd.size() * sizeof(int16_t), header);
+    writeColumn(Module, cModule.data(), cModule.size() * sizeof(int16_t), header);
+    writeColumn(Axis, cAxis.data(), cAxis.size() * sizeof(int16_t), header);
+    writeColumn(Strip, cStrip.data(), cStrip.size() * sizeof(int16_t), header);
+    writeColumn(ADC, cADC.data(), cADC.size() * sizeof(int16_t), header);
+
+    // update chunk header
+    long end_pos = ftell(pFile);
+    fseek(pFile, header_pos, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, pFile);
+    fseek(pFile, end_pos, SEEK_SET);
+
+    fEventCount += cEvtID.size();
+
+    // reset columns, keep the capacity
+    cEvtID.clear();
+    cOffset.clear();
+    cOffset.push_back(0);
+    cAddr.clear();
+    cPlane.clear();
+    cProd.clear();
+    cModule.clear();
+    cAxis.clear();
+    cStrip.clear();
+    cADC.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// write chunk index and trailer, close file
+
+void GEMNativeHitWriter::Write()
+{
+    if(pFile == nullptr)
+        return;
+
+    std::cout<<"writing native hit file to: "<<fPath<<std::endl;
+
+    flushChunk();
+
+    NativeHitFileTrailer trailer;
+    trailer.index_offset = fFileOffset;
+    trailer.n_events = fEventCount;
+    trailer.n_chunks = static_cast<uint32_t>(vChunkIndex.size());
+    trailer.magic = GEM_NATIVE_HIT_MAGIC;
+
+    if(!vChunkIndex.empty())
+        fwrite(vChunkIndex.data(), sizeof(NativeHitChunkIndex), vChunkIndex.size(), pFile);
+    fwrite(&trailer, sizeof(trailer), 1, pFile);
+
+    fclose(pFile);
+    pFile = nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// reader ctor
+
+GEMNativeHitReader::GEMNativeHitReader(const char *path)
+{
+    for(auto &i: pColumn)
+        i = nullptr;
+
+    if(path != nullptr)
+        Open(path);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// reader dtor
+
+GEMNativeHitReader::~GEMNativeHitReader()
+{
+    Close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// map file into memory and read the chunk index
+
+bool GEMNativeHitReader::Open(const char *path)
+{
+    Close();
+
+    fFd = open(path, O_RDONLY);
+    if(fFd < 0) {
+        std::cout<<__func__<<" Error: cannot open file: "<<path<<std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if(fstat(fFd, &st) != 0 || static_cast<size_t>(st.st_size) <
+            sizeof(NativeHitFileHeader) + sizeof(NativeHitFileTrailer)) {
+        std::cout<<__func__<<" Error: not a native hit file: "<<path<<std::endl;
+        Close();
+        return false;
+    }
+    fMapSize = st.st_size;
+
+    void *m = mmap(nullptr, fMapSize, PROT_READ, MAP_PRIVATE, fFd, 0);
+    if(m == MAP_FAILED) {
+        std::cout<<__func__<<" Error: mmap failed: "<<path<<std::endl;
+        Close();
+        return false;
+    }
+    pMap = static_cast<const char*>(m);
+    madvise(m, fMapSize, MADV_SEQUENTIAL);
+
+    const NativeHitFileHeader *header = reinterpret_cast<const NativeHitFileHeader*>(pMap);
+    const NativeHitFileTrailer *trailer = reinterpret_cast<const NativeHitFileTrailer*>(
+            pMap + fMapSize - sizeof(NativeHitFileTrailer));
+
+    if(header -> magic != GEM_NATIVE_HIT_MAGIC || trailer -> magic != GEM_NATIVE_HIT_MAGIC) {
+        std::cout<<__func__<<" Error: not a native hit file, or file not closed properly: "
+                 <<path<<std::endl;
+        Close();
+        return false;
+    }
+    if(header -> version != GEM_NATIVE_HIT_VERSION) {
+        std::cout<<__func__<<" Error: unsupported native hit file version: "
+                 <<header -> version<<std::endl;
+        Close();
+        return false;
+    }
+#ifndef USE_LZ4
+    if(header -> compression == LZ4) {
+        std::cout<<__func__<<" Error: file is LZ4 compressed, "
+                 <<"but reader is not compiled with USE_LZ4."<<std::endl;
+        Close();
+        return false;
+    }
+#endif
+
+    // the chunk index sits between the last chunk and the trailer
+    uint64_t index_end = fMapSize - sizeof(NativeHitFileTrailer);
+    uint64_t index_bytes = static_cast<uint64_t>(trailer -> n_chunks) * sizeof(NativeHitChunkIndex);
+    if(trailer -> index_offset < sizeof(NativeHitFileHeader) ||
+            !inMap(trailer -> index_offset, index_bytes) ||
+            trailer -> index_offset + index_bytes > index_end) {
+        std::cout<<__func__<<" Error: corrupted chunk index: "<<path<<std::endl;
+        Close();
+        return false;
+    }
+
+    fTimeSamples = header -> time_samples;
+    fCompression = header -> compression;
+    fEntries = trailer -> n_events;
+    fNChunks = trailer -> n_chunks;
+    pChunkIndex = reinterpret_cast<const NativeHitChunkIndex*>(pMap + trailer -> index_offset);
+
+    // chunks must cover the events in order, starting from event 0
+    bool index_ok = (fNChunks > 0) ? (pChunkIndex[0].first_event == 0) : (fEntries == 0);
+    for(uint32_t i=0; index_ok && i<fNChunks; i++)
+    {
+        if(pChunkIndex[i].first_event >= fEntries ||
+                (i > 0 && pChunkIndex[i].first_event <= pChunkIndex[i-1].first_event) ||
+                pChunkIndex[i].file_offset < sizeof(NativeHitFileHeader) ||
+                !inMap(pChunkIndex[i].file_offset, sizeof(NativeHitChunkHeader)) ||
+                pChunkIndex[i].file_offset + sizeof(NativeHitChunkHeader) > trailer -> index_offset)
+            index_ok = false;
+    }
+    if(!index_ok) {
+        std::cout<<__func__<<" Error: corrupted chunk index: "<<path<<std::endl;
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// unmap file
+
+void GEMNativeHitReader::Close()
+{
+    if(pMap != nullptr)
+        munmap(const_cast<char*>(pMap), fMapSize);
+    if(fFd >= 0)
+        close(fFd);
+
+    pMap = nullptr;
+    fMapSize = 0;
+    fFd = -1;
+    fEntries = 0;
+    fNChunks = 0;
+    pChunkIndex = nullptr;
+    fCurrentChunk = -1;
+    pChunkHeader = nullptr;
+    for(auto &i: pColumn)
+        i = nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// locate columns of a chunk, decompress them if needed
+
+bool GEMNativeHitReader::loadChunk(const uint32_t &chunk)
+{
+    if(static_cast<int64_t>(chunk) == fCurrentChunk)
+        return true;
+
+    // chunk offsets were checked against the map in Open()
+    uint64_t pos = pChunkIndex[chunk].file_offset;
+    pChunkHeader = reinterpret_cast<const NativeHitChunkHeader*>(pMap + pos);
+    if(pChunkHeader -> magic != GEM_NATIVE_CHUNK_MAGIC) {
+        std::cout<<__func__<<" Error: corrupted chunk: "<<chunk<<std::endl;
+        fCurrentChunk = -1;
+        return false;
+    }
+    pos += sizeof(NativeHitChunkHeader);
+
+    // expected column sizes after decompression
+    uint64_t n_events = pChunkHeader -> n_events, n_hits = pChunkHeader -> n_hits;
+    uint64_t raw_size[NColumns];
+    raw_size[EvtID] = n_events * sizeof(int32_t);
+    raw_size[Offset] = (n_events + 1) * sizeof(uint32_t);
+    raw_size[Addr] = n_hits * sizeof(uint32_t);
+    raw_size[Plane] = raw_size[Prod] = raw_size[Module] = raw_size[Axis]
+        = raw_size[Strip] = n_hits * sizeof(int16_t);
+    raw_size[ADC] = n_hits * fTimeSamples * sizeof(int16_t);
+
+    for(uint32_t col=0; col<NColumns; col++)
+    {
+        const ColumnInfo &info = pChunkHeader -> column[col];
+        if(info.raw_size != raw_size[col] || info.stored_size > info.raw_size ||
+                !inMap(pos, info.stored_size)) {
+            std::cout<<__func__<<" Error: corrupted chunk: "<<chunk<<std::endl;
+            fCurrentChunk = -1;
+            return false;
+        }
+
+        const char *p = pMap + pos;
+        if(info.stored_size == info.raw_size) {
+            // zero copy
+            pColumn[col] = p;
+        }
+        else {
+#ifdef USE_LZ4
+            std::vector<char> &buf = vColumnBuf[col];
+            if(buf.size() < info.raw_size)
+                buf.resize(info.raw_size);
+            int n = LZ4_decompress_safe(p, buf.data(), static_cast<int>(info.stored_size),
+                    static_cast<int>(info.raw_size));
+            if(n != static_cast<int>(info.raw_size)) {
+                std::cout<<__func__<<" Error: failed decompressing chunk: "<<chunk<<std::endl;
+                fCurrentChunk = -1;
+                return false;
+            }
+            pColumn[col] = buf.data();
+#else
+            fCurrentChunk = -1;
+            return false;
+#endif
+        }
+        pos += padded_size(info.stored_size);
+    }
+
+    // hit ranges of the events must stay inside the hit columns
+    const uint32_t *offset = reinterpret_cast<const uint32_t*>(column(Offset));
+    bool offset_ok = (n_events > 0 && offset[0] == 0 && offset[n_events] == n_hits);
+    for(uint64_t i=0; offset_ok && i<n_events; i++)
+        offset_ok = offset[i] <= offset[i+1];
+    if(!offset_ok) {
+        std::cout<<__func__<<" Error: corrupted chunk: "<<chunk<<std::endl;
+        fCurrentChunk = -1;
+        return false;
+    }
+
+    fCurrentChunk = chunk;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// get event by index
+
+bool GEMNativeHitReader::GetEvent(const uint64_t &index, NativeHitEvent &ev)
+{
+    if(pMap == nullptr || index >= fEntries)
+        return false;
+
+    // find the chunk containing this event, sequential reading stays in the
+    // current chunk most of the time
+    uint32_t chunk = 0;
+    if(fCurrentChunk >= 0 &&
+            index >= pChunkIndex[fCurrentChunk].first_event &&
+            index < pChunkIndex[fCurrentChunk].first_event + pChunkHeader -> n_events) {
+        chunk = fCurrentChunk;
+    }
+    else {
+        const NativeHitChunkIndex *it = std::upper_bound(pChunkIndex, pChunkIndex + fNChunks,
+                index, [](const uint64_t &i, const NativeHitChunkIndex &c)
+                {return i < c.first_event;});
+        chunk = static_cast<uint32_t>(it - pChunkIndex) - 1;
+    }
+
+    if(!loadChunk(chunk))
+        return false;
+
+    uint64_t i = index - pChunkIndex[chunk].first_event;
+    if(i >= pChunkHeader -> n_events) {
+        std::cout<<__func__<<" Error: event "<<index<<" is not in chunk "<<chunk<<std::endl;
+        return false;
+    }
+    const int32_t *evtID = reinterpret_cast<const int32_t*>(column(EvtID));
+    const uint32_t *offset = reinterpret_cast<const uint32_t*>(column(Offset));
+    uint32_t begin = offset[i], nch = offset[i+1] - offset[i];
+
+    auto i16 = [&](const uint32_t &col) -> gem_native::Span<int16_t>
+    {
+        return gem_native::Span<int16_t>(
+                reinterpret_cast<const int16_t*>(column(col)) + begin, nch);
+    };
+
+    ev.evtID = evtID[i];
+    ev.nch = nch;
+    ev.time_samples = fTimeSamples;
+    ev.addr = gem_native::Span<uint32_t>(
+            reinterpret_cast<const uint32_t*>(column(Addr)) + begin, nch);
+    ev.plane = i16(Plane);
+    ev.prod = i16(Prod);
+    ev.module = i16(Module);
+    ev.axis = i16(Axis);
+    ev.strip = i16(Strip);
+    ev.adc = gem_native::Span<int16_t>(
+            reinterpret_cast<const int16_t*>(column(ADC)) + begin * fTimeSamples,
+            nch * fTimeSamples);
+
+    return true;
+}
@@ -16,6 +16,7 @@
 #include <TFile.h>
 #include <TROOT.h>
 #include <TKey.h>
+#include <TMath.h>
 
 
 ////////////////////////////////////////////////////////////////
@@ -23,8 +24,78 @@
 // by setting NTHREAD to 1
 
 #define NTHREAD 3
+// number of events queued for each worker
+#define EVENT_QUEUE_DEPTH 16
 std::mutex mtx;
 
+////////////////////////////////////////////////////////////////
+// strip noise/offset ranges, same as the TH1I used in GetRMS()
+// and GetMean()
+
+#define STRIP_NOISE_LOW -400
+#define STRIP_NOISE_HIGH 400
+#define STRIP_OFFSET_LOW 400
+#define STRIP_OFFSET_HIGH 1400
+
+// upper limit of apv time samples in RawAPVUnit_stat()
+#define MAX_APV_TIME_SAMPLES 32
+
+////////////////////////////////////////////////////////////////
+// strip rms, same definition as TH1::GetRMS()
+
+double StripStat::GetRMS() const
+{
+    if(n == 0)
+        return 0.;
+
+    double mean = static_cast<double>(sum) / n;
+    double rms2 = static_cast<double>(sum2) / n - mean * mean;
+    return TMath::Sqrt(TMath::Abs(rms2));
+}
+
+////////////////////////////////////////////////////////////////
+// get slot index for an apv, allocate a new slot if not found
+
+uint32_t APVStripStat::GetSlot(const APVAddress &addr)
+{
+    auto it = mSlot.find(addr);
+    if(it != mSlot.end())
+        return it -> second;
+
+    uint32_t slot = static_cast<uint32_t>(vAPV.size());
+    mSlot[addr] = slot;
+    vAPV.push_back(addr);
+    vNoise.resize(vAPV.size() * APV_STRIP_SIZE);
+    vOffset.resize(vAPV.size() * APV_STRIP_SIZE);
+    return slot;
+}
+
+////////////////////////////////////////////////////////////////
+// merge statistics from another accumulator
+
+void APVStripStat::Merge(const APVStripStat &r)
+{
+    for(size_t i=0; i<r.vAPV.size(); i++)
+    {
+        uint32_t slot = GetSlot(r.vAPV[i]);
+        for(int strip=0; strip<APV_STRIP_SIZE; strip++) {
+            vNoise[slot*APV_STRIP_SIZE + strip].Merge(r.vNoise[i*APV_STRIP_SIZE + strip]);
+            vOffset[slot*APV_STRIP_SIZE + strip].Merge(r.vOffset[i*APV_STRIP_SIZE + strip]);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////
+// reset
+
+void APVStripStat::Clear()
+{
+    mSlot.clear();
+    vAPV.clear();
+    vNoise.clear();
+    vOffset.clear();
+}
+
 ////////////////////////////////////////////////////////////////
 // ctor
 
@@ -67,6 +138,12 @@ int GEMPedestal::GetNumberOfEvents() const
 
 ////////////////////////////////////////////////////////////////
 // calculate pedestal
+//
+// one reader (the calling thread) copies evio events into owned
+// buffers and hands them round-robin to NTHREAD workers through
+// single producer single consumer queues; buffers are recycled
+// through a second queue per worker. Each worker parses and
+// accumulates into its own PedestalAccumulator, no locks needed.
 
 void GEMPedestal::CalculatePedestal()
 {
@@ -85,6 +162,9 @@ void GEMPedestal::CalculatePedestal()
     MPDSSPRawEventDecoder *mpd_decoder[NTHREAD];
 #endif
 
+    std::vector<EventBufferQueue*> full_queue, free_queue;
+    std::vector<PedestalAccumulator> accumulator(NTHREAD);
+
     for(int i=0;i<NTHREAD;i++){
         event_parser[i] = new EventParser();
 #ifdef USE_VME
@@ -94,66 +174,131 @@ void GEMPedestal::CalculatePedestal()
         mpd_decoder[i] = new MPDSSPRawEventDecoder();
         event_parser[i]->RegisterRawDecoder(static_cast<int>(Bank_TagID::MPD_SSP), mpd_decoder[i]);
 #endif
+        full_queue.push_back(new EventBufferQueue(EVENT_QUEUE_DEPTH));
+        free_queue.push_back(new EventBufferQueue(EVENT_QUEUE_DEPTH));
     }
 
-    uint32_t nEvents = 0;
-
     std::vector<std::thread> vth;
     for(int i=0;i<NTHREAD;i++){
-        vth.emplace_back(&GEMPedestal::GetEvent, this, file_reader, event_parser[i], std::ref(nEvents));
+        vth.emplace_back(&GEMPedestal::ProcessEvents, this, event_parser[i],
+                full_queue[i], free_queue[i], std::ref(accumulator[i]));
     }
 
+    uint32_t nEvents = ReadEvents(full_queue, free_queue);
+
     for(auto &i: vth)
         i.join();
 
+    // merge in worker order
+    for(auto &i: accumulator)
+        MergeAccumulator(i);
+
+    for(int i=0;i<NTHREAD;i++){
+        delete event_parser[i];
+        delete mpd_decoder[i];
+        delete full_queue[i];
+        delete free_queue[i];
+    }
+
+    std::cout<<"GEMPedestal: used "<<nEvents<<" events."<<std::endl;
+
     //GenerateAPVPedestal_using_histo(); // slow
-    GenerateAPVPedestal_using_vec();     // fast
+    //GenerateAPVPedestal_using_vec();   // fast
+    GenerateAPVPedestal_using_stat();    // fastest, no samples stored
 }
 
 ////////////////////////////////////////////////////////////////
-// precess batch events
+// reader: copy events to owned buffers and distribute them to
+// workers, event i always goes to worker i % NTHREAD
 
-void GEMPedestal::GetEvent(EvioFileReader *file_reader, EventParser *event_parser,
-        uint32_t &nEvents)
+uint32_t GEMPedestal::ReadEvents(std::vector<EventBufferQueue*> &full,
+        std::vector<EventBufferQueue*> &recycle)
 {
     const uint32_t *pBuf;
     uint32_t fBufLen;
-    bool run = true;
-    while(run)
+    uint32_t nEvents = 0;
+    size_t nWorkers = full.size();
+
+    while(nEvents < fNumberEvents &&
+            file_reader -> ReadNoCopy(&pBuf, &fBufLen) == S_SUCCESS)
     {
-        mtx.lock();
-        run = (file_reader -> ReadNoCopy(&pBuf, &fBufLen)) == S_SUCCESS;
+        size_t w = nEvents % nWorkers;
+
+        // reuse a buffer returned by the worker if there is one
+        EventBuffer buf;
+        recycle[w] -> TryPop(buf);
+        buf.assign(pBuf, pBuf + fBufLen);
+
+        full[w] -> Push(std::move(buf));
         nEvents++;
-        mtx.unlock();
+    }
+
+    for(auto &i: full)
+        i -> Close();
 
-        event_parser->ParseEvent(pBuf, fBufLen);
+    return nEvents;
+}
+
+////////////////////////////////////////////////////////////////
+// worker: parse events and accumulate strip noise/offset
+
+void GEMPedestal::ProcessEvents(EventParser *event_parser, EventBufferQueue *full,
+        EventBufferQueue *recycle, PedestalAccumulator &acc)
+{
+    EventBuffer buf;
+    while(full -> Pop(buf))
+    {
+        event_parser->ParseEvent(buf.data(), static_cast<uint32_t>(buf.size()));
 #ifdef USE_VME
-        [[maybe_unused]] auto & decoded_data = dynamic_cast<MPDVMERawEventDecoder*>(
+        auto & decoded_data = dynamic_cast<MPDVMERawEventDecoder*>(
                 event_parser->GetRawDecoder(static_cast<int>(Bank_TagID::MPD_VME)))
             ->GetAPV();
 #else
-        [[maybe_unused]] auto & decoded_data = dynamic_cast<MPDSSPRawEventDecoder*>(
+        auto & decoded_data = dynamic_cast<MPDSSPRawEventDecoder*>(
                 event_parser->GetRawDecoder(static_cast<int>(Bank_TagID::MPD_SSP)))
             ->GetAPV();
 #endif
 
-        CalculateEventRawPedestal(decoded_data);
+        CalculateEventRawPedestal(decoded_data, acc);
+
+        // give the buffer back to reader, drop it if the queue is full
+        recycle -> TryPush(std::move(buf));
+    }
+}
+
+////////////////////////////////////////////////////////////////
+// merge one worker accumulator into the pedestal data
+
+void GEMPedestal::MergeAccumulator(PedestalAccumulator &acc)
+{
+    fAPVStripStat.Merge(acc.stat);
+    acc.stat.Clear();
 
-        if(nEvents >= fNumberEvents)
-            break;
+    for(auto &i: acc.noise) {
+        auto &v = mAPVStripNoiseVec[i.first];
+        v.insert(v.end(), i.second.begin(), i.second.end());
+    }
+    for(auto &i: acc.offset) {
+        auto &v = mAPVStripOffsetVec[i.first];
+        v.insert(v.end(), i.second.begin(), i.second.end());
     }
+
+    acc.noise.clear();
+    acc.offset.clear();
 }
 
 ////////////////////////////////////////////////////////////////
 // calculate raw pedestal for one event
 
 void GEMPedestal::CalculateEventRawPedestal(
-        const std::unordered_map<APVAddress, std::vector<int>> & event_data)
+        const std::unordered_map<APVAddress, std::vector<int>> & event_data,
+        PedestalAccumulator &acc)
 {
     for(auto &i: event_data)
     {
         //RawAPVUnit_histo(i); // slow
-        RawAPVUnit_vec(i);     // fast
+        //RawAPVUnit_vec(i, acc);// fast
+        RawAPVUnit_stat(i, acc); // fastest
     }
 
     //RawPedestalThread(event_data, 0, static_cast<int>(event_data.size()));
@@ -225,7 +370,8 @@ void GEMPedestal::RawAPVUnit_histo(const std::unordered_map<APVAddress, std::vec
 ////////////////////////////////////////////////////////////////
 // process raw data in one APV, using std::vector (fast)
 
-void GEMPedestal::RawAPVUnit_vec(const std::unordered_map<APVAddress, std::vector<int>>::value_type & i)
+void GEMPedestal::RawAPVUnit_vec(const std::unordered_map<APVAddress, std::vector<int>>::value_type & i,
+        PedestalAccumulator &acc)
 {
     const std::vector<StripRawADC> & apv_raw_data = DecodeAPV(i.second);
     auto apv_ts_commonMode = GetTimeSampleCommonMode(apv_raw_data);
@@ -246,13 +392,62 @@ void GEMPedestal::RawAPVUnit_vec(const std::unordered_map<APVAddress, std::vecto
             noise += (strip.v_adc[ts] - apv_ts_commonMode[ts]);
         noise /= time_sample_size;
 
-        mtx.lock();
-        mAPVStripNoiseVec[addr].push_back(noise);
-        mAPVStripOffsetVec[addr].push_back(offset); 
-        mtx.unlock();
+        acc.noise[addr].push_back(noise);
+        acc.offset[addr].push_back(offset); 
     }
 }
 
+////////////////////////////////////////////////////////////////
+// process raw data in one APV, using dense streaming statistics
+// works on the raw apv words directly, gives the same strip
+// noise/offset as RawAPVUnit_vec()
+
+void GEMPedestal::RawAPVUnit_stat(const std::unordered_map<APVAddress, std::vector<int>>::value_type & i,
+        PedestalAccumulator &acc)
+{
+    const std::vector<int> &apv_data = i.second;
+
+    int event_size = static_cast<int>(apv_data.size());
+    if(event_size == 0 || event_size % MPD_APV_TS_LEN != 0) {
+        std::cout<<"Warning: apv data size incorrect. Data might be corrupted."
+            <<std::endl;
+        return;
+    }
+    int nTimeSample = event_size / MPD_APV_TS_LEN;
+
+    // common mode in each time sample
+    int commonMode[MAX_APV_TIME_SAMPLES] = {0};
+    if(nTimeSample > MAX_APV_TIME_SAMPLES) {
+        std::cout<<"Warning: apv has "<<nTimeSample<<" time samples, only first "
+            <<MAX_APV_TIME_SAMPLES<<" are used."<<std::endl;
+        nTimeSample = MAX_APV_TIME_SAMPLES;
+    }
+    for(int ts=0; ts<nTimeSample; ts++) {
+        const int *p = &apv_data[ts*MPD_APV_TS_LEN];
+        for(int strip=0; strip<APV_STRIP_SIZE; strip++)
+            commonMode[ts] += p[strip];
+        commonMode[ts] /= APV_STRIP_SIZE;
+    }
+
+    uint32_t slot = acc.stat.GetSlot(i.first);
+    StripStat *noise_stat = &acc.stat.vNoise[slot*APV_STRIP_SIZE];
+    StripStat *offset_stat = &acc.stat.vOffset[slot*APV_STRIP_SIZE];
+
+    for(int strip=0; strip<APV_STRIP_SIZE; strip++)
+    {
+        int offset = 0, noise = 0;
+        for(int ts=0; ts<nTimeSample; ts++) {
+            int adc = apv_data[strip + ts*MPD_APV_TS_LEN];
+            offset += adc;
+            noise += adc - commonMode[ts];
+        }
+        offset /= nTimeSample;
+        noise /= nTimeSample;
+
+        noise_stat[strip].Fill(noise, STRIP_NOISE_LOW, STRIP_NOISE_HIGH);
+        offset_stat[strip].Fill(offset, STRIP_OFFSET_LOW, STRIP_OFFSET_HIGH);
+    }
+}
 
 ////////////////////////////////////////////////////////////////
 // get common Mode for each time sample in one APV
@@ -368,6 +563,50 @@ void GEMPedestal::GenerateAPVPedestal_using_vec()
     }
 }
 
+////////////////////////////////////////////////////////////////
+// generate pedestal for each APV using the dense strip statistics
+// strips are stored in order, so noise/offset vectors are indexed
+// by strip number
+
+void GEMPedestal::GenerateAPVPedestal_using_stat()
+{
+    // overall noise distribution
+    hOverallNoiseHisto = new TH1I("hOverallNoise", "RMS Noise", 400, 0, 400);
+
+    for(size_t slot=0; slot<fAPVStripStat.GetNSlots(); slot++)
+    {
+        const APVAddress &addr = fAPVStripStat.vAPV[slot];
+
+        TH1I *hNoise = new TH1I(
+                Form("noise_crate_%d_mpd_%d_ch_%d", addr.crate_id, addr.mpd_id, addr.adc_ch), 
+                Form("noise_crate_%d_mpd_%d_ch_%d_RMS", addr.crate_id, addr.mpd_id, addr.adc_ch), 
+                APV_STRIP_SIZE+20, -10, APV_STRIP_SIZE+10
+                );
+        TH1I *hOffset = new TH1I(
+                Form("offset_crate_%d_mpd_%d_ch_%d", addr.crate_id, addr.mpd_id, addr.adc_ch), 
+                Form("offset_crate_%d_mpd_%d_ch_%d", addr.crate_id, addr.mpd_id, addr.adc_ch), 
+                APV_STRIP_SIZE+20, -10, APV_STRIP_SIZE+10
+                );
+        mAPVNoiseHisto[addr] = hNoise;
+        mAPVOffsetHisto[addr] = hOffset;
+
+        auto &vNoise = mAPVNoise[addr];
+        auto &vOffset = mAPVOffset[addr];
+
+        for(int strip=0; strip<APV_STRIP_SIZE; strip++)
+        {
+            int noise = static_cast<int>(fAPVStripStat.vNoise[slot*APV_STRIP_SIZE + strip].GetRMS());
+            int offset = static_cast<int>(fAPVStripStat.vOffset[slot*APV_STRIP_SIZE + strip].GetMean());
+
+            hNoise -> SetBinContent(strip + 10, noise);
+            hOffset -> SetBinContent(strip + 10, offset);
+            vNoise.push_back(noise);
+            vOffset.push_back(offset);
+            hOverallNoiseHisto -> Fill(noise);
+        }
+    }
+}
+
 ////////////////////////////////////////////////////////////////
 // a helper: get mean of a vector (for offset calculation)
 
@@ -577,6 +816,8 @@ void GEMPedestal::Clear()
 
     for(auto &i: mAPVStripOffsetVec)
         i.second.clear();
+
+    fAPVStripStat.Clear();
 }
 
 
@@ -0,0 +1,234 @@
+#include "GEMRecluster.h"
+#include "GEMSystem.h"
+#include "GEMCluster.h"
+#include "GEMDataHandler.h"
+#include "GEMNativeHitFile.h"
+#include "GEMRootHitTree.h"
+#include "APVStripMapping.h"
+
+#include <TFile.h>
+#include <TTree.h>
+
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <memory>
+
+#define HIT_TREE_MAXHITS MAXHITS
+
+////////////////////////////////////////////////////////////////////////////////
+// ctor
+
+GEMRecluster::GEMRecluster(const std::string &config_file, int nthreads)
+{
+    // make sure mapping is loaded before any worker thread starts
+    apv_strip_mapping::Mapping::Instance();
+
+    if(nthreads < 1)
+        nthreads = 1;
+
+    for(int i=0; i<nthreads; i++) {
+        GEMSystem *sys = new GEMSystem(config_file);
+        sys -> SetReplayMode(true);
+        vGEMSystem.push_back(sys);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// dtor
+
+GEMRecluster::~GEMRecluster()
+{
+    for(auto &i: vGEMSystem)
+        delete i;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// set cluster configuration for all gem systems
+
+void GEMRecluster::SetClusterConfiguration(const std::string &path)
+{
+    for(auto &i: vGEMSystem)
+        i -> GetClusterMethod() -> Configure(path);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// re-cluster input file, save clusters to output root file
+
+int GEMRecluster::Run(const std::string &input, const std::string &output)
+{
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+    fUnmappedHits = 0;
+    vBatch.clear();
+    vBatch.reserve(fBatchSize);
+
+    GEMRootClusterTree tree(output.c_str());
+
+    int count = 0;
+    if(GEMDataHandler::IsSkimFile(input))
+        count = readNativeHitFile(input, tree);
+    else
+        count = readHitTree(input, tree);
+
+    // last batch
+    processBatch(tree);
+    tree.Write();
+
+    if(fUnmappedHits > 0)
+        std::cout<<__func__<<" Warning: "<<fUnmappedHits<<" hits cannot be mapped to "
+                 <<"an electronic channel, they were skipped."<<std::endl;
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    int _t = (int)std::chrono::duration_cast<std::chrono::seconds>(end - begin).count();
+    std::cout<<"Re-clustered "<<count<<" events";
+    std::cout<<" in "<< _t/60 <<" minutes "<<_t%60 <<" seconds"<<std::endl;
+
+    return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// read root hit tree (GEMRootHitTree), strips are mapped back to electronic
+// channels, since the hit tree does not save them
+
+int GEMRecluster::readHitTree(const std::string &path, GEMRootClusterTree &tree)
+{
+    // the file is closed and deleted on every return path
+    std::unique_ptr<TFile> f(new TFile(path.c_str(), "READ"));
+    if(f -> IsZombie()) {
+        std::cout<<__func__<<" Error: cannot open file: "<<path<<std::endl;
+        return 0;
+    }
+    TTree *t = (TTree*)f -> Get("GEMHit");
+    if(t == nullptr) {
+        std::cout<<__func__<<" Error: cannot find GEMHit tree in: "<<path<<std::endl;
+        return 0;
+    }
+
+    int evtID, nch;
+    std::vector<int> prod(HIT_TREE_MAXHITS), axis(HIT_TREE_MAXHITS), strip(HIT_TREE_MAXHITS);
+    std::vector<std::vector<int>> adc(HIT_TREE_TIME_SAMPLES, std::vector<int>(HIT_TREE_MAXHITS));
+
+    // only read the needed branches
+    t -> SetBranchStatus("*", 0);
+    for(auto &b: {"evtID", "nch", "prodID", "axis", "strip"})
+        t -> SetBranchStatus(b, 1);
+    t -> SetBranchAddress("evtID", &evtID);
+    t -> SetBranchAddress("nch", &nch);
+    t -> SetBranchAddress("prodID", prod.data());
+    t -> SetBranchAddress("axis", axis.data());
+    t -> SetBranchAddress("strip", strip.data());
+    for(int ts=0; ts<HIT_TREE_TIME_SAMPLES; ts++) {
+        std::string name = "adc" + std::to_string(ts);
+        t -> SetBranchStatus(name.c_str(), 1);
+        t -> SetBranchAddress(name.c_str(), adc[ts].data());
+    }
+
+    auto mapping = apv_strip_mapping::Mapping::Instance();
+
+    int count = 0;
+    Long64_t N = t -> GetEntries();
+    for(Long64_t i=0; i<N; i++)
+    {
+        t -> GetEntry(i);
+
+        EventData ev;
+        ev.event_number = evtID;
+        ev.gem_data.reserve(nch, HIT_TREE_TIME_SAMPLES);
+        for(int k=0; k<nch; k++)
+        {
+            GEMChannelAddress addr;
+            if(!mapping -> GetChannelAddress(prod[k], axis[k], strip[k], addr)) {
+                fUnmappedHits++;
+                continue;
+            }
+
+            float *values = ev.gem_data.add_hit(addr, HIT_TREE_TIME_SAMPLES);
+            for(int ts=0; ts<HIT_TREE_TIME_SAMPLES; ts++)
+                values[ts] = static_cast<float>(adc[ts][k]);
+        }
+
+        vBatch.push_back(std::move(ev));
+        count++;
+
+        if(vBatch.size() >= fBatchSize)
+            processBatch(tree);
+    }
+
+    f -> Close();
+    return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// read native hit file (skim)
+
+int GEMRecluster::readNativeHitFile(const std::string &path, GEMRootClusterTree &tree)
+{
+    GEMNativeHitReader reader;
+    if(!reader.Open(path.c_str()))
+        return 0;
+
+    int count = 0;
+    uint32_t nts = reader.GetTimeSamples();
+    NativeHitEvent nev;
+    for(uint64_t i=0; i<reader.GetEntries(); i++)
+    {
+        if(!reader.GetEvent(i, nev))
+            break;
+
+        EventData ev;
+        ev.event_number = nev.evtID;
+        ev.gem_data.reserve(nev.nch, nts);
+        for(uint32_t k=0; k<nev.nch; k++)
+        {
+            float *values = ev.gem_data.add_hit(nev.Address(k), nts);
+            for(uint32_t ts=0; ts<nts; ts++)
+                values[ts] = static_cast<float>(nev.ADC(k, ts));
+        }
+
+        vBatch.push_back(std::move(ev));
+        count++;
+
+        if(vBatch.size() >= fBatchSize)
+            processBatch(tree);
+    }
+
+    return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// reconstruct current batch in parallel, fill clusters in input order
+
+void GEMRecluster::processBatch(GEMRootClusterTree &tree)
+{
+    if(vBatch.empty())
+        return;
+
+    size_t N = vBatch.size();
+    size_t NThreads = vGEMSystem.size();
+    vBatchResult.resize(N);
+
+    // events are independent, ChooseEvent() clears all apvs before
+    // filling a new event, so the result does not depend on the thread
+    auto work = [&](const size_t &t)
+    {
+        GEMSystem *sys = vGEMSystem[t];
+        for(size_t i=t; i<N; i+=NThreads)
+        {
+            sys -> Reconstruct(vBatch[i]);
+            GEMRootClusterTree::Collect(sys, vBatch[i].event_number, vBatchResult[i]);
+        }
+    };
+
+    std::vector<std::thread> th;
+    for(size_t t=1; t<NThreads; t++)
+        th.emplace_back(work, t);
+    work(0);
+    for(auto &i: th)
+        i.join();
+
+    for(size_t i=0; i<N; i++)
+        tree.Fill(vBatchResult[i]);
+
+    vBatch.clear();
+}
@@ -0,0 +1,337 @@
+#include "GEMReplayStats.h"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+static const int NSTAGES = static_cast<int>(ReplayStage::Max);
+
+////////////////////////////////////////////////////////////////////////////////
+// ctor
+
+GEMReplayStats::GEMReplayStats()
+    : fInterval(std::chrono::seconds(1))
+{
+    Start();
+    bRunning = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// dtor
+
+GEMReplayStats::~GEMReplayStats()
+{
+    // place holder
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// reset all counters and start the clock
+
+void GEMReplayStats::Start()
+{
+    for(int i=0; i<NSTAGES; i++) {
+        fStageTime[i] = 0;
+        fStageCalls[i] = 0;
+        fLastStageTime[i] = 0;
+    }
+    fEvents = fBytes = 0;
+    fQueueSum = fQueueCount = 0;
+    fQueueMax = fQueueCapacity = 0;
+    fLastEvents = fLastBytes = 0;
+    fLastQueueSum = fLastQueueCount = 0;
+    fIntervalQueueMax = 0;
+    vSamples.clear();
+
+    if(fStream.is_open())
+        fStream.close();
+    if(!fStreamPath.empty()) {
+        fStream.open(fStreamPath);
+        if(!fStream.is_open())
+            std::cout<<__func__<<" Error: cannot open stats stream file: "<<fStreamPath<<std::endl;
+        else
+            writeSampleHeader(fStream);
+    }
+
+    fStart = fStop = fLastSample = clock::now();
+    bRunning = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// stop the clock, the last (partial) interval is also sampled
+
+void GEMReplayStats::Stop()
+{
+    if(!bRunning)
+        return;
+
+    fStop = clock::now();
+    if(fEvents > fLastEvents)
+        takeSample(fStop);
+    bRunning = false;
+
+    if(fStream.is_open())
+        fStream.close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// set sampling interval
+
+void GEMReplayStats::SetSampleInterval(double seconds)
+{
+    if(seconds <= 0.)
+        seconds = 1.;
+    fInterval = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// take a sample of the last interval
+
+void GEMReplayStats::takeSample(const clock::time_point &now)
+{
+    double dt = std::chrono::duration<double>(now - fLastSample).count();
+
+    Sample s;
+    s.time = std::chrono::duration<double>(now - fStart).count();
+    s.events = fEvents - fLastEvents;
+    if(dt > 0.) {
+        s.event_rate = s.events / dt;
+        s.mb_rate = (fBytes - fLastBytes) / dt / 1e6;
+    }
+    uint64_t nq = fQueueCount - fLastQueueCount;
+    if(nq > 0)
+        s.queue_avg = static_cast<double>(fQueueSum - fLastQueueSum) / nq;
+    s.queue_max = fIntervalQueueMax;
+    for(int i=0; i<NSTAGES; i++) {
+        s.stage_ms[i] = (fStageTime[i] - fLastStageTime[i]) / 1e6;
+        fLastStageTime[i] = fStageTime[i];
+    }
+
+    fLastSample = now;
+    fLastEvents = fEvents;
+    fLastBytes = fBytes;
+    fLastQueueSum = fQueueSum;
+    fLastQueueCount = fQueueCount;
+    fIntervalQueueMax = 0;
+
+    vSamples.push_back(s);
+
+    if(fStream.is_open()) {
+        writeSample(fStream, s);
+        fStream.flush();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// elapsed seconds, up to now if still running
+
+double GEMReplayStats::GetElapsed() const
+{
+    clock::time_point end = bRunning ? clock::now() : fStop;
+    return std::chrono::duration<double>(end - fStart).count();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// accumulated time of a stage in seconds
+
+double GEMReplayStats::GetStageTime(ReplayStage s) const
+{
+    return fStageTime[static_cast<int>(s)] / 1e9;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// stage name used in the outputs
+
+const char *GEMReplayStats::StageName(ReplayStage s)
+{
+    switch(s)
+    {
+    case ReplayStage::Read: return "read";
+    case ReplayStage::Parse: return "parse";
+    case ReplayStage::Decode: return "decode";
+    case ReplayStage::ZeroSup: return "zs";
+    case ReplayStage::Cluster: return "cluster";
+    case ReplayStage::Fill: return "fill";
+    case ReplayStage::Write: return "write";
+    case ReplayStage::Wait: return "wait";
+    default: break;
+    }
+    return "unknown";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// the stage that limits the replay speed
+// the replay thread runs read -> zs, the event process thread runs cluster
+// and fill, the busier thread limits the speed, the largest stage in it
+// is the limiting one
+
+ReplayStage GEMReplayStats::GetLimitingStage() const
+{
+    auto largest = [&](ReplayStage first, ReplayStage last) -> ReplayStage
+    {
+        int res = static_cast<int>(first);
+        for(int i=res; i<=static_cast<int>(last); i++)
+            if(fStageTime[i] > fStageTime[res])
+                res = i;
+        return static_cast<ReplayStage>(res);
+    };
+
+    uint64_t replay_busy = 0, process_busy = 0;
+    for(int i=static_cast<int>(ReplayStage::Read); i<=static_cast<int>(ReplayStage::ZeroSup); i++)
+        replay_busy += fStageTime[i];
+    for(int i=static_cast<int>(ReplayStage::Cluster); i<=static_cast<int>(ReplayStage::Fill); i++)
+        process_busy += fStageTime[i];
+
+    if(process_busy > replay_busy)
+        return largest(ReplayStage::Cluster, ReplayStage::Fill);
+    return largest(ReplayStage::Read, ReplayStage::ZeroSup);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// write summary, json if the path ends with .json, csv otherwise
+
+bool GEMReplayStats::WriteSummary(const std::string &path) const
+{
+    std::ofstream out(path);
+    if(!out.is_open()) {
+        std::cout<<__func__<<" Error: cannot open stats output file: "<<path<<std::endl;
+        return false;
+    }
+
+    const std::string suffix = ".json";
+    if(path.size() > suffix.size() &&
+       path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0)
+        WriteJSON(out);
+    else
+        WriteCSV(out);
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// json summary, with all samples
+
+void GEMReplayStats::WriteJSON(std::ostream &os) const
+{
+    double elapsed = GetElapsed();
+    double rate = elapsed > 0. ? fEvents / elapsed : 0.;
+    double mb_rate = elapsed > 0. ? fBytes / elapsed / 1e6 : 0.;
+
+    os<<"{"<<std::endl
+      <<"  \"events\": "<<fEvents<<","<<std::endl
+      <<"  \"bytes\": "<<fBytes<<","<<std::endl
+      <<"  \"elapsed_s\": "<<elapsed<<","<<std::endl
+      <<"  \"event_rate\": "<<rate<<","<<std::endl
+      <<"  \"mb_rate\": "<<mb_rate<<","<<std::endl
+      <<"  \"limiting_stage\": \""<<StageName(GetLimitingStage())<<"\","<<std::endl;
+
+    os<<"  \"stages\": {"<<std::endl;
+    for(int i=0; i<NSTAGES; i++)
+    {
+        double ms = fStageTime[i] / 1e6;
+        os<<"    \""<<StageName(static_cast<ReplayStage>(i))<<"\": {"
+          <<"\"total_ms\": "<<ms
+          <<", \"calls\": "<<fStageCalls[i]
+          <<", \"us_per_event\": "<<(fEvents > 0 ? ms * 1e3 / fEvents : 0.)
+          <<", \"fraction\": "<<(elapsed > 0. ? ms / 1e3 / elapsed : 0.)
+          <<"}"<<(i + 1 < NSTAGES ? "," : "")<<std::endl;
+    }
+    os<<"  },"<<std::endl;
+
+    os<<"  \"queue\": {"
+      <<"\"capacity\": "<<fQueueCapacity
+      <<", \"avg\": "<<(fQueueCount > 0 ? static_cast<double>(fQueueSum) / fQueueCount : 0.)
+      <<", \"max\": "<<fQueueMax
+      <<"},"<<std::endl;
+
+    os<<"  \"samples\": ["<<std::endl;
+    for(size_t k=0; k<vSamples.size(); k++)
+    {
+        const Sample &s = vSamples[k];
+        os<<"    {\"time\": "<<s.time
+          <<", \"events\": "<<s.events
+          <<", \"event_rate\": "<<s.event_rate
+          <<", \"mb_rate\": "<<s.mb_rate
+          <<", \"queue_avg\": "<<s.queue_avg
+          <<", \"queue_max\": "<<s.queue_max;
+        for(int i=0; i<NSTAGES; i++)
+            os<<", \""<<StageName(static_cast<ReplayStage>(i))<<"_ms\": "<<s.stage_ms[i];
+        os<<"}"<<(k + 1 < vSamples.size() ? "," : "")<<std::endl;
+    }
+    os<<"  ]"<<std::endl
+      <<"}"<<std::endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// csv summary, one line per stage, run totals in the comment lines
+
+void GEMReplayStats::WriteCSV(std::ostream &os) const
+{
+    double elapsed = GetElapsed();
+
+    os<<"# events = "<<fEvents<<", bytes = "<<fBytes<<", elapsed_s = "<<elapsed
+      <<", event_rate = "<<(elapsed > 0. ? fEvents / elapsed : 0.)
+      <<", mb_rate = "<<(elapsed > 0. ? fBytes / elapsed / 1e6 : 0.)<<std::endl
+      <<"# queue capacity = "<<fQueueCapacity
+      <<", avg = "<<(fQueueCount > 0 ? static_cast<double>(fQueueSum) / fQueueCount : 0.)
+      <<", max = "<<fQueueMax
+      <<", limiting stage = "<<StageName(GetLimitingStage())<<std::endl;
+
+    os<<"stage,total_ms,calls,us_per_event,fraction"<<std::endl;
+    for(int i=0; i<NSTAGES; i++)
+    {
+        double ms = fStageTime[i] / 1e6;
+        os<<StageName(static_cast<ReplayStage>(i))<<","<<ms<<","<<fStageCalls[i]<<","
+          <<(fEvents > 0 ? ms * 1e3 / fEvents : 0.)<<","
+          <<(elapsed > 0. ? ms / 1e3 / elapsed : 0.)<<std::endl;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// print a short table
+
+void GEMReplayStats::Print(std::ostream &os) const
+{
+    double elapsed = GetElapsed();
+    std::ios_base::fmtflags flags = os.flags();
+
+    os<<"Replay stats: "<<fEvents<<" events, "
+      <<std::fixed<<std::setprecision(1)
+      <<(elapsed > 0. ? fEvents / elapsed : 0.)<<" events/s, "
+      <<(elapsed > 0. ? fBytes / elapsed / 1e6 : 0.)<<" MB/s"<<std::endl;
+    for(int i=0; i<NSTAGES; i++)
+    {
+        if(fStageCalls[i] == 0)
+            continue;
+        double ms = fStageTime[i] / 1e6;
+        os<<"    "<<std::left<<std::setw(8)<<StageName(static_cast<ReplayStage>(i))<<std::right
+          <<std::setw(12)<<ms<<" ms"
+          <<std::setw(10)<<(fEvents > 0 ? ms * 1e3 / fEvents : 0.)<<" us/event"
+          <<std::setw(8)<<(elapsed > 0. ? ms / 10. / elapsed : 0.)<<" %"<<std::endl;
+    }
+    os<<"    limiting stage: "<<StageName(GetLimitingStage())<<std::endl;
+
+    os.flags(flags);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// csv header of the samples
+
+void GEMReplayStats::writeSampleHeader(std::ostream &os) const
+{
+    os<<"time,events,event_rate,mb_rate,queue_avg,queue_max";
+    for(int i=0; i<NSTAGES; i++)
+        os<<","<<StageName(static_cast<ReplayStage>(i))<<"_ms";
+    os<<std::endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// one csv line of a sample
+
+void GEMReplayStats::writeSample(std::ostream &os, const Sample &s) const
+{
+    os<<s.time<<","<<s.events<<","<<s.event_rate<<","<<s.mb_rate<<","
+      <<s.queue_avg<<","<<s.queue_max;
+    for(int i=0; i<NSTAGES; i++)
+        os<<","<<s.stage_ms[i];
+    os<<std::endl;
+}
@@ -63,11 +63,17 @@ void GEMRootClusterTree::Fill(GEMSystem *gem_sys, const uint32_t &evt_num)
     if(cluster_method == nullptr)
         cluster_method = new GEMCluster("config/gem_cluster.conf");
 
-    [[maybe_unused]]int ndet = apv_strip_mapping::Mapping::Instance()->GetTotalNumberOfDetectors();
+    Collect(gem_sys, evt_num, fEvent);
+    Fill(fEvent);
+}
 
-    // set event id
-    evtID = static_cast<int>(evt_num);
-    nCluster = 0;
+// extract clusters of the current event from gem system
+
+void GEMRootClusterTree::Collect(GEMSystem *gem_sys, const uint32_t &evt_num,
+        ClusterTreeEvent &ev)
+{
+    ev.Clear();
+    ev.evtID = static_cast<int>(evt_num);
 
     // get detector list
     std::vector<GEMDetector*> detectors = gem_sys -> GetDetectorList();
@@ -80,34 +86,63 @@ void GEMRootClusterTree::Fill(GEMSystem *gem_sys, const uint32_t &evt_num)
             const std::vector<StripCluster> & clusters = pln -> GetStripClusters();
             int napvs_per_plane = pln -> GetCapacity();
             for(auto &c: clusters) {
-                Plane[nCluster] = i -> GetLayerID();
-                Prod[nCluster] = i -> GetDetID();
-                Module[nCluster] = i -> GetDetLayerPositionIndex();
-                Axis[nCluster] = static_cast<int>(pln -> GetType());
-                Size[nCluster] = c.hits.size();
-                Adc[nCluster] = c.peak_charge;
-                Pos[nCluster] = c.position;
+                int axis = static_cast<int>(pln -> GetType());
+                int module = i -> GetDetLayerPositionIndex();
+
+                ev.plane.push_back(i -> GetLayerID());
+                ev.prod.push_back(i -> GetDetID());
+                ev.module.push_back(module);
+                ev.axis.push_back(axis);
+                ev.size.push_back(c.hits.size());
+                ev.adc.push_back(c.peak_charge);
+                ev.pos.push_back(c.position);
 
                 // strips in this cluster
                 const std::vector<StripHit> &hits = c.hits;
-                for(size_t nS = 0; nS < hits.size() && nS < 100; ++nS)
+                for(size_t nS = 0; nS < hits.size() && nS < MAXCLUSTERSIZE; ++nS)
                 {
                     // layer based strip no
-                    //StripNo[nCluster][nS] = hits[nS].strip;
+                    //ev.strip_no.push_back(hits[nS].strip);
 
                     // chamber based strip no
-                    StripNo[nCluster][nS] = getChamberBasedStripNo(hits[nS].strip, Axis[nCluster],
-                           napvs_per_plane, Module[nCluster]);
+                    ev.strip_no.push_back(getChamberBasedStripNo(hits[nS].strip, axis,
+                           napvs_per_plane, module));
  
-                    StripADC[nCluster][nS] = hits[nS].charge;
+                    ev.strip_adc.push_back(hits[nS].charge);
                 }
-
-                nCluster++;
-                if(nCluster >= MAXCLUSTERS)
-                    break;
+                ev.strip_offset.push_back(ev.strip_no.size());
             }
         }
     }
+}
+
+// fill one event
+
+void GEMRootClusterTree::Fill(const ClusterTreeEvent &ev)
+{
+    evtID = ev.evtID;
+    nCluster = 0;
+
+    int N = ev.GetNClusters();
+    for(int i=0; i<N && nCluster < MAXCLUSTERS; ++i)
+    {
+        Plane[nCluster] = ev.plane[i];
+        Prod[nCluster] = ev.prod[i];
+        Module[nCluster] = ev.module[i];
+        Axis[nCluster] = ev.axis[i];
+        Size[nCluster] = ev.size[i];
+        Adc[nCluster] = ev.adc[i];
+        Pos[nCluster] = ev.pos[i];
+
+        size_t begin = ev.strip_offset[i], nstrips = ev.strip_offset[i+1] - begin;
+        for(size_t nS = 0; nS < nstrips; ++nS)
+        {
+            StripNo[nCluster][nS] = ev.strip_no[begin + nS];
+            StripADC[nCluster][nS] = ev.strip_adc[begin + nS];
+        }
+
+        nCluster++;
+    }
 
     if(nCluster > 0)
         pTree -> Fill();
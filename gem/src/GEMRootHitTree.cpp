@@ -1,6 +1,7 @@
 #include "GEMRootHitTree.h"
 #include "APVStripMapping.h"
 #include "PreAnalysis.h"
+#include <algorithm>
 
 ////////////////////////////////////////////////////////////////////////////////
 // ctor
@@ -19,13 +20,10 @@ GEMRootHitTree::GEMRootHitTree(const char* path)
     pTree->Branch("axis",Axis,"axis[nch]/I");
     pTree->Branch("strip",Strip,"strip[nch]/I");
 
-    pTree->Branch("adc0",adc0,"adc0[nch]/I");
-    pTree->Branch("adc1",adc1,"adc1[nch]/I");
-    pTree->Branch("adc2",adc2,"adc2[nch]/I");
-
-    pTree->Branch("adc3",adc3,"adc3[nch]/I");
-    pTree->Branch("adc4",adc4,"adc4[nch]/I");
-    pTree->Branch("adc5",adc5,"adc5[nch]/I");
+    for(int ts=0; ts<HIT_TREE_TIME_SAMPLES; ts++) {
+        std::string name = "adc" + std::to_string(ts);
+        pTree->Branch(name.c_str(), adc[ts], (name + "[nch]/I").c_str());
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -61,7 +59,7 @@ void GEMRootHitTree::Write()
 
 void GEMRootHitTree::Fill(GEMSystem *gem_sys, const EventData &ev)
 {
-    const std::vector<GEM_Strip_Data> &strip_data = ev.get_gem_data();
+    const GEMStripHits &strip_data = ev.get_gem_data();
     evtID = ev.event_number;
     nch = strip_data.size();
    
@@ -69,16 +67,17 @@ void GEMRootHitTree::Fill(GEMSystem *gem_sys, const EventData &ev)
     if(nch > MAXHITS)
         nch = MAXHITS;
 
+    // hit tree keeps HIT_TREE_TIME_SAMPLES, missing ones are 0
     for(int i=0;i<nch;i++)
     {
-        adc0[i] = static_cast<int>(strip_data[i].values[0]);
-        adc1[i] = static_cast<int>(strip_data[i].values[1]);
-        adc2[i] = static_cast<int>(strip_data[i].values[2]);
-        adc3[i] = static_cast<int>(strip_data[i].values[3]);
-        adc4[i] = static_cast<int>(strip_data[i].values[4]);
-        adc5[i] = static_cast<int>(strip_data[i].values[5]);
-
-        GEMChannelAddress addr = strip_data[i].addr;
+        const float *values = strip_data.values(i);
+        uint32_t nts = std::min(strip_data.time_samples(i), static_cast<uint32_t>(HIT_TREE_TIME_SAMPLES));
+        for(uint32_t ts=0; ts<nts; ts++)
+            adc[ts][i] = static_cast<int>(values[ts]);
+        for(uint32_t ts=nts; ts<HIT_TREE_TIME_SAMPLES; ts++)
+            adc[ts][i] = 0;
+
+        GEMChannelAddress addr = strip_data.address(i);
 
         Plane[i] = apv_strip_mapping::Mapping::Instance()->GetPlaneID(addr);
         Prod[i] = apv_strip_mapping::Mapping::Instance()->GetProdID(addr);
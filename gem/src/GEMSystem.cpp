@@ -24,6 +24,7 @@
 #include "GEMMPD.h"
 #include "GEMDetectorLayer.h"
 #include "GEMException.h"
+#include "hardcode.h"
 
 //============================================================================//
 // constructor, assigment operator, destructor                                //
@@ -33,7 +34,8 @@
 // constructor
 
 GEMSystem::GEMSystem(const std::string &config_file, int mpd_cap, int det_cap)
-: PedestalMode(false), def_ts(6), def_cth(20.), def_zth(5.), def_ctth(8.)
+: PedestalMode(false), def_ts(6), def_cth(20.), def_zth(5.), def_ctth(8.),
+  def_int(false)
 {
     mpd_slots.reserve(mpd_cap);
     det_slots.reserve(det_cap);
@@ -52,7 +54,7 @@ GEMSystem::GEMSystem(const GEMSystem &that)
 : ConfigObject(that),
   gem_recon(that.gem_recon), PedestalMode(that.PedestalMode),
   def_ts(that.def_ts), def_cth(that.def_cth), def_zth(that.def_zth),
-  def_ctth(that.def_ctth)
+  def_ctth(that.def_ctth), def_int(that.def_int)
 {
     // copy daq system first
     for(auto &mpd : that.mpd_slots)
@@ -98,7 +100,8 @@ GEMSystem::GEMSystem(GEMSystem &&that)
   gem_recon(std::move(that.gem_recon)), PedestalMode(that.PedestalMode),
   mpd_slots(std::move(that.mpd_slots)), det_slots(std::move(that.det_slots)),
   det_name_map(std::move(that.det_name_map)), def_ts(that.def_ts),
-  def_cth(that.def_cth), def_zth(that.def_zth), def_ctth(that.def_ctth)
+  def_cth(that.def_cth), def_zth(that.def_zth), def_ctth(that.def_ctth),
+  def_int(that.def_int)
 {
     // reset the system for all components
     for(auto &mpd : mpd_slots)
@@ -163,6 +166,7 @@ GEMSystem &GEMSystem::operator =(GEMSystem &&rhs)
     def_cth = rhs.def_cth;
     def_zth = rhs.def_zth;
     def_ctth = rhs.def_ctth;
+    def_int = rhs.def_int;
 
     // reset the system for all components
     for(auto &mpd : mpd_slots)
@@ -201,6 +205,18 @@ void GEMSystem::Configure(const std::string &path)
     CONF_CONN(def_zth, "Default Zero Suppression Threshold", 5, verbose);
     CONF_CONN(def_ctth, "Default Cross Talk Threshold", 8, verbose);
 
+    // int16 fixed point processing of mpd frames, checked once here instead
+    // of for every APV
+    def_int = (Value<std::string>("APV Integer Processing") == "on");
+#ifndef DANNING_ALGORITHM
+    if(def_int) {
+        std::cout << "GEM System Warning: APV integer processing needs "
+                  << "DANNING_ALGORITHM common mode, use float processing."
+                  << std::endl;
+        def_int = false;
+    }
+#endif
+
     gem_recon.Configure(Value<std::string>("GEM Cluster Configuration"));
 
     // read gem map, build DAQ system and detectors
@@ -713,18 +729,30 @@ void GEMSystem::FillZeroSupData(const GEMZeroSupData &data)
 // only works for replayed data
 void GEMSystem::ChooseEvent(const EventData &data)
 {
-    // clear all the APVs' hits
+    // clear all the APVs' hits, only the APVs touched since the last clear
+    // do real work (see GEMAPV::ClearData)
     for(auto &mpd : mpd_slots)
     {
         if(mpd.second)
             mpd.second->APVControl(&GEMAPV::ClearData);
     }
 
-    for(auto &hit : data.gem_data)
+    // hits are collected apv by apv, only look up the apv when it changes
+    // each hit is filled with its own time samples, so the apv still rejects
+    // hits that do not match its setting
+    const GEMStripHits &hits = data.gem_data;
+    GEMAPV *apv = nullptr;
+    uint32_t apv_addr = 0;
+    for(size_t i = 0; i < hits.size(); ++i)
     {
-        auto apv = GetAPV(hit.addr.crate, hit.addr.mpd, hit.addr.adc);
+        if(i == 0 || (hits.addr[i] & ~0xffu) != apv_addr) {
+            apv_addr = hits.addr[i] & ~0xffu;
+            GEMChannelAddress a = UnpackChannelAddress(apv_addr);
+            apv = GetAPV(a.crate, a.mpd, a.adc);
+        }
         if(apv)
-            apv->FillZeroSupData(hit.addr.strip, hit.values);
+            apv->FillZeroSupData(hits.addr[i] & 0xff, hits.values(i),
+                    hits.time_samples(i));
     }
 
     for(auto &det : det_slots)
@@ -845,10 +873,10 @@ void GEMSystem::SetReplayMode(const bool &m)
 }
 
 // collect the zero suppressed data from APV
-std::vector<GEM_Strip_Data> GEMSystem::GetZeroSupData()
+GEMStripHits GEMSystem::GetZeroSupData()
 const
 {
-    std::vector<GEM_Strip_Data> gem_data;
+    GEMStripHits gem_data;
 
     for(auto &mpd : mpd_slots)
     {
@@ -889,6 +917,25 @@ void GEMSystem::SetUnivTimeSample(const uint32_t &ts)
     }
 }
 
+// change the integer (fixed point) processing for all APVs
+void GEMSystem::SetUnivIntegerProcessing(const bool &m)
+{
+#ifndef DANNING_ALGORITHM
+    if(m) {
+        std::cout << "GEM System Warning: APV integer processing needs "
+                  << "DANNING_ALGORITHM common mode, use float processing."
+                  << std::endl;
+        return;
+    }
+#endif
+
+    for(auto &mpd : mpd_slots)
+    {
+        if(mpd.second)
+            mpd.second->APVControl(&GEMAPV::SetIntegerProcessing, m);
+    }
+}
+
 // save all APVs' histograms into a root file
 void GEMSystem::SaveHistograms(const std::string &path)
 const
@@ -1154,6 +1201,10 @@ void GEMSystem::buildAPV(std::list<ConfigValue> &apv_args)
         return;
     }
 
+    // int16 fixed point processing of mpd frames
+    if(def_int)
+        new_apv->SetIntegerProcessing(true);
+
     // trying to connect to Plane
     GEMDetector *det = GetDetector(det_name);
     if(det == nullptr) {
@@ -12,22 +12,24 @@ PreAnalysis* PreAnalysis::instance = nullptr;
 
 void PreAnalysis::UpdateEvent(const EventData &ev)
 {
-    const std::vector<GEM_Strip_Data> &gem_strip_data
-        = ev.get_gem_data();
+    const GEMStripHits &gem_strip_data = ev.get_gem_data();
 
-    for(auto &i: gem_strip_data)
+    for(size_t i=0; i<gem_strip_data.size(); i++)
     {
+        size_t nts = gem_strip_data.time_samples(i);
         // per APV
-        APVAddress ad(i.addr.crate, i.addr.mpd, i.addr.adc);
+        GEMChannelAddress a = gem_strip_data.address(i);
+        const float *values = gem_strip_data.values(i);
+        APVAddress ad(a.crate, a.mpd, a.adc);
         if(timeSampleAPVCheck.find(ad) == timeSampleAPVCheck.end()) 
         {
-            for(size_t ts=0;ts<i.values.size();ts++) {
-                timeSampleAPVCheck[ad].push_back((i.values)[ts]);
+            for(size_t ts=0;ts<nts;ts++) {
+                timeSampleAPVCheck[ad].push_back(values[ts]);
             }
             apvEntries[ad] = 1.0;
         } else {
-            for(size_t ts=0;ts<i.values.size();ts++) {
-                (timeSampleAPVCheck[ad])[ts] += (i.values)[ts];
+            for(size_t ts=0;ts<nts;ts++) {
+                (timeSampleAPVCheck[ad])[ts] += values[ts];
             }
             apvEntries[ad] += 1.0;
         }
@@ -83,6 +83,10 @@ HEADERS += include/QRootCanvas.h \
            include/HistoWidget.h \
            include/InfoCenter.h \
            include/ColorSpectrum.h \
+           include/EventPrefetcher.h \
+           include/ReplayJobQueue.h \
+           include/TripleBuffer.h \
+           include/OnlineAccumulator.h \
 
 SOURCES += src/main.cpp \
            src/QRootCanvas.cpp \
@@ -98,3 +102,6 @@ SOURCES += src/main.cpp \
            src/HistoWidget.cpp \
            src/InfoCenter.cpp \
            src/ColorSpectrum.cpp \
+           src/EventPrefetcher.cpp \
+           src/ReplayJobQueue.cpp \
+           src/OnlineAccumulator.cpp \
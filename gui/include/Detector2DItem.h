@@ -11,6 +11,7 @@
 #include <QPainter>
 #include <QStyleOptionGraphicsItem>
 #include <vector>
+#include <utility>
 
 class ColorSpectrum;
 
@@ -46,11 +47,14 @@ public:
         for(auto &i: _y_strips) {
             y_strips.emplace_back(static_cast<int>(i.first), static_cast<float>(i.second));
         }
+        bGeometryChanged = true;
     }
 
 protected:
     QVector<std::pair<QLineF, QColor>> PrepareStrips();
     void UpdateDrawingRange();
+    // rebuild cached strip lines if data or size changed
+    void UpdateGeometry();
     void DrawAxis(QPainter *painter);
     void DrawContent(QPainter *painter);
     void Clear();
@@ -89,6 +93,11 @@ private:
     // convert value to rgb color
     ColorSpectrum *color_spectrum;
 
+    // cached strip lines grouped by color, only rebuilt when contents,
+    // strip range/angle or bounding rect change
+    bool bGeometryChanged = true;
+    std::vector<std::pair<QColor, QVector<QLineF>>> vStripGroups;
+
     // for debug color spectrum only
     int x_strip_max_adc, x_strip_max_adc_index;
     int y_strip_max_adc, y_strip_max_adc_index;
@@ -0,0 +1,116 @@
+#ifndef EVENT_PREFETCHER_H
+#define EVENT_PREFETCHER_H
+
+#include "MPDDataStruct.h"
+#include "GEMStruct.h"
+
+#include <map>
+#include <set>
+#include <vector>
+#include <string>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class GEMAnalyzer;
+class GEMSystem;
+
+////////////////////////////////////////////////////////////////////////////////
+// raw apv data of one event, sorted by apv address
+
+typedef std::map<APVAddress, std::vector<int>> APVRawEvent;
+
+////////////////////////////////////////////////////////////////////////////////
+// zero suppressed strip hits on one detector
+
+struct DetectorOnlineHits
+{
+    int layer_id = -1;
+    int chamber_pos = -1;
+    int x_apvs = 0;
+    int y_apvs = 0;
+    std::vector<StripHit> x_hits;
+    std::vector<StripHit> y_hits;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// one decoded and zero suppressed event for the viewer
+// events are immutable once they are in the cache, the cache and the gui
+// share them through shared_ptr, nothing is copied when drawing
+
+struct ViewerEvent
+{
+    int event_number = 0;
+    std::shared_ptr<const APVRawEvent> raw;
+    std::vector<DetectorOnlineHits> online_hits;
+};
+
+typedef std::shared_ptr<const ViewerEvent> ViewerEventPtr;
+
+////////////////////////////////////////////////////////////////////////////////
+// decode and zero suppress events ahead of the viewer cursor
+//
+// a worker thread reads the file sequentially and keeps up to 'depth' events
+// ahead of the current event ready in the cache, 'depth' events behind the
+// current event are kept for stepping backward. The GEMAnalyzer and the
+// GEMSystem passed in are used by the worker thread only.
+
+class EventPrefetcher
+{
+public:
+    EventPrefetcher(GEMAnalyzer *analyzer, GEMSystem *gem_sys, size_t depth = 10);
+    ~EventPrefetcher();
+
+    EventPrefetcher(const EventPrefetcher &) = delete;
+    EventPrefetcher &operator=(const EventPrefetcher &) = delete;
+
+    void Start();
+    void Stop();
+
+    // restart from the first event of a new file
+    void SetFile(const std::string &path);
+    // (re)load pedestal, cached events are zero suppressed again
+    void SetPedestal(const std::string &pedestal, const std::string &common_mode);
+    void SetDepth(size_t depth);
+    size_t GetDepth() const {return fDepth;}
+
+    // get event by its sequence number in file (starting from 1)
+    // blocks only if the event has not been prefetched yet
+    // returns nullptr if the event is no longer cached or beyond end of file
+    ViewerEventPtr GetEvent(int num);
+
+private:
+    void run();
+    ViewerEventPtr zeroSuppress(int num, const std::shared_ptr<const APVRawEvent> &raw);
+    void reprocessCache(std::unique_lock<std::mutex> &lk);
+    void evict();
+
+private:
+    GEMAnalyzer *pAnalyzer;
+    GEMSystem *pGEMSystem;
+    size_t fDepth;
+
+    std::thread worker;
+    std::mutex mtx;
+    std::condition_variable cv_worker; // wake up worker
+    std::condition_variable cv_gui;    // new event available
+
+    // cached events, keyed by sequence number
+    std::map<int, ViewerEventPtr> mCache;
+    int fCursor = 0;     // event the gui is looking at
+    int fNextEvent = 1;  // next event the worker reads
+    bool bEndOfFile = false;
+    bool bStop = true;
+
+    // pedestal for zero suppression
+    std::string fPedestalPath;
+    std::string fCommonModePath;
+    bool bPedestalChanged = false;
+    bool bReprocessing = false;
+
+    // apvs in data but not in mapping, only warn once
+    std::set<APVAddress> sMissingAPV;
+};
+
+#endif
@@ -2,17 +2,27 @@
 #define GEM_ANALYZER_H_
 
 #include "EvioFileReader.h"
+#include "EvioLiveReader.h"
 #include "EventParser.h"
 #include "MPDVMERawEventDecoder.h"
 #include "MPDSSPRawEventDecoder.h"
 #include "MPDDataStruct.h"
 #include "hardcode.h"
 
-#include <TH1I.h>
-
 #include <string>
+#include <vector>
 #include <unordered_map>
 
+////////////////////////////////////////////////////////////////////////////////
+// one decoded apv frame, the adc words are in GEMAnalyzer's flat buffer
+
+struct APVFrame
+{
+    APVAddress addr;
+    size_t offset;  // first adc word in the buffer
+    size_t size;    // number of adc words
+};
+
 class GEMAnalyzer
 {
 public:
@@ -20,10 +30,11 @@ public:
     ~GEMAnalyzer();
 
     void Init();
-    void AnalyzeEvent(int event);
-    const std::unordered_map<APVAddress, TH1I*> & GetHistos() const;
-    const std::unordered_map<APVAddress, std::vector<int>> & GetData() const;
-    void FillHistos(const std::unordered_map<APVAddress, std::vector<int>> &);
+    bool AnalyzeEvent(int event);
+    // decoded frames of the current event, valid until next AnalyzeEvent()
+    const std::vector<APVFrame> & GetFrames() const {return vFrames;}
+    const int * GetFrameData(const APVFrame &f) const {return vFrameBuffer.data() + f.offset;}
+    void FillFrames(const std::unordered_map<APVAddress, std::vector<int>> &);
     void Clear();
     void ClearPreviousEvent();
     void GeneratePedestal(const char*);
@@ -33,8 +44,17 @@ public:
     void SetMaxEvents(uint32_t);
     void CloseFile();
 
+    // follow a file that is still being written (and its next splits),
+    // must be set before Init()
+    void SetLiveMode(bool live) {bLiveMode = live;}
+    bool IsLiveMode() const {return bLiveMode;}
+    // thread safe, stop waiting for live data
+    void Interrupt();
+
 private:
-    EvioFileReader *pFileReader;
+    EvioFileReader *pFileReader = nullptr;
+    EvioLiveReader *pLiveReader = nullptr;
+    bool bLiveMode = false;
     EventParser *pEventParser;
 #ifdef USE_VME
     MPDVMERawEventDecoder *pRawEventDecoder;
@@ -44,8 +64,10 @@ private:
 
     std::string fFile;
     uint32_t nEvents = 5000;
-    std::unordered_map<APVAddress, std::vector<int>> rawData;
-    std::unordered_map<APVAddress, TH1I*> rawHistos;
+    // all adc words of the current event, the memory is reused event by event,
+    // root histograms are only made by QMainCanvas when the user asks for one
+    std::vector<int> vFrameBuffer;
+    std::vector<APVFrame> vFrames;
 };
 
 #endif
@@ -35,10 +35,13 @@ public:
         {
             // clear last drawing
             _contents.clear();
+            _contents.reserve(v.size());
 
             for(auto &i: v) {
                 _contents.push_back(static_cast<float>(i));
             }
+
+            bGeometryChanged = true;
         }
 
     // convert logical (data) coordinates to QGraphicsItem (drawing) coordinates
@@ -62,12 +65,14 @@ public:
     QPolygonF PrepareContentShape();
     QVector<QLineF> PrepareAxis();
     void UpdateRange();
+    // rebuild cached geometry if data or size changed
+    void UpdateGeometry();
 
     void PassQMainCanvasPointer(QMainCanvas*);
     void Clear();
 
     // a helper
-    void DrawAxisMarks(QPainter *painter);
+    void PrepareAxisMarks();
     void SetTitle(const std::string &s);
 
 protected:
@@ -87,6 +92,13 @@ private:
     float data_x_min, data_x_max, data_y_min, data_y_max;
     // drawing range
     float area_x1, area_x2, area_y1, area_y2;
+
+    // cached geometry, only rebuilt when contents or bounding rect change
+    bool bGeometryChanged = true;
+    QPolygonF _shape;
+    QVector<QLineF> _axis;
+    QVector<QLineF> _axisMarks;
+    std::vector<std::pair<QPointF, QString>> _axisLabels;
 };
 
 #endif
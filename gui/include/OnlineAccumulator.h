@@ -0,0 +1,99 @@
+#ifndef ONLINE_ACCUMULATOR_H
+#define ONLINE_ACCUMULATOR_H
+
+#include "MPDDataStruct.h"
+#include "TripleBuffer.h"
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <thread>
+#include <atomic>
+
+class GEMAnalyzer;
+class GEMSystem;
+class GEMDetector;
+
+////////////////////////////////////////////////////////////////////////////////
+// common mode distribution binning (after pedestal offset subtraction)
+
+#define ONLINE_CM_BINS 100
+#define ONLINE_CM_LOW -200.
+#define ONLINE_CM_HIGH 200.
+
+////////////////////////////////////////////////////////////////////////////////
+// statistics accumulated over all events since the accumulation started
+
+struct OnlineStats
+{
+    uint64_t events = 0;
+    double rate = 0.;       // events per second
+    bool running = false;
+
+    // strip occupancy of each detector plane, same order as
+    // GEMSystem::GetDetectorList(), x strips are local to the chamber
+    std::vector<int> layer_id;
+    std::vector<int> chamber_pos;
+    std::vector<std::vector<uint32_t>> x_occupancy;
+    std::vector<std::vector<uint32_t>> y_occupancy;
+
+    // per apv
+    std::vector<APVAddress> apvs;
+    std::vector<uint64_t> apv_hits;          // fired strips
+    std::vector<double> common_mode_sum;     // all time samples
+    std::vector<uint64_t> common_mode_count;
+    std::vector<uint32_t> common_mode_hist;  // apv * ONLINE_CM_BINS + bin
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// decode, zero suppress and accumulate all events of a file in a worker
+// thread at full speed. A snapshot of the statistics is published a few
+// times per second through a lock-free triple buffer, the gui picks up the
+// latest one whenever it redraws.
+
+class OnlineAccumulator
+{
+public:
+    OnlineAccumulator(const std::string &config_file = "config/gem.conf");
+    ~OnlineAccumulator();
+
+    OnlineAccumulator(const OnlineAccumulator &) = delete;
+    OnlineAccumulator &operator=(const OnlineAccumulator &) = delete;
+
+    void SetPedestal(const std::string &pedestal, const std::string &common_mode);
+    // follow a file still being written by the daq, used at next Start()
+    void SetLiveMode(bool live) {bLiveMode = live;}
+    // statistics restart from 0 every time it starts
+    void Start(const std::string &file);
+    void Stop();
+    bool IsRunning() const {return bRunning;}
+
+    // gui side, lock-free, return true if there is a new snapshot
+    bool Update() {return fSnapshot.Update();}
+    const OnlineStats &GetStats() const {return fSnapshot.GetReadBuffer();}
+
+private:
+    void run(std::string file);
+    void initStats();
+    void accumulate();
+    void publish();
+
+private:
+    GEMAnalyzer *pAnalyzer;
+    GEMSystem *pGEMSystem;
+    std::string fPedestalPath;
+    std::string fCommonModePath;
+    bool bLiveMode = false;
+
+    std::thread worker;
+    std::atomic<bool> bStop{false};
+    std::atomic<bool> bRunning{false};
+
+    // worker side statistics
+    OnlineStats fStats;
+    std::unordered_map<APVAddress, size_t> mAPVIndex;
+    std::vector<GEMDetector*> vDetectors;
+    TripleBuffer<OnlineStats> fSnapshot;
+};
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef REPLAY_JOB_QUEUE_H
+#define REPLAY_JOB_QUEUE_H
+
+#include <QObject>
+#include <QString>
+
+#include <deque>
+#include <string>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+////////////////////////////////////////////////////////////////////////////////
+// run long jobs (replay, pedestal) one after another in a worker thread,
+// so the gui is never blocked
+//
+// signals are emitted from the worker thread, connections to gui objects
+// are queued by Qt automatically
+
+class ReplayJobQueue : public QObject
+{
+    Q_OBJECT
+public:
+    ReplayJobQueue(QObject *parent = nullptr);
+    ~ReplayJobQueue();
+
+    // 'cancel' is called from the gui thread to stop the job while it runs
+    // 'reset' is called before the job is marked running, to clear the
+    // cancel state left by the previous job
+    void Enqueue(const std::string &name, std::function<void()> job,
+            std::function<void()> cancel = nullptr,
+            std::function<void()> reset = nullptr);
+    void CancelCurrent();
+    void ClearPending();
+
+    int GetPendingJobs();
+    bool IsBusy();
+
+    // for jobs to report progress
+    void ReportProgress(const QString &text);
+
+signals:
+    void jobStarted(const QString &name, int pending);
+    void jobFinished(const QString &name, bool cancelled, int pending);
+    void progressUpdated(const QString &text);
+
+private:
+    void run();
+
+private:
+    struct Job
+    {
+        std::string name;
+        std::function<void()> run;
+        std::function<void()> cancel;
+        std::function<void()> reset;
+    };
+
+    std::thread worker;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<Job> jobs;
+    Job current;
+    bool bBusy = false;
+    bool bCancelled = false;
+    bool bStop = false;
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+////////////////////////////////////////////////////////////////////////////////
+// A lock-free triple buffer, one writer thread and one reader thread
+//
+// The writer fills GetWriteBuffer() and calls Publish(), the reader calls
+// Update() and then uses GetReadBuffer(). Neither side ever waits, the
+// reader always sees the latest complete snapshot.
+
+#include <atomic>
+#include <cstdint>
+
+template<typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() {}
+
+    TripleBuffer(const TripleBuffer &) = delete;
+    TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+    // writer side
+    T &GetWriteBuffer() {return buffer[back];}
+
+    void Publish()
+    {
+        // hand the back buffer over, take the middle one to write next
+        uint8_t prev = middle.exchange(back | DIRTY, std::memory_order_acq_rel);
+        back = prev & INDEX;
+    }
+
+    // reader side, return true if a new snapshot is available
+    bool Update()
+    {
+        if((middle.load(std::memory_order_relaxed) & DIRTY) == 0)
+            return false;
+
+        uint8_t prev = middle.exchange(front, std::memory_order_acq_rel);
+        front = prev & INDEX;
+        return true;
+    }
+
+    const T &GetReadBuffer() const {return buffer[front];}
+
+private:
+    static constexpr uint8_t INDEX = 0x3;
+    static constexpr uint8_t DIRTY = 0x4;
+
+    T buffer[3];
+    uint8_t back = 0;               // writer only
+    uint8_t front = 1;              // reader only
+    std::atomic<uint8_t> middle{2}; // shared
+};
+
+#endif
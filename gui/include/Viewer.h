@@ -9,6 +9,9 @@
 #include "ConfigObject.h"
 #include "HistoWidget.h"
 #include "Detector2DView.h"
+#include "EventPrefetcher.h"
+#include "ReplayJobQueue.h"
+#include "OnlineAccumulator.h"
 
 #include <QMainWindow>
 #include <QPushButton>
@@ -22,10 +25,11 @@
 #include <QString>
 #include <QLineEdit>
 #include <QTextEdit>
+#include <QTimer>
+#include <QCheckBox>
 
 #include <vector>
 #include <string>
-#include <deque>
 
 class Viewer : public QWidget
 {
@@ -33,7 +37,7 @@ class Viewer : public QWidget
 
 public:
     Viewer(QWidget *parent = 0);
-    ~Viewer() {}
+    ~Viewer();
 
     void InitGui();
     void AddMenuBar();
@@ -50,6 +54,16 @@ public:
 
     // init detector analyzers
     void InitGEMAnalyzer();
+    void InitJobQueue();
+    void InitOnlineAccumulator();
+    void PrintLog(const QString &, const char* color = "black");
+
+    // draw a prefetched event, one tab at a time
+    void DrawCurrentTab();
+    void DrawGEMRawHistos(const ViewerEvent &, int tab);
+    void DrawGEMOnlineHits(const ViewerEvent &, int layer_index);
+    // draw accumulated statistics
+    void DrawOnlineStats(const OnlineStats &);
 
     bool FileExist(const char* path);
 
@@ -70,13 +84,20 @@ public slots:
     void ChoosePedestal();
     void ChooseCommonMode();
     void DrawEvent(int);
-    void DrawGEMRawHistos(int);
-    void DrawGEMOnlineHits(int);
+    void OnTabChanged(int);
     void OpenFile();
     void GeneratePedestal_obsolete();
     void GeneratePedestal();
     void ReplayHit();
     void ReplayCluster();
+    void CancelJob();
+    void ClearJobQueue();
+    void OnJobStarted(const QString &, int);
+    void OnJobFinished(const QString &, bool, int);
+    void OnJobProgress(const QString &);
+    void ToggleOnlineAccumulation();
+    void SetOnlineLiveMode(bool);
+    void RedrawOnlineStats();
 
 private:
     // layout
@@ -98,6 +119,9 @@ private:
     // online hits
     std::vector<HistoWidget*> vTabCanvasOnlineHits; // tab contents, for drawing online hits
     bool reload_pedestal_for_online = true;
+    // online accumulation
+    std::vector<HistoWidget*> vTabCanvasOccupancy; // strip occupancy per layer
+    HistoWidget *pTabCanvasAPVSummary;             // apv hits and common mode
 
     // menu bar
     QMenu *pMenu;
@@ -109,6 +133,12 @@ private:
 
     // show detector 2d strips for eye-ball tracking
     Detector2DView *det_view;
+    int fDetector2DTab = -1;
+
+    // event shown, and the event each tab was last drawn with,
+    // tabs are only drawn when they are visible
+    ViewerEventPtr pCurrentEvent;
+    std::vector<int> vTabEventDrawn;
 
     // number of tabs
     int nTab = 12; // number of tabs for apv raw histos
@@ -116,6 +146,10 @@ private:
 
     // GEM analzyer
     GEMAnalyzer *pGEMAnalyzer;
+    // decode and zero suppress events ahead of the current one,
+    // uses pGEMAnalyzer and its own GEMSystem in a worker thread
+    EventPrefetcher *pPrefetcher;
+    GEMSystem *pOnlineGEMSystem;
     // evio file to be analyzed
     std::string fFile = "gui/data/gem_cleanroom_1440.evio.0";
     // pedestal output default path
@@ -128,15 +162,25 @@ private:
 
     // gem replay
     GEMReplay *pGEMReplay;
+    // replay/pedestal jobs run in background, one after another
+    ReplayJobQueue *pJobQueue;
+    // accumulate statistics over the whole file in background,
+    // redraw is throttled by a timer
+    OnlineAccumulator *pOnlineAccumulator;
+    QTimer *pRedrawTimer;
+    QPushButton *btn_online_accumulation;
+    // follow the file while the daq is writing it
+    bool bOnlineLiveMode = false;
     std::string fRootFileSavePath = "./gem_replay.root";
     int fFileSplitEnd = -1;
     int fFileSplitStart = 0;
 
 private:
     // section for GEM_Viewer status
-    int event_number_checked = 0;
-    size_t max_cache_events = 11;
-    std::deque<std::map<APVAddress, std::vector<int>>> event_cache;
+    // number of events cached ahead of/behind the current event
+    int fPrefetchDepth = 10;
+    // redraw interval for online accumulation (ms)
+    int fOnlineRedrawInterval = 500;
 
     // a text parser
     ConfigObject txt_parser;
@@ -2,6 +2,7 @@
 #include "ColorSpectrum.h"
 #include <iostream>
 #include <cmath>
+#include <unordered_map>
 
 ////////////////////////////////////////////////////////////////////////////////
 // ctor
@@ -38,7 +39,7 @@ void Detector2DItem::paint(QPainter *painter,
         [[maybe_unused]] const QStyleOptionGraphicsItem *option,
         [[maybe_unused]] QWidget *widget)
 {
-    UpdateDrawingRange();
+    UpdateGeometry();
 
     // draw a frame
     DrawAxis(painter);
@@ -47,13 +48,39 @@ void Detector2DItem::paint(QPainter *painter,
     DrawContent(painter);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// rebuild cached strip lines, only when contents or size changed
+
+void Detector2DItem::UpdateGeometry()
+{
+    if(!bGeometryChanged)
+        return;
+
+    UpdateDrawingRange();
+
+    // group lines by color, one pen change per color
+    vStripGroups.clear();
+    std::unordered_map<QRgb, size_t> group_index;
+    for(auto &s: PrepareStrips()) {
+        QRgb rgb = s.second.rgb();
+        auto it = group_index.find(rgb);
+        if(it == group_index.end()) {
+            it = group_index.emplace(rgb, vStripGroups.size()).first;
+            vStripGroups.emplace_back(s.second, QVector<QLineF>());
+        }
+        vStripGroups[it -> second].second.push_back(s.first);
+    }
+
+    bGeometryChanged = false;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // resize event
 
 void Detector2DItem::resizeEvent()
 {
-    QPainter painter;
-    paint(&painter);
+    prepareGeometryChange();
+    bGeometryChanged = true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -64,6 +91,7 @@ void Detector2DItem::SetBoundingRect(const QRectF &f)
     prepareGeometryChange(); // only needed when bounding rect changes
 
     _boundingRect = mapRectFromScene(f);
+    bGeometryChanged = true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -130,11 +158,9 @@ void Detector2DItem::DrawAxis(QPainter *painter)
 
 void Detector2DItem::DrawContent(QPainter *painter)
 {
-    auto && strips = PrepareStrips();
-
-    for(auto &s: strips) {
-        painter -> setPen(s.second);
-        painter -> drawLine(s.first);
+    for(auto &g: vStripGroups) {
+        painter -> setPen(g.first);
+        painter -> drawLines(g.second);
     }
 
     // draw max adc text
@@ -225,11 +251,25 @@ QVector<std::pair<QLineF, QColor>> Detector2DItem::PrepareStrips()
         return QLineF(p1, p2);
     };
 
+    // more strips than pixels: strips landing on the same pixel line are
+    // drawn once, with the color of the highest adc
+    // <pixel line, <index in res, adc>>
+    std::unordered_map<uint64_t, std::pair<int, float>> pixel_lines;
+    auto pixel_key = [&](const QLineF &l) -> uint64_t
+    {
+        QPoint p1 = l.p1().toPoint(), p2 = l.p2().toPoint();
+        return (static_cast<uint64_t>(p1.x() & 0xffff) << 48) |
+            (static_cast<uint64_t>(p1.y() & 0xffff) << 32) |
+            (static_cast<uint64_t>(p2.x() & 0xffff) << 16) |
+            static_cast<uint64_t>(p2.y() & 0xffff);
+    };
+
     // a helper
     x_strip_max_adc = -9999, y_strip_max_adc = -9999;
     auto process_plane = [&](const std::vector<std::pair<int, float>> &strips,
             const float &angle, bool is_x_strip)
     {
+        pixel_lines.clear();
         for(auto &strip: strips) 
         {
             int strip_index = strip.first;
@@ -247,7 +287,15 @@ QVector<std::pair<QLineF, QColor>> Detector2DItem::PrepareStrips()
                 adc = (float)strip.second / 800.;
             QColor color = color_spectrum->toColor(adc);
 
-            res.push_back(std::pair<QLineF, QColor>(l, color));
+            auto it = pixel_lines.find(pixel_key(l));
+            if(it == pixel_lines.end()) {
+                pixel_lines[pixel_key(l)] = std::pair<int, float>(res.size(), strip.second);
+                res.push_back(std::pair<QLineF, QColor>(l, color));
+            }
+            else if(it -> second.second < strip.second) {
+                it -> second.second = strip.second;
+                res[it -> second.first].second = color;
+            }
 
             // for debug color spectrum
             if(is_x_strip) {
@@ -280,6 +328,7 @@ void Detector2DItem::Clear()
     _title = "";
     x_strips.clear();
     y_strips.clear();
+    bGeometryChanged = true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -299,6 +348,7 @@ void Detector2DItem::SetStripIndexRange(int x_min, int x_max, int y_min, int y_m
     data_x_max = x_max;
     data_y_min = y_min;
     data_y_max = y_max;
+    bGeometryChanged = true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -308,4 +358,5 @@ void Detector2DItem::SetStripAngle(float x_angle, float y_angle)
 {
     x_strip_angle = x_angle;
     y_strip_angle = y_angle;
+    bGeometryChanged = true;
 }
@@ -0,0 +1,269 @@
+#include "EventPrefetcher.h"
+#include "GEMAnalyzer.h"
+#include "GEMSystem.h"
+#include "GEMDetector.h"
+#include "GEMPlane.h"
+#include "GEMAPV.h"
+
+#include <iostream>
+
+////////////////////////////////////////////////////////////////////////////////
+// ctor
+
+EventPrefetcher::EventPrefetcher(GEMAnalyzer *analyzer, GEMSystem *gem_sys, size_t depth)
+: pAnalyzer(analyzer), pGEMSystem(gem_sys), fDepth(depth > 0 ? depth : 1)
+{
+    // place holder
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// dtor
+
+EventPrefetcher::~EventPrefetcher()
+{
+    Stop();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// start the worker thread
+
+void EventPrefetcher::Start()
+{
+    if(worker.joinable())
+        return;
+
+    bStop = false;
+    worker = std::thread(&EventPrefetcher::run, this);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// stop the worker thread, the cache is kept
+
+void EventPrefetcher::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        bStop = true;
+    }
+    cv_worker.notify_all();
+    cv_gui.notify_all();
+
+    if(worker.joinable())
+        worker.join();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// restart from the first event of a new file
+
+void EventPrefetcher::SetFile(const std::string &path)
+{
+    Stop();
+
+    mCache.clear();
+    fCursor = 0;
+    fNextEvent = 1;
+    bEndOfFile = false;
+
+    pAnalyzer -> CloseFile();
+    pAnalyzer -> SetFile(path.c_str());
+    pAnalyzer -> Init();
+
+    Start();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// set pedestal for zero suppression, the worker loads it
+
+void EventPrefetcher::SetPedestal(const std::string &pedestal, const std::string &common_mode)
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        fPedestalPath = pedestal;
+        fCommonModePath = common_mode;
+        bPedestalChanged = true;
+    }
+    cv_worker.notify_all();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// set number of events cached ahead of (and behind) the cursor
+
+void EventPrefetcher::SetDepth(size_t depth)
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        fDepth = depth > 0 ? depth : 1;
+        evict();
+    }
+    cv_worker.notify_all();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// get event by sequence number, move the cursor to it
+
+ViewerEventPtr EventPrefetcher::GetEvent(int num)
+{
+    if(num < 1)
+        return nullptr;
+
+    std::unique_lock<std::mutex> lk(mtx);
+    fCursor = num;
+    evict();
+    cv_worker.notify_all();
+
+    // wait until the event is ready, or it can never be
+    cv_gui.wait(lk, [&]() {
+            return bStop || (!bPedestalChanged && !bReprocessing &&
+                (mCache.count(num) > 0 || num < fNextEvent || bEndOfFile));
+            });
+
+    auto it = mCache.find(num);
+    if(it == mCache.end())
+        return nullptr;
+    return it -> second;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// drop events that are too far behind the cursor, must hold the lock
+
+void EventPrefetcher::evict()
+{
+    int oldest = fCursor - static_cast<int>(fDepth);
+    while(!mCache.empty() && mCache.begin() -> first < oldest)
+        mCache.erase(mCache.begin());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// worker loop
+
+void EventPrefetcher::run()
+{
+    std::unique_lock<std::mutex> lk(mtx);
+
+    while(true)
+    {
+        cv_worker.wait(lk, [&]() {
+                return bStop || bPedestalChanged ||
+                    (!bEndOfFile && fNextEvent <= fCursor + static_cast<int>(fDepth));
+                });
+
+        if(bStop)
+            break;
+
+        if(bPedestalChanged) {
+            reprocessCache(lk);
+            continue;
+        }
+
+        // decode next event without holding the lock
+        // the file is read sequentially, events the cursor has already
+        // passed (a jump ahead) are only decoded, not zero suppressed
+        int num = fNextEvent;
+        bool passed = num < fCursor - static_cast<int>(fDepth);
+        lk.unlock();
+
+        ViewerEventPtr ev;
+        bool ok = pAnalyzer -> AnalyzeEvent(num);
+        // events without gem data (e.g. prestart/go) are skipped
+        bool gem_event = ok && pAnalyzer -> GetFrames().size() > 0;
+        if(gem_event && !passed) {
+            auto raw = std::make_shared<APVRawEvent>();
+            for(auto &f: pAnalyzer -> GetFrames()) {
+                const int *p = pAnalyzer -> GetFrameData(f);
+                (*raw)[f.addr].assign(p, p + f.size);
+            }
+            ev = zeroSuppress(num, raw);
+        }
+
+        lk.lock();
+        if(!ok)
+            bEndOfFile = true;
+        else if(gem_event) {
+            // the cursor may have moved while decoding
+            if(ev && num >= fCursor - static_cast<int>(fDepth))
+                mCache[num] = ev;
+            fNextEvent++;
+        }
+        cv_gui.notify_all();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// load new pedestal, then zero suppress all cached events again
+// must hold the lock when calling, the lock is released while working
+
+void EventPrefetcher::reprocessCache(std::unique_lock<std::mutex> &lk)
+{
+    bPedestalChanged = false;
+    bReprocessing = true;
+    std::string ped = fPedestalPath, cm = fCommonModePath;
+    std::map<int, ViewerEventPtr> snapshot = mCache;
+    lk.unlock();
+
+    std::cout<<"loading pedestal for online analysis from: \""
+             <<ped<<"\" and \""<<cm<<"\""<<std::endl;
+    pGEMSystem -> ReadPedestalFile(ped, cm);
+
+    for(auto &i: snapshot)
+        i.second = zeroSuppress(i.first, i.second -> raw);
+
+    lk.lock();
+    for(auto &i: snapshot) {
+        auto it = mCache.find(i.first);
+        if(it != mCache.end())
+            it -> second = i.second;
+    }
+    bReprocessing = false;
+    cv_gui.notify_all();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// online zero suppression, collect strip hits on each detector
+
+ViewerEventPtr EventPrefetcher::zeroSuppress(int num, const std::shared_ptr<const APVRawEvent> &raw)
+{
+    auto ev = std::make_shared<ViewerEvent>();
+    ev -> event_number = num;
+    ev -> raw = raw;
+
+    for(auto &i: *raw)
+    {
+        GEMAPV *apv = pGEMSystem -> GetAPV(i.first);
+        if(apv == nullptr)
+        {
+            if(sMissingAPV.insert(i.first).second)
+                std::cout<<__func__<<": Warning: apv "<<i.first<<" not initilized"
+                         <<std::endl
+                         <<"            make sure mapping file is correct."
+                         <<std::endl
+                         <<"            skipped this apv data."
+                         <<std::endl;
+            continue;
+        }
+
+        apv -> FillRawDataMPD(i.second);
+        apv -> ZeroSuppression();
+        apv -> CollectZeroSupHits();
+    }
+
+    for(auto &i: pGEMSystem -> GetDetectorList())
+    {
+        GEMPlane *pln_x = i -> GetPlane(GEMPlane::Plane_X);
+        GEMPlane *pln_y = i -> GetPlane(GEMPlane::Plane_Y);
+
+        DetectorOnlineHits hits;
+        hits.layer_id = i -> GetLayerID();
+        hits.chamber_pos = i -> GetDetLayerPositionIndex();
+        hits.x_apvs = pln_x -> GetCapacity();
+        hits.y_apvs = pln_y -> GetCapacity();
+        hits.x_hits = pln_x -> GetStripHits();
+        hits.y_hits = pln_y -> GetStripHits();
+        ev -> online_hits.push_back(std::move(hits));
+
+        // clear strip hits for next event
+        pln_x -> ClearStripHits();
+        pln_y -> ClearStripHits();
+    }
+
+    return ev;
+}
@@ -33,10 +33,18 @@ void GEMAnalyzer::Init()
     }
 
     // set up evio file reader
-    pFileReader = new EvioFileReader();
-    pFileReader -> SetFileOpenMode("r"); // random access
-    pFileReader -> SetFile(fFile);
-    pFileReader -> OpenFile();
+    if(bLiveMode) {
+        delete pLiveReader;
+        pLiveReader = new EvioLiveReader();
+        pLiveReader -> SetFile(fFile);
+        pLiveReader -> OpenFile();
+    }
+    else {
+        pFileReader = new EvioFileReader();
+        pFileReader -> SetFileOpenMode("r"); // random access
+        pFileReader -> SetFile(fFile);
+        pFileReader -> OpenFile();
+    }
 
     // set up event parser
     pEventParser = new EventParser();
@@ -62,9 +70,9 @@ void GEMAnalyzer::SetFile(const char* path)
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// analzyer event 
+// analzyer event, return false if no more event can be read
 
-void GEMAnalyzer::AnalyzeEvent([[maybe_unused]] int event)
+bool GEMAnalyzer::AnalyzeEvent([[maybe_unused]] int event)
 {
     ClearPreviousEvent();
 
@@ -72,25 +80,20 @@ void GEMAnalyzer::AnalyzeEvent([[maybe_unused]] int event)
     uint32_t fBufLen;
 
     //if((pFileReader->ReadEventNum(&pBuf, &fBufLen, event)) != S_SUCCESS)
-    if((pFileReader->ReadNoCopy(&pBuf, &fBufLen)) != S_SUCCESS)
+    int status = bLiveMode ? pLiveReader -> ReadNoCopy(&pBuf, &fBufLen)
+                           : pFileReader -> ReadNoCopy(&pBuf, &fBufLen);
+    if(status != S_SUCCESS)
     {
         std::cout<<"Error: cannot open event."<<std::endl;
-        return;
+        return false;
     }
 
     pEventParser -> ParseEvent(pBuf, fBufLen);
 
     [[maybe_unused]] auto & decoded_data = pRawEventDecoder->GetAPV();
 
-    FillHistos(decoded_data);
-}
-
-////////////////////////////////////////////////////////////////////////////////
-// get the analyzed histos
-
-const std::unordered_map<APVAddress, TH1I*> & GEMAnalyzer::GetHistos() const
-{
-    return rawHistos;
+    FillFrames(decoded_data);
+    return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -98,13 +101,11 @@ const std::unordered_map<APVAddress, TH1I*> & GEMAnalyzer::GetHistos() const
 
 void GEMAnalyzer::Clear()
 {
-    for(auto &i: rawHistos)
-        if(i.second) i.second->Delete();
-
-    rawData.clear();
+    ClearPreviousEvent();
 
     delete pEventParser;
     delete pRawEventDecoder;
+    delete pLiveReader;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -112,10 +113,9 @@ void GEMAnalyzer::Clear()
 
 void GEMAnalyzer::ClearPreviousEvent()
 {
-    for(auto &i: rawHistos)
-        if(i.second) i.second -> Reset();
-
-    rawData.clear();
+    // keep the capacity
+    vFrameBuffer.clear();
+    vFrames.clear();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -123,45 +123,32 @@ void GEMAnalyzer::ClearPreviousEvent()
 
 void GEMAnalyzer::CloseFile()
 {
+    if(bLiveMode) {
+        if(pLiveReader) pLiveReader -> CloseFile();
+        return;
+    }
     pFileReader->CloseFile();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// fill event histos
+// stop waiting for a live file, AnalyzeEvent returns false
 
-void GEMAnalyzer::FillHistos(const std::unordered_map<APVAddress, std::vector<int>> &event_data)
+void GEMAnalyzer::Interrupt()
 {
-    int nAPV = 0;
-    for(auto &i: event_data)
-    {
-        if(rawHistos.find(i.first) == rawHistos.end()){
-            int nBins = static_cast<int>(i.second.size());
-            rawHistos[i.first] = new TH1I(
-                    Form("h%d_crate%d_mpd%d_adc%d", nAPV, i.first.crate_id, i.first.mpd_id, i.first.adc_ch), 
-                    Form("crate_%d_mpd_%d_adc_ch_%d", i.first.crate_id, i.first.mpd_id, i.first.adc_ch), 
-                    nBins, 0, nBins);
-        }
-        else
-            rawHistos[i.first] -> Reset();
-
-        nAPV++;
-
-        int ts = 0;
-        for(auto &j: i.second)
-        {
-            rawHistos[i.first] -> SetBinContent(ts, j);
-            rawData[i.first].push_back(j);
-            ts++;
-        }
-    }
+    if(pLiveReader)
+        pLiveReader -> Interrupt();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// fill event histos
+// copy decoded frames to the flat buffer
 
-const std::unordered_map<APVAddress, std::vector<int>> & GEMAnalyzer::GetData() const
+void GEMAnalyzer::FillFrames(const std::unordered_map<APVAddress, std::vector<int>> &event_data)
 {
-    return rawData;
+    for(auto &i: event_data)
+    {
+        vFrames.push_back(APVFrame{i.first, vFrameBuffer.size(), i.second.size()});
+        vFrameBuffer.insert(vFrameBuffer.end(), i.second.begin(), i.second.end());
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
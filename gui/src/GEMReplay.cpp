@@ -18,6 +18,15 @@ GEMReplay::GEMReplay()
     gem_sys -> Configure("config/gem.conf");
 
     data_handler -> SetGEMSystem(gem_sys);
+
+    // number of events kept in online and pedestal modes, sized by mode if not set
+    int capacity = txt_parser.Value<int>("Event Buffer Capacity", 0, false);
+    if(capacity > 0)
+        data_handler -> SetEventBufferCapacity(static_cast<size_t>(capacity));
+
+    // per-stage timing outputs of the replay jobs, off if not set
+    data_handler -> SetStatsOutput(txt_parser.Value<std::string>("Replay Stats Output", "", false),
+            txt_parser.Value<std::string>("Replay Stats Stream", "", false));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
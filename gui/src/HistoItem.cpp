@@ -54,22 +54,39 @@ void HistoItem::paint(QPainter* painter,
         [[maybe_unused]]const QStyleOptionGraphicsItem *option, 
         [[maybe_unused]]QWidget *widget)
 {
-    UpdateRange();
+    UpdateGeometry();
 
     // draw contents
     QPen pen1(Qt::blue, 1);
     painter -> setPen(pen1);
-    QPolygonF _shape = PrepareContentShape();
     painter -> drawPolygon(_shape);
 
     // draw axis
     QPen pen(Qt::black, 1);
     painter -> setPen(pen);
-    QVector<QLineF> axis = PrepareAxis();
-    painter -> drawLines(axis);
+    painter -> drawLines(_axis);
 
     // draw axis marks
-    DrawAxisMarks(painter);
+    painter -> drawLines(_axisMarks);
+    painter -> setFont(QFont("times", 8));
+    for(auto &i: _axisLabels)
+        painter -> drawText(i.first, i.second);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// rebuild cached geometry, only when contents or size changed
+
+void HistoItem::UpdateGeometry()
+{
+    if(!bGeometryChanged)
+        return;
+
+    UpdateRange();
+    _shape = PrepareContentShape();
+    _axis = PrepareAxis();
+    PrepareAxisMarks();
+
+    bGeometryChanged = false;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -78,6 +95,7 @@ void HistoItem::paint(QPainter* painter,
 void HistoItem::resizeEvent()
 {
     prepareGeometryChange();
+    bGeometryChanged = true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -90,6 +108,8 @@ void HistoItem::SetBoundingRect(const QRectF& f)
     // in our case scene coords overlaps with item coords
     _boundingRect = mapRectFromScene(f);
     //_boundingRect = f;
+
+    bGeometryChanged = true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -104,13 +124,44 @@ QPolygonF HistoItem::PrepareContentShape()
     }
 
     int size = static_cast<int>(_contents.size());
+    int pixels = static_cast<int>(area_x2 - area_x1);
 
     int start = 0;
     shape << Coord(start, 0);
-    for(int i=start;i<size+start;i++) {
-        shape << Coord(i, _contents[i-start]);
-        shape << Coord(i+1, _contents[i-start]);
+
+    if(pixels > 0 && size > pixels)
+    {
+        // more bins than pixels: keep min and max of the bins falling
+        // into each pixel column, peaks stay visible
+        shape.reserve(2 * pixels + 4);
+        int col_begin = 0;
+        while(col_begin < size)
+        {
+            int col = static_cast<int>(static_cast<int64_t>(col_begin) * pixels / size);
+            int col_end = static_cast<int>(static_cast<int64_t>(col + 1) * size / pixels);
+            if(col_end <= col_begin) col_end = col_begin + 1;
+            if(col_end > size) col_end = size;
+
+            float min = _contents[col_begin], max = min;
+            for(int i=col_begin+1; i<col_end; i++) {
+                if(min > _contents[i]) min = _contents[i];
+                if(max < _contents[i]) max = _contents[i];
+            }
+            shape << Coord(col_begin + start, min);
+            shape << Coord(col_end + start, max);
+
+            col_begin = col_end;
+        }
+    }
+    else
+    {
+        shape.reserve(2 * size + 4);
+        for(int i=start;i<size+start;i++) {
+            shape << Coord(i, _contents[i-start]);
+            shape << Coord(i+1, _contents[i-start]);
+        }
     }
+
     shape << Coord(size+start, _contents[size-1]);
     // close shape
     shape << Coord(size+start, 0);
@@ -140,10 +191,13 @@ QVector<QLineF> HistoItem::PrepareAxis()
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// draw axis marks (a helper)
+// prepare axis marks and labels (a helper)
 
-void HistoItem::DrawAxisMarks(QPainter *painter)
+void HistoItem::PrepareAxisMarks()
 {
+    _axisMarks.clear();
+    _axisLabels.clear();
+
     // find optimal mark interval
     auto find_interval = [&](const float &min, const float &max) -> float
     {
@@ -176,7 +230,6 @@ void HistoItem::DrawAxisMarks(QPainter *painter)
     // get text dimension
     QFont font("times", 8);
     QFontMetrics fm(font);
-    painter -> setFont(QFont("times", 8));
 
     // x axis marks
     float x_mark_len = 1.5/100. * (area_x2 - area_x1); // mark length
@@ -185,12 +238,12 @@ void HistoItem::DrawAxisMarks(QPainter *painter)
     float x_w = find_interval(area_x1, area_x2);
     while(x_pos < area_x2)
     {
-        painter->drawLine(QLineF(x_pos, area_y2, x_pos, area_y2 - x_mark_len));
+        _axisMarks.push_back(QLineF(x_pos, area_y2, x_pos, area_y2 - x_mark_len));
         if(i!=0) {
             QString ss = label(data_x_min, data_x_max, area_x1, area_x2, x_pos);
             int font_width = fm.width(ss);
             int font_height = fm.height();
-            painter -> drawText(x_pos - font_width/2, area_y2 + font_height, ss);
+            _axisLabels.emplace_back(QPointF(x_pos - font_width/2, area_y2 + font_height), ss);
         }
         x_pos = area_x1 + x_w * (i + 1.0);
         i = i + 1.0;
@@ -203,12 +256,12 @@ void HistoItem::DrawAxisMarks(QPainter *painter)
     float y_w = find_interval(area_y1, area_y2);
     while(y_pos < area_y2)
     {
-        painter -> drawLine(QLineF(area_x1, y_pos, area_x1 + y_mark_len, y_pos));
+        _axisMarks.push_back(QLineF(area_x1, y_pos, area_x1 + y_mark_len, y_pos));
         if(i != 0) {
             QString ss = label(data_y_min, data_y_max, area_y1, area_y2, y_pos, true);
             int font_width = fm.width(ss);
             int font_height = fm.height();
-            painter -> drawText(area_x1 - font_width -2, y_pos + font_height/2, ss);
+            _axisLabels.emplace_back(QPointF(area_x1 - font_width -2, y_pos + font_height/2), ss);
         }
         y_pos = area_y1 + y_w * (i + 1.0);
         i = i + 1.0;
@@ -219,7 +272,7 @@ void HistoItem::DrawAxisMarks(QPainter *painter)
     float x_title =  (area_x1 + area_x2) / 2. - font_width / 2.;
     //float y_title = area_y1 + fm.height();
     float y_title = area_y1 - 2; // 2 pixel away
-    painter -> drawText(x_title, y_title, _title);
+    _axisLabels.emplace_back(QPointF(x_title, y_title), _title);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -285,6 +338,8 @@ void HistoItem::UpdateRange()
 void HistoItem::SetTitle(const std::string  &ss)
 {
     _title = QString(ss.c_str());
+    // title is drawn with the axis labels
+    bGeometryChanged = true;
 }
 
 
@@ -295,4 +350,5 @@ void HistoItem::Clear()
 {
     _title = "";
     _contents.clear();
+    bGeometryChanged = true;
 }
@@ -0,0 +1,232 @@
+#include "OnlineAccumulator.h"
+#include "GEMAnalyzer.h"
+#include "GEMSystem.h"
+#include "GEMDetector.h"
+#include "GEMPlane.h"
+#include "GEMAPV.h"
+
+#include <iostream>
+#include <chrono>
+
+// interval for publishing a new snapshot (ms)
+#define SNAPSHOT_INTERVAL 200
+
+////////////////////////////////////////////////////////////////////////////////
+// ctor
+
+OnlineAccumulator::OnlineAccumulator(const std::string &config_file)
+: pAnalyzer(nullptr)
+{
+    pGEMSystem = new GEMSystem();
+    pGEMSystem -> Configure(config_file);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// dtor
+
+OnlineAccumulator::~OnlineAccumulator()
+{
+    Stop();
+
+    if(pAnalyzer) {
+        pAnalyzer -> CloseFile();
+        delete pAnalyzer;
+    }
+    delete pGEMSystem;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// set pedestal for zero suppression, used at next Start()
+
+void OnlineAccumulator::SetPedestal(const std::string &pedestal, const std::string &common_mode)
+{
+    fPedestalPath = pedestal;
+    fCommonModePath = common_mode;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// start accumulating from the first event of a file
+
+void OnlineAccumulator::Start(const std::string &file)
+{
+    Stop();
+
+    if(pAnalyzer) {
+        pAnalyzer -> CloseFile();
+        delete pAnalyzer;
+    }
+    pAnalyzer = new GEMAnalyzer();
+    pAnalyzer -> SetFile(file.c_str());
+    pAnalyzer -> SetLiveMode(bLiveMode);
+    pAnalyzer -> Init();
+
+    bStop = false;
+    bRunning = true;
+    worker = std::thread(&OnlineAccumulator::run, this, file);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// stop accumulating, the last snapshot stays available
+
+void OnlineAccumulator::Stop()
+{
+    bStop = true;
+    // in live mode the worker may be waiting for data
+    if(pAnalyzer)
+        pAnalyzer -> Interrupt();
+    if(worker.joinable())
+        worker.join();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// worker loop
+
+void OnlineAccumulator::run(std::string file)
+{
+    if(fPedestalPath.size() > 0) {
+        std::cout<<"loading pedestal for online accumulation from: \""
+                 <<fPedestalPath<<"\" and \""<<fCommonModePath<<"\""<<std::endl;
+        pGEMSystem -> ReadPedestalFile(fPedestalPath, fCommonModePath);
+    }
+
+    initStats();
+    fStats.running = true;
+    publish();
+
+    std::cout<<"online accumulation started for: "<<file
+             <<(bLiveMode ? " (live)" : "")<<std::endl;
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point last = begin;
+
+    while(!bStop)
+    {
+        if(!pAnalyzer -> AnalyzeEvent(0))
+            break;
+
+        if(pAnalyzer -> GetFrames().size() == 0)
+            continue;
+
+        accumulate();
+        fStats.events++;
+
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if(std::chrono::duration_cast<std::chrono::milliseconds>(now - last).count()
+                >= SNAPSHOT_INTERVAL)
+        {
+            fStats.rate = fStats.events / std::chrono::duration<double>(now - begin).count();
+            publish();
+            last = now;
+        }
+    }
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    double t = std::chrono::duration<double>(end - begin).count();
+    fStats.rate = t > 0. ? fStats.events / t : 0.;
+    fStats.running = false;
+    publish();
+
+    std::cout<<"online accumulation stopped, "<<fStats.events<<" events accumulated."
+             <<std::endl;
+    bRunning = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// reset statistics, layout follows the gem system
+
+void OnlineAccumulator::initStats()
+{
+    fStats = OnlineStats();
+    mAPVIndex.clear();
+
+    for(auto &apv: pGEMSystem -> GetAPVList()) {
+        mAPVIndex[apv -> GetAddress()] = fStats.apvs.size();
+        fStats.apvs.push_back(apv -> GetAddress());
+    }
+    size_t napvs = fStats.apvs.size();
+    fStats.apv_hits.resize(napvs, 0);
+    fStats.common_mode_sum.resize(napvs, 0.);
+    fStats.common_mode_count.resize(napvs, 0);
+    fStats.common_mode_hist.resize(napvs * ONLINE_CM_BINS, 0);
+
+    vDetectors = pGEMSystem -> GetDetectorList();
+    for(auto &det: vDetectors) {
+        fStats.layer_id.push_back(det -> GetLayerID());
+        fStats.chamber_pos.push_back(det -> GetDetLayerPositionIndex());
+        int x_apvs = det -> GetPlane(GEMPlane::Plane_X) -> GetCapacity();
+        int y_apvs = det -> GetPlane(GEMPlane::Plane_Y) -> GetCapacity();
+        fStats.x_occupancy.emplace_back(x_apvs * APV_STRIP_SIZE, 0);
+        fStats.y_occupancy.emplace_back(y_apvs * APV_STRIP_SIZE, 0);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// zero suppress one event and add it to the statistics
+
+void OnlineAccumulator::accumulate()
+{
+    const double cm_scale = ONLINE_CM_BINS / (ONLINE_CM_HIGH - ONLINE_CM_LOW);
+
+    for(auto &f: pAnalyzer -> GetFrames())
+    {
+        GEMAPV *apv = pGEMSystem -> GetAPV(f.addr);
+        if(apv == nullptr)
+            continue;
+
+        apv -> FillRawDataMPD(pAnalyzer -> GetFrameData(f), f.size);
+        apv -> ZeroSuppression();
+        apv -> CollectZeroSupHits();
+
+        size_t k = mAPVIndex[f.addr];
+        for(auto &cm: apv -> GetCommonMode()) {
+            fStats.common_mode_sum[k] += cm;
+            fStats.common_mode_count[k]++;
+            int bin = static_cast<int>((cm - ONLINE_CM_LOW) * cm_scale);
+            if(bin >= 0 && bin < ONLINE_CM_BINS)
+                fStats.common_mode_hist[k * ONLINE_CM_BINS + bin]++;
+        }
+    }
+
+    auto count_apv_hit = [&](const StripHit &hit)
+    {
+        auto it = mAPVIndex.find(hit.apv_addr);
+        if(it != mAPVIndex.end())
+            fStats.apv_hits[it -> second]++;
+    };
+
+    for(size_t d=0; d<vDetectors.size(); d++)
+    {
+        GEMPlane *pln_x = vDetectors[d] -> GetPlane(GEMPlane::Plane_X);
+        GEMPlane *pln_y = vDetectors[d] -> GetPlane(GEMPlane::Plane_Y);
+
+        // x plane strips go to local chamber coordinate, same as online hits
+        auto &x_occ = fStats.x_occupancy[d];
+        int x_offset = APV_STRIP_SIZE * fStats.chamber_pos[d] * pln_x -> GetCapacity();
+        for(auto &hit: pln_x -> GetStripHits()) {
+            int strip = hit.strip - x_offset;
+            if(strip >= 0 && strip < static_cast<int>(x_occ.size()))
+                x_occ[strip]++;
+            count_apv_hit(hit);
+        }
+
+        auto &y_occ = fStats.y_occupancy[d];
+        for(auto &hit: pln_y -> GetStripHits()) {
+            if(hit.strip >= 0 && hit.strip < static_cast<int>(y_occ.size()))
+                y_occ[hit.strip]++;
+            count_apv_hit(hit);
+        }
+
+        // clear strip hits for next event
+        pln_x -> ClearStripHits();
+        pln_y -> ClearStripHits();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// copy current statistics to the triple buffer
+
+void OnlineAccumulator::publish()
+{
+    fSnapshot.GetWriteBuffer() = fStats;
+    fSnapshot.Publish();
+}
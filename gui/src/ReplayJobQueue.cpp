@@ -0,0 +1,137 @@
+#include "ReplayJobQueue.h"
+
+#include <iostream>
+
+////////////////////////////////////////////////////////////////////////////////
+// ctor
+
+ReplayJobQueue::ReplayJobQueue(QObject *parent) : QObject(parent)
+{
+    worker = std::thread(&ReplayJobQueue::run, this);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// dtor, cancel everything and wait for the running job to stop
+
+ReplayJobQueue::~ReplayJobQueue()
+{
+    ClearPending();
+    CancelCurrent();
+
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        bStop = true;
+    }
+    cv.notify_all();
+
+    if(worker.joinable())
+        worker.join();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// add a job to the end of the queue
+
+void ReplayJobQueue::Enqueue(const std::string &name, std::function<void()> job,
+        std::function<void()> cancel, std::function<void()> reset)
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        jobs.push_back(Job{name, job, cancel, reset});
+    }
+    cv.notify_all();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// stop the running job, the next job in queue starts after it returns
+
+void ReplayJobQueue::CancelCurrent()
+{
+    std::lock_guard<std::mutex> lk(mtx);
+    if(!bBusy || bCancelled)
+        return;
+
+    bCancelled = true;
+    if(current.cancel)
+        current.cancel();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// remove all jobs not started yet
+
+void ReplayJobQueue::ClearPending()
+{
+    std::lock_guard<std::mutex> lk(mtx);
+    jobs.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// number of jobs waiting
+
+int ReplayJobQueue::GetPendingJobs()
+{
+    std::lock_guard<std::mutex> lk(mtx);
+    return static_cast<int>(jobs.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// is a job running
+
+bool ReplayJobQueue::IsBusy()
+{
+    std::lock_guard<std::mutex> lk(mtx);
+    return bBusy;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// progress text from the running job
+
+void ReplayJobQueue::ReportProgress(const QString &text)
+{
+    emit progressUpdated(text);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// worker loop
+
+void ReplayJobQueue::run()
+{
+    std::unique_lock<std::mutex> lk(mtx);
+
+    while(true)
+    {
+        cv.wait(lk, [&]() {return bStop || !jobs.empty();});
+        if(bStop)
+            break;
+
+        current = jobs.front();
+        jobs.pop_front();
+        // still under the lock, a cancel from now on belongs to this job
+        if(current.reset)
+            current.reset();
+        bBusy = true;
+        bCancelled = false;
+        int pending = static_cast<int>(jobs.size());
+        QString name = QString::fromStdString(current.name);
+        lk.unlock();
+
+        emit jobStarted(name, pending);
+
+        try {
+            current.run();
+        } catch(const std::exception &e) {
+            std::cout<<"ReplayJobQueue: job \""<<current.name<<"\" failed: "
+                     <<e.what()<<std::endl;
+        }
+
+        lk.lock();
+        bool cancelled = bCancelled;
+        bBusy = false;
+        current = Job();
+        pending = static_cast<int>(jobs.size());
+        lk.unlock();
+
+        emit jobFinished(name, cancelled, pending);
+
+        lk.lock();
+    }
+}
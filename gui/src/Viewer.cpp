@@ -36,9 +36,24 @@ Viewer::Viewer(QWidget *parent) : QWidget(parent)
 
     InitGEMAnalyzer();
 
+    InitJobQueue();
+
+    InitOnlineAccumulator();
+
     resize(sizeHint());
 }
 
+////////////////////////////////////////////////////////////////
+// dtor
+
+Viewer::~Viewer()
+{
+    // stop the workers before the analyzer/replay go away
+    delete pJobQueue;
+    delete pPrefetcher;
+    delete pOnlineAccumulator;
+}
+
 
 ////////////////////////////////////////////////////////////////
 // init gui
@@ -289,6 +304,23 @@ void Viewer::InitCtrlInterface()
     _layout5 -> addWidget(l_cluster, 2, 0);
     _layout5 -> addWidget(btn_cluster, 2, 1);
 
+    // cancel running replay/pedestal job, clear queued jobs
+    QGridLayout *_layout8 = new QGridLayout();
+    QLabel *l_job = new QLabel("Background Jobs:", pRightCtrlInterface);
+    QPushButton *btn_cancel_job = new QPushButton("Cancel &Job", pRightCtrlInterface);
+    QPushButton *btn_clear_jobs = new QPushButton("Clear Job &Queue", pRightCtrlInterface);
+    _layout8 -> addWidget(l_job, 0, 0);
+    _layout8 -> addWidget(btn_cancel_job, 0, 1);
+    _layout8 -> addWidget(btn_clear_jobs, 0, 2);
+    // accumulate occupancy/common mode over the whole file
+    QLabel *l_online = new QLabel("Online Accumulation:", pRightCtrlInterface);
+    btn_online_accumulation = new QPushButton("&Start Online Accumulation", pRightCtrlInterface);
+    _layout8 -> addWidget(l_online, 1, 0);
+    _layout8 -> addWidget(btn_online_accumulation, 1, 1);
+    QCheckBox *cb_live = new QCheckBox("Follow &Live File", pRightCtrlInterface);
+    cb_live -> setChecked(bOnlineLiveMode);
+    _layout8 -> addWidget(cb_live, 1, 2);
+
     // add to overall layout
     layout -> addLayout(_layout1);
     layout -> addLayout(_layout2);
@@ -297,6 +329,7 @@ void Viewer::InitCtrlInterface()
     layout -> addLayout(_layout6);
     layout -> addLayout(_layout4);
     layout -> addLayout(_layout5);
+    layout -> addLayout(_layout8);
 
     // connect
     connect(file_indicator, SIGNAL(textChanged(const QString &)), this, SLOT(SetFile(const QString &)));
@@ -311,6 +344,10 @@ void Viewer::InitCtrlInterface()
     connect(le_split_start, SIGNAL(textChanged(const QString &)), this, SLOT(SetFileSplitMin(const QString &)));
     connect(b4, SIGNAL(pressed()), this, SLOT(ReplayHit()));
     connect(btn_cluster, SIGNAL(pressed()), this, SLOT(ReplayCluster()));
+    connect(btn_cancel_job, SIGNAL(pressed()), this, SLOT(CancelJob()));
+    connect(btn_clear_jobs, SIGNAL(pressed()), this, SLOT(ClearJobQueue()));
+    connect(btn_online_accumulation, SIGNAL(pressed()), this, SLOT(ToggleOnlineAccumulation()));
+    connect(cb_live, SIGNAL(toggled(bool)), this, SLOT(SetOnlineLiveMode(bool)));
     connect(btn_choose_pedestal, SIGNAL(pressed()), this, SLOT(ChoosePedestal()));
     connect(btn_choose_common_mode, SIGNAL(pressed()), this, SLOT(ChooseCommonMode()));
     connect(le_pedestal_for_replay, SIGNAL(textChanged(const QString &)), this, SLOT(SetPedestalInputPath(const QString &)));
@@ -360,13 +397,43 @@ void Viewer::InitLeftTab()
         pLeftTab -> addTab(tabWidget, s);
     }
 
+    // for online accumulation, strip occupancy
+    for(int i=0; i<nTabOnlineHits; ++i)
+    {
+        QWidget *tabWidget = new QWidget(pLeftTab);
+        QVBoxLayout *tabWidgetLayout = new QVBoxLayout(tabWidget);
+        HistoWidget *c = new HistoWidget(tabWidget);
+        c -> Divide(4, 2); // each layer has 4 chambers
+        c -> PassQMainCanvasPointer(pRightCanvas);
+        tabWidgetLayout -> addWidget(c);
+        vTabCanvasOccupancy.push_back(c);
+
+        QString s;
+        s.sprintf("Occupancy Layer: %d", layer_id_vec[i]);
+        pLeftTab -> addTab(tabWidget, s);
+    }
+
+    // for online accumulation, apv summary
+    {
+        QWidget *tabWidget = new QWidget(pLeftTab);
+        QVBoxLayout *tabWidgetLayout = new QVBoxLayout(tabWidget);
+        pTabCanvasAPVSummary = new HistoWidget(tabWidget);
+        pTabCanvasAPVSummary -> Divide(3, 1);
+        pTabCanvasAPVSummary -> PassQMainCanvasPointer(pRightCanvas);
+        tabWidgetLayout -> addWidget(pTabCanvasAPVSummary);
+        pLeftTab -> addTab(tabWidget, "APV Summary");
+    }
+
     pLeftLayout -> addWidget(pLeftTab);
 
 #ifdef EYE_BALL_TRACKING
     // for eye-ball tracking (show detector 2d strips)
     det_view = new Detector2DView();
-    pLeftTab -> addTab(det_view, "Detector 2D Strips");
+    fDetector2DTab = pLeftTab -> addTab(det_view, "Detector 2D Strips");
 #endif
+
+    // tabs are drawn when they are selected
+    connect(pLeftTab, SIGNAL(currentChanged(int)), this, SLOT(OnTabChanged(int)));
 }
 
 
@@ -408,9 +475,7 @@ void Viewer::SetFile([[maybe_unused]] const QString & s)
 
     std::cout<<"Openning file: "<<fFile<<std::endl;
 
-    pGEMAnalyzer -> CloseFile();
-    pGEMAnalyzer -> SetFile(s.toStdString().c_str());
-    pGEMAnalyzer -> Init();
+    pPrefetcher -> SetFile(fFile);
 }
 
 ////////////////////////////////////////////////////////////////
@@ -423,165 +488,188 @@ void Viewer::InitGEMAnalyzer()
     pGEMAnalyzer -> Init();
 
     pGEMReplay = new GEMReplay();
-}
 
-////////////////////////////////////////////////////////////////
-// draw event
+    // online zero suppression has its own gem system, so it does not
+    // interfere with the replay jobs
+    pOnlineGEMSystem = new GEMSystem();
+    pOnlineGEMSystem -> Configure("config/gem.conf");
 
-void Viewer::DrawEvent(int num)
-{
-    DrawGEMRawHistos(num);
-    DrawGEMOnlineHits(num);
+    fPrefetchDepth = txt_parser.Value<int>("Viewer Prefetch Events", fPrefetchDepth, false);
+    pPrefetcher = new EventPrefetcher(pGEMAnalyzer, pOnlineGEMSystem,
+            static_cast<size_t>(fPrefetchDepth > 0 ? fPrefetchDepth : 1));
+    pPrefetcher -> Start();
 }
 
-
 ////////////////////////////////////////////////////////////////
-// draw gem raw event
+// init background job queue, progress of the gem data handler
+// is forwarded to the log box
 
-void Viewer::DrawGEMRawHistos(int num)
+void Viewer::InitJobQueue()
 {
-    std::map<APVAddress, std::vector<int>> mData;
-
-    // event number increased - forward
-    if(num > event_number_checked) 
-    {
-        // get apv raw histos
-        pGEMAnalyzer -> AnalyzeEvent(num);
-        auto & _mData = pGEMAnalyzer->GetData();
-        if(_mData.size() <= 0) return;
-
-        // sort raw histos
-        for(auto &i: _mData)
-            mData[i.first] = i.second;
-
-        event_number_checked = num;
-        event_cache.push_back(mData);
-        if(event_cache.size() > max_cache_events) 
-        {
-            event_cache.pop_front();
-        }
-    }
-    // event number decreased - backward
-    else if(num < event_number_checked) 
-    {
-        size_t index = event_number_checked - num;
-        if(index >= event_cache.size())
-                return;
+    pJobQueue = new ReplayJobQueue();
 
-        size_t pos = event_cache.size() - index - 1;
+    connect(pJobQueue, SIGNAL(jobStarted(const QString &, int)),
+            this, SLOT(OnJobStarted(const QString &, int)));
+    connect(pJobQueue, SIGNAL(jobFinished(const QString &, bool, int)),
+            this, SLOT(OnJobFinished(const QString &, bool, int)));
+    connect(pJobQueue, SIGNAL(progressUpdated(const QString &)),
+            this, SLOT(OnJobProgress(const QString &)));
 
-        mData = event_cache.at(pos);
-    }
-    else
+    // called from the job thread
+    auto progress = [this](const ReplayProgress &p)
     {
-        if(event_cache.size() <= 0) return;
-        mData = event_cache.back();
-    }
-
-    // print a log 
-    std::string ss("total apv in current event : ");
-    ss = ss + std::to_string(mData.size()) + "\n";
-    pLogBox -> textCursor().insertText(ss.c_str());
-    pLogBox -> verticalScrollBar()->setValue(pLogBox->verticalScrollBar()->maximum());
+        if(p.finished)
+            return;
 
-    // dispath by mpd id
-    // a helper
-    auto find_index = [&](const MPDAddress &addr) -> int 
-    {
-        auto &vMPDAddr = apv_strip_mapping::Mapping::Instance()->GetMPDAddressVec();
-        int res = 0;
-        for(auto &i: vMPDAddr) {
-            if(i == addr)
-                return res;
-            res++;
+        QString s;
+        if(p.split >= 0)
+            s += QString("split %1 [%2, %3): ").arg(p.split).arg(p.split_start).arg(p.split_end);
+        s += QString("%1 events, %2 events/s").arg(p.events).arg(p.rate, 0, 'f', 1);
+        if(p.eta >= 0.) {
+            int eta = static_cast<int>(p.eta);
+            s += QString(", %1%, ETA %2 min %3 s").arg(p.fraction * 100., 0, 'f', 1)
+                .arg(eta / 60).arg(eta % 60);
         }
-        return -1;
+        s += "\n";
+        pJobQueue -> ReportProgress(s);
     };
-    std::vector<std::vector<int>> vH[nTab];
-    std::vector<APVAddress> vAddr[nTab];
-    for(auto &i: mData) {
-        MPDAddress mpd_addr(i.first.crate_id, i.first.mpd_id);
-        int index = find_index(mpd_addr);
-        if(index >= 0 && index < nTab) {
-            vH[index].push_back(i.second);
-            vAddr[index].push_back(i.first);
-        }
-    }
+    pGEMReplay -> GetGEMDataHandler() -> SetProgressCallback(progress, 5000);
+}
 
-    // draw tab main canvas
-    for(int i=0;i<nTab;i++) 
-    {
-        vTabCanvas[i] -> Clear();
-        vTabCanvas[i] -> DrawCanvas(vH[i], vAddr[i], 4, 4);
-        vTabCanvas[i] -> Refresh();
-    }
+////////////////////////////////////////////////////////////////
+// init online accumulation, the accumulator has its own gem system,
+// the timer only redraws when a new snapshot is available
+
+void Viewer::InitOnlineAccumulator()
+{
+    pOnlineAccumulator = new OnlineAccumulator("config/gem.conf");
 
-    // draw right-side canvas
-    std::vector<std::vector<int>> temp;
-    std::vector<APVAddress> temp_addr;
-    temp.push_back(mData.begin()->second);
-    temp_addr.push_back(mData.begin()->first);
-    pRightCanvas->DrawCanvas(temp, temp_addr, 1, 1);
+    fOnlineRedrawInterval = txt_parser.Value<int>("Viewer Online Redraw Interval",
+            fOnlineRedrawInterval, false);
+    pRedrawTimer = new QTimer(this);
+    pRedrawTimer -> setInterval(fOnlineRedrawInterval > 0 ? fOnlineRedrawInterval : 500);
+    connect(pRedrawTimer, SIGNAL(timeout()), this, SLOT(RedrawOnlineStats()));
 }
 
+////////////////////////////////////////////////////////////////
+// print a line to the log box
+
+void Viewer::PrintLog(const QString &s, const char* color)
+{
+    pLogBox -> setTextColor(QColor(color));
+    pLogBox -> textCursor().insertText(s);
+    pLogBox -> verticalScrollBar()->setValue(pLogBox->verticalScrollBar()->maximum());
+}
 
 ////////////////////////////////////////////////////////////////
-// draw extracted gem online hits (fired strips after zero
-// suppression for each GEM Chamber)
+// draw event, events are decoded and zero suppressed ahead of time
+// by the prefetcher, this only waits if the event is not ready yet
 
-void Viewer::DrawGEMOnlineHits(int num)
+void Viewer::DrawEvent(int num)
 {
     if(reload_pedestal_for_online) {
-        std::cout<<"loading pedestal for online analysis from: \""
-                 <<fPedestalInputPath
-                 <<"\" and \""<<fCommonModeInputPath<<"\""<<std::endl;
-        pGEMReplay -> GetGEMSystem() -> ReadPedestalFile(fPedestalInputPath, fCommonModeInputPath);
+        pPrefetcher -> SetPedestal(fPedestalInputPath, fCommonModeInputPath);
         reload_pedestal_for_online = false;
     }
 
-    if(event_cache.size() <= 0)
+    ViewerEventPtr event = pPrefetcher -> GetEvent(num);
+    if(!event)
         return;
 
-    // get raw data
-    std::map<APVAddress, std::vector<int>> event_data;
-    if( num > event_number_checked)
-    {
-        event_data = event_cache.back();
-    }
-    else if( num < event_number_checked)
-    {
-        size_t index = event_number_checked - num;
-        if(index >= event_cache.size())
-            return;
-        size_t pos = event_cache.size() - index - 1;
-        event_data = event_cache.at(pos);
+    pCurrentEvent = event;
+    const APVRawEvent &mData = *event -> raw;
+    if(mData.size() > 0) {
+        // print a log 
+        std::string ss("total apv in current event : ");
+        ss = ss + std::to_string(mData.size()) + "\n";
+        pLogBox -> textCursor().insertText(ss.c_str());
+        pLogBox -> verticalScrollBar()->setValue(pLogBox->verticalScrollBar()->maximum());
+
+        // draw right-side canvas
+        std::vector<std::vector<int>> temp;
+        std::vector<APVAddress> temp_addr;
+        temp.push_back(mData.begin()->second);
+        temp_addr.push_back(mData.begin()->first);
+        pRightCanvas->DrawCanvas(temp, temp_addr, 1, 1);
     }
+
+    // only the visible tab is drawn now, the others when they are selected
+    vTabEventDrawn.assign(pLeftTab -> count(), -1);
+    DrawCurrentTab();
+}
+
+////////////////////////////////////////////////////////////////
+// tab changed, draw current event on it if not done yet
+
+void Viewer::OnTabChanged([[maybe_unused]] int index)
+{
+    DrawCurrentTab();
+}
+
+////////////////////////////////////////////////////////////////
+// draw current event on the visible tab
+
+void Viewer::DrawCurrentTab()
+{
+    if(!pCurrentEvent)
+        return;
+
+    int index = pLeftTab -> currentIndex();
+    if(index < 0 || index >= static_cast<int>(vTabEventDrawn.size()))
+        return;
+    if(vTabEventDrawn[index] == pCurrentEvent -> event_number)
+        return;
+
+    if(index < nTab)
+        DrawGEMRawHistos(*pCurrentEvent, index);
+    else if(index < nTab + nTabOnlineHits)
+        DrawGEMOnlineHits(*pCurrentEvent, index - nTab);
+    else if(index == fDetector2DTab)
+        DrawGEMOnlineHits(*pCurrentEvent, -1);
     else
-    {
-        if(event_cache.size() <= 0) return;
-        event_data = event_cache.back();
-    }
+        return; // online accumulation tabs are drawn by timer
 
-    // online zero suppression
-    for(auto &i: event_data)
-    {
-        GEMAPV *apv = pGEMReplay -> GetGEMSystem() -> GetAPV(i.first);
-        if( apv == nullptr)
-        {
-            std::cout<<__func__<<": Warning: apv "<<i.first<<" not initilized"
-                     <<std::endl
-                     <<"            make sure mapping file is correct."
-                     <<std::endl
-                     <<"            skipped current apv data."
-                     <<std::endl;
-            continue;
-        }
+    vTabEventDrawn[index] = pCurrentEvent -> event_number;
+}
 
-        apv -> FillRawDataMPD(i.second);
-        apv -> ZeroSuppression();
-        apv -> CollectZeroSupHits();
+
+////////////////////////////////////////////////////////////////
+// draw gem raw event, apvs of one mpd (tab)
+
+void Viewer::DrawGEMRawHistos(const ViewerEvent &event, int tab)
+{
+    const APVRawEvent &mData = *event.raw;
+    if(mData.size() <= 0) return;
+
+    auto &vMPDAddr = apv_strip_mapping::Mapping::Instance()->GetMPDAddressVec();
+    if(tab < 0 || tab >= nTab || tab >= static_cast<int>(vMPDAddr.size()))
+        return;
+
+    // only apvs on the mpd of this tab
+    std::vector<std::vector<int>> vH;
+    std::vector<APVAddress> vAddr;
+    for(auto &i: mData) {
+        MPDAddress mpd_addr(i.first.crate_id, i.first.mpd_id);
+        if(mpd_addr == vMPDAddr[tab]) {
+            vH.push_back(i.second);
+            vAddr.push_back(i.first);
+        }
     }
 
+    // draw tab main canvas
+    vTabCanvas[tab] -> Clear();
+    vTabCanvas[tab] -> DrawCanvas(vH, vAddr, 4, 4);
+    vTabCanvas[tab] -> Refresh();
+}
+
+
+////////////////////////////////////////////////////////////////
+// draw extracted gem online hits (fired strips after zero
+// suppression for each GEM Chamber), for one layer (tab),
+// or all layers on the detector 2d view if layer_index < 0
+
+void Viewer::DrawGEMOnlineHits(const ViewerEvent &event, int layer_index)
+{
     // organize online hits by layer
     auto & layerID = apv_strip_mapping::Mapping::Instance() -> GetLayerIDVec();
 
@@ -589,10 +677,6 @@ void Viewer::DrawGEMOnlineHits(int num)
     // (x_hits, y_hits)[layer][chamber]
     std::pair<std::vector<int>, std::vector<int>> online_hits[layerID.size()][4];
 
-    // get all gem detectors
-    std::vector<GEMDetector*> detectorList = 
-        pGEMReplay -> GetGEMSystem() -> GetDetectorList();
-
     // a helper to draw histos
     auto get_histo = [&](const std::vector<StripHit> &hits, const int &nAPV, bool xPlane,
             const int &GEMPos) -> std::vector<int>
@@ -623,43 +707,37 @@ void Viewer::DrawGEMOnlineHits(int num)
     };
 
     // extract all hits
-    for(auto &i: detectorList)
+    for(auto &i: event.online_hits)
     {
-        int layer_id = i -> GetLayerID();
-        int chamber_pos = i -> GetDetLayerPositionIndex();
+        int layer_id = i.layer_id;
+        int chamber_pos = i.chamber_pos;
 
         // chamber pos should be 0 - 3, max 4 chambers in one layer
         if(chamber_pos <0 || chamber_pos > 3)
             continue;
 
-        GEMPlane *pln_x = i -> GetPlane(GEMPlane::Plane_X);
-        GEMPlane *pln_y = i -> GetPlane(GEMPlane::Plane_Y);
-
-        const std::vector<StripHit> & x_hits = pln_x -> GetStripHits();
-        int x_apvs = pln_x -> GetCapacity();
-        std::vector<int> x_online_hits = get_histo(x_hits, x_apvs, true, chamber_pos);
-
-        const std::vector<StripHit> & y_hits = pln_y -> GetStripHits();
-        int y_apvs = pln_y -> GetCapacity();
-        std::vector<int> y_online_hits = get_histo(y_hits, y_apvs, false, chamber_pos);
-
         int index = get_vector_index(layer_id);
 
         // layer id not found in mapping file
         if(index < 0)
             continue;
+        // not on the layer to draw
+        if(layer_index >= 0 && index != layer_index)
+            continue;
+
+        std::vector<int> x_online_hits = get_histo(i.x_hits, i.x_apvs, true, chamber_pos);
+        std::vector<int> y_online_hits = get_histo(i.y_hits, i.y_apvs, false, chamber_pos);
 
         online_hits[index][chamber_pos] = std::pair<std::vector<int>,
             std::vector<int>>(x_online_hits, y_online_hits);
-
-        // clear strip hits for next event
-        pln_x -> ClearStripHits();
-        pln_y -> ClearStripHits();
     }
 
     // draw online hits
     for(size_t i=0; i<layerID.size(); ++i)
     {
+        if(static_cast<int>(i) != layer_index)
+            continue;
+
         std::vector<std::vector<int>> data;
         std::vector<std::string> title;
         // 4 chambers
@@ -682,7 +760,8 @@ void Viewer::DrawGEMOnlineHits(int num)
 
 #ifdef EYE_BALL_TRACKING
     // draw eye-ball tracking GEM 2D strips
-    det_view -> FillEvent(online_hits);
+    if(layer_index < 0)
+        det_view -> FillEvent(online_hits);
 #endif
 }
 
@@ -717,7 +796,6 @@ void Viewer::OpenFile()
     // reset event counter to 0
     pRightCtrlInterface -> findChild<QSpinBox*>(QString("event_number"))
         -> setValue(0);
-    event_number_checked = 0;
 
     // update pedstal output path
     ParsePedestalsOutputPathFromEvioFile();
@@ -925,43 +1003,30 @@ void Viewer::GeneratePedestal()
             this,
             tr("GEM Data Viewer"),
             tr("Generating Pedestal/CommonMode usually takes a while... \
-                \nPress Yes to start..."),
+                \nIt runs in background, press Yes to start..."),
            QMessageBox::No | QMessageBox::Yes );
     if(reply != QMessageBox::Yes)
         return;
 
-    pLogBox -> setTextColor(QColor("blue"));
-    pLogBox -> textCursor().insertText("\ngenerating pedestal/commonMode for file: \"");
-    pLogBox -> textCursor().insertText(fFile.c_str());
-    pLogBox -> textCursor().insertText("\"\nthis might take a while...\n");
-    pLogBox -> verticalScrollBar()->setValue(pLogBox->verticalScrollBar()->maximum());
-    QCoreApplication::processEvents();
-
-    pGEMReplay -> SetInputFile(fFile);
-    pGEMReplay -> SetPedestalOutputFile(fPedestalOutputPath);
-    pGEMReplay -> SetCommonModeOutputFile(fCommonModeOutputPath);
-    pGEMReplay -> SetPedestalInputFile(fPedestalInputPath, fCommonModeInputPath);
-
-    std::thread th([&]() {
-            pGEMReplay -> GeneratePedestal();
-            }
-            );
-
-    th.join();
-
-    QMessageBox::information(
-            this,
-            tr("GEM Data Viewer"),
-            tr("\nPedestal file written to: %1\
-                \nCommonMode file written to: %2\
-                \n\nIf you want to use the new files, please set GUI section \"Choose Pedestal\" accordingly.\
-                \n\nPedestal/CommonMode Done!")
-            .arg(fPedestalOutputPath.c_str())
-            .arg(fCommonModeOutputPath.c_str())
-            );
-
-    pLogBox -> setTextColor(QColor("black"));
-    pLogBox -> textCursor().insertText("Done.\n");
+    // settings at the time the job is queued
+    std::string input = fFile;
+    std::string ped_out = fPedestalOutputPath, cm_out = fCommonModeOutputPath;
+    std::string ped_in = fPedestalInputPath, cm_in = fCommonModeInputPath;
+    GEMReplay *replay = pGEMReplay;
+
+    std::string name = "pedestal: " + input;
+    pJobQueue -> Enqueue(name, [=]() {
+            replay -> SetInputFile(input);
+            replay -> SetPedestalOutputFile(ped_out);
+            replay -> SetCommonModeOutputFile(cm_out);
+            replay -> SetPedestalInputFile(ped_in, cm_in);
+            replay -> GeneratePedestal();
+            },
+            [=]() {replay -> GetGEMDataHandler() -> Cancel();},
+            [=]() {replay -> GetGEMDataHandler() -> ResetCancel();});
+
+    PrintLog(QString("\nqueued %1\npedestal file: %2\ncommonMode file: %3\n")
+            .arg(name.c_str()).arg(ped_out.c_str()).arg(cm_out.c_str()), "blue");
 }
 
 ////////////////////////////////////////////////////////////////
@@ -973,40 +1038,32 @@ void Viewer::ReplayHit()
             this,
             tr("GEM Data Viewer"),
             tr("Replay files usually takes a while... \
-                \nPress Yes to start..."),
+                \nIt runs in background, press Yes to start..."),
             QMessageBox::No | QMessageBox::Yes );
     if(reply != QMessageBox::Yes)
         return;
 
-    pLogBox -> setTextColor(QColor("blue"));
-    pLogBox -> textCursor().insertText("\nReplaying for file: \"");
-    pLogBox -> textCursor().insertText(fFile.c_str());
-    pLogBox -> textCursor().insertText("\"\nthis might take a while...\n");
-    pLogBox -> verticalScrollBar()->setValue(pLogBox->verticalScrollBar()->maximum());
-    QCoreApplication::processEvents();
-
-    pGEMReplay -> SetInputFile(fFile);
-    pGEMReplay -> SetPedestalOutputFile(fPedestalOutputPath);
-    pGEMReplay -> SetPedestalInputFile(fPedestalInputPath, fCommonModeInputPath);
-    pGEMReplay -> SetCommonModeOutputFile(fCommonModeOutputPath);
-    //pGEMReplay -> SetOutputFile(fRootFileSavePath); // now code automatically deduct output path
-    pGEMReplay -> SetSplitMax(fFileSplitEnd);
-    pGEMReplay -> SetSplitMin(fFileSplitStart);
-
-    std::thread th([&]() {
-            pGEMReplay -> ReplayHit();
-            }
-            );
-
-    th.join();
-
-    QMessageBox::information(
-            this,
-            tr("GEM Data Viewer"),
-            tr("Replay Done!") );
-
-    pLogBox -> setTextColor(QColor("black"));
-    pLogBox -> textCursor().insertText("Done.\n");
+    std::string input = fFile;
+    std::string ped_out = fPedestalOutputPath, cm_out = fCommonModeOutputPath;
+    std::string ped_in = fPedestalInputPath, cm_in = fCommonModeInputPath;
+    int split_min = fFileSplitStart, split_max = fFileSplitEnd;
+    GEMReplay *replay = pGEMReplay;
+
+    std::string name = "hit replay: " + input;
+    pJobQueue -> Enqueue(name, [=]() {
+            replay -> SetInputFile(input);
+            replay -> SetPedestalOutputFile(ped_out);
+            replay -> SetPedestalInputFile(ped_in, cm_in);
+            replay -> SetCommonModeOutputFile(cm_out);
+            //replay -> SetOutputFile(fRootFileSavePath); // now code automatically deduct output path
+            replay -> SetSplitMax(split_max);
+            replay -> SetSplitMin(split_min);
+            replay -> ReplayHit();
+            },
+            [=]() {replay -> GetGEMDataHandler() -> Cancel();},
+            [=]() {replay -> GetGEMDataHandler() -> ResetCancel();});
+
+    PrintLog(QString("\nqueued %1\n").arg(name.c_str()), "blue");
 }
 
 
@@ -1019,38 +1076,212 @@ void Viewer::ReplayCluster()
             this,
             tr("GEM Data Viewer"),
             tr("Replay files usually takes a while... \
-                \nPress Yes to start..."),
+                \nIt runs in background, press Yes to start..."),
             QMessageBox::No | QMessageBox::Yes );
     if(reply != QMessageBox::Yes)
         return;
 
-    pLogBox -> setTextColor(QColor("blue"));
-    pLogBox -> textCursor().insertText("\nReplaying for file: \"");
-    pLogBox -> textCursor().insertText(fFile.c_str());
-    pLogBox -> textCursor().insertText("\"\nthis might take a while...\n");
-    pLogBox -> verticalScrollBar()->setValue(pLogBox->verticalScrollBar()->maximum());
-    QCoreApplication::processEvents();
+    std::string input = fFile;
+    std::string ped_out = fPedestalOutputPath, cm_out = fCommonModeOutputPath;
+    std::string ped_in = fPedestalInputPath, cm_in = fCommonModeInputPath;
+    int split_min = fFileSplitStart, split_max = fFileSplitEnd;
+    GEMReplay *replay = pGEMReplay;
+
+    std::string name = "cluster replay: " + input;
+    pJobQueue -> Enqueue(name, [=]() {
+            replay -> SetInputFile(input);
+            replay -> SetPedestalOutputFile(ped_out);
+            replay -> SetPedestalInputFile(ped_in, cm_in);
+            replay -> SetCommonModeOutputFile(cm_out);
+            //replay -> SetOutputFile(fRootFileSavePath); // now code automatically deduct output path
+            replay -> SetSplitMax(split_max);
+            replay -> SetSplitMin(split_min);
+            replay -> ReplayCluster();
+            },
+            [=]() {replay -> GetGEMDataHandler() -> Cancel();},
+            [=]() {replay -> GetGEMDataHandler() -> ResetCancel();});
+
+    PrintLog(QString("\nqueued %1\n").arg(name.c_str()), "blue");
+}
 
-    pGEMReplay -> SetInputFile(fFile);
-    pGEMReplay -> SetPedestalOutputFile(fPedestalOutputPath);
-    pGEMReplay -> SetPedestalInputFile(fPedestalInputPath, fCommonModeInputPath);
-    pGEMReplay -> SetCommonModeOutputFile(fCommonModeOutputPath);
-    //pGEMReplay -> SetOutputFile(fRootFileSavePath); // now code automatically deduct output path
-    pGEMReplay -> SetSplitMax(fFileSplitEnd);
-    pGEMReplay -> SetSplitMin(fFileSplitStart);
+////////////////////////////////////////////////////////////////
+// cancel the running job, output written so far is saved
 
-    std::thread th([&]() {
-            pGEMReplay -> ReplayCluster();
-            }
-            );
+void Viewer::CancelJob()
+{
+    if(!pJobQueue -> IsBusy()) {
+        PrintLog("no job is running.\n");
+        return;
+    }
 
-    th.join();
+    PrintLog("cancelling current job...\n", "red");
+    pJobQueue -> CancelCurrent();
+}
 
-    QMessageBox::information(
-            this,
-            tr("GEM Data Viewer"),
-            tr("Replay Done!") );
+////////////////////////////////////////////////////////////////
+// remove jobs not started yet
 
-    pLogBox -> setTextColor(QColor("black"));
-    pLogBox -> textCursor().insertText("Done.\n");
+void Viewer::ClearJobQueue()
+{
+    int n = pJobQueue -> GetPendingJobs();
+    pJobQueue -> ClearPending();
+    PrintLog(QString("removed %1 queued jobs.\n").arg(n), "red");
+}
+
+////////////////////////////////////////////////////////////////
+// job started (from job queue)
+
+void Viewer::OnJobStarted(const QString &name, int pending)
+{
+    PrintLog(QString("\nstarted %1 (%2 jobs queued)\nthis might take a while...\n")
+            .arg(name).arg(pending), "blue");
+}
+
+////////////////////////////////////////////////////////////////
+// job finished (from job queue)
+
+void Viewer::OnJobFinished(const QString &name, bool cancelled, int pending)
+{
+    if(cancelled)
+        PrintLog(QString("%1 cancelled (replay output is saved up to the last event, "
+                    "pedestal is not saved).\n").arg(name), "red");
+    else
+        PrintLog(QString("%1 done.\n").arg(name));
+
+    if(pending > 0)
+        PrintLog(QString("%1 jobs queued.\n").arg(pending));
+}
+
+////////////////////////////////////////////////////////////////
+// job progress (from job queue)
+
+void Viewer::OnJobProgress(const QString &s)
+{
+    PrintLog(s);
+}
+
+////////////////////////////////////////////////////////////////
+// start/stop accumulating statistics over the current file
+
+void Viewer::ToggleOnlineAccumulation()
+{
+    if(pOnlineAccumulator -> IsRunning()) {
+        PrintLog("stopping online accumulation...\n", "red");
+        pOnlineAccumulator -> Stop();
+        return;
+    }
+
+    if(fPedestalInputPath.size() <= 0 || fCommonModeInputPath.size() <= 0)
+        PrintLog("Warning: no pedestal/common mode chosen, "
+                "online accumulation uses the pedestal in config.\n", "red");
+
+    pOnlineAccumulator -> SetPedestal(fPedestalInputPath, fCommonModeInputPath);
+    pOnlineAccumulator -> SetLiveMode(bOnlineLiveMode);
+    pOnlineAccumulator -> Start(fFile);
+
+    btn_online_accumulation -> setText("&Stop Online Accumulation");
+    PrintLog(QString("\nonline accumulation started for: %1%2\n")
+            .arg(QString::fromStdString(fFile))
+            .arg(bOnlineLiveMode ? " (following live file and its splits)" : ""), "blue");
+    pRedrawTimer -> start();
+}
+
+////////////////////////////////////////////////////////////////
+// follow a file the daq is still writing, used at next start
+
+void Viewer::SetOnlineLiveMode(bool live)
+{
+    bOnlineLiveMode = live;
+}
+
+////////////////////////////////////////////////////////////////
+// timer slot, redraw only if the accumulator published a new snapshot
+
+void Viewer::RedrawOnlineStats()
+{
+    if(!pOnlineAccumulator -> Update())
+        return;
+
+    const OnlineStats &stats = pOnlineAccumulator -> GetStats();
+    DrawOnlineStats(stats);
+
+    if(!stats.running) {
+        pRedrawTimer -> stop();
+        btn_online_accumulation -> setText("&Start Online Accumulation");
+        PrintLog(QString("online accumulation finished, %1 events, %2 events/s.\n")
+                .arg(stats.events).arg(stats.rate, 0, 'f', 1), "blue");
+    }
+}
+
+////////////////////////////////////////////////////////////////
+// draw accumulated occupancy and apv summary
+
+void Viewer::DrawOnlineStats(const OnlineStats &stats)
+{
+    auto & layerID = apv_strip_mapping::Mapping::Instance() -> GetLayerIDVec();
+
+    // (x_occupancy, y_occupancy)[layer][chamber]
+    std::vector<std::vector<std::vector<int>>> occupancy(layerID.size(),
+            std::vector<std::vector<int>>(8));
+
+    for(size_t d=0; d<stats.layer_id.size(); ++d)
+    {
+        int chamber_pos = stats.chamber_pos[d];
+        if(chamber_pos < 0 || chamber_pos > 3)
+            continue;
+
+        size_t index = 0;
+        while(index < layerID.size() && layerID[index] != stats.layer_id[d])
+            index++;
+        // layer id not found in mapping file
+        if(index >= layerID.size())
+            continue;
+
+        auto &x = stats.x_occupancy[d];
+        auto &y = stats.y_occupancy[d];
+        occupancy[index][2*chamber_pos].assign(x.begin(), x.end());
+        occupancy[index][2*chamber_pos + 1].assign(y.begin(), y.end());
+    }
+
+    for(size_t i=0; i<layerID.size() && i<vTabCanvasOccupancy.size(); ++i)
+    {
+        std::vector<std::string> title;
+        for(int j=0; j<4; ++j) {
+            title.push_back("Layer " + std::to_string(i) + " Chamber " +
+                    std::to_string(j) + " X Occupancy");
+            title.push_back("Layer " + std::to_string(i) + " Chamber " +
+                    std::to_string(j) + " Y Occupancy");
+        }
+
+        vTabCanvasOccupancy[i] -> Clear();
+        vTabCanvasOccupancy[i] -> DrawCanvas(occupancy[i], title, 4, 2);
+        vTabCanvasOccupancy[i] -> Refresh();
+    }
+
+    // apv summary, x axis is the apv index in gem system
+    size_t napvs = stats.apvs.size();
+    std::vector<int> hits_per_1k(napvs, 0);
+    std::vector<int> mean_cm(napvs, 0);
+    std::vector<int> cm_dist(ONLINE_CM_BINS, 0);
+    for(size_t k=0; k<napvs; ++k)
+    {
+        if(stats.events > 0)
+            hits_per_1k[k] = static_cast<int>(1000. * stats.apv_hits[k] / stats.events);
+        if(stats.common_mode_count[k] > 0)
+            mean_cm[k] = static_cast<int>(stats.common_mode_sum[k] / stats.common_mode_count[k]);
+        for(int b=0; b<ONLINE_CM_BINS; ++b)
+            cm_dist[b] += stats.common_mode_hist[k * ONLINE_CM_BINS + b];
+    }
+
+    std::vector<std::vector<int>> summary = {hits_per_1k, mean_cm, cm_dist};
+    std::vector<std::string> summary_title = {
+        "Fired Strips per 1000 Events vs APV (" + std::to_string(stats.events) + " events)",
+        "Mean Common Mode vs APV",
+        "Common Mode [" + std::to_string(static_cast<int>(ONLINE_CM_LOW)) + ", " +
+            std::to_string(static_cast<int>(ONLINE_CM_HIGH)) + ")"
+    };
+
+    pTabCanvasAPVSummary -> Clear();
+    pTabCanvasAPVSummary -> DrawCanvas(summary, summary_title, 3, 1);
+    pTabCanvasAPVSummary -> Refresh();
 }